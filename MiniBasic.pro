@@ -4,10 +4,22 @@ SUBDIRS += core \
            runtime \
            ui \
            interpreter\
+           aot \
+           bench \
+           batch \
+           trace \
            test
 
+# epoll and Unix domain sockets
+linux: SUBDIRS += server
+
 test.depends = core runtime
-ui.depends = core runtime
+ui.depends = core runtime interpreter
+aot.depends = core runtime interpreter
+bench.depends = core runtime interpreter
+batch.depends = core runtime interpreter
+trace.depends = core runtime interpreter
+server.depends = core runtime interpreter
 
 # 如果编译失败，检查在子文件的pro文件里，使用的lib的路径
 # 修改代码的时候要重新编译来更新lib
@@ -0,0 +1,17 @@
+TEMPLATE = app
+TARGET = qbasic-aot
+CONFIG += console c++17
+CONFIG -= qt
+CONFIG -= app_bundle
+
+INCLUDEPATH += $$PWD \
+               $$PWD/../core \
+               $$PWD/../runtime \
+               $$PWD/../interpreter
+
+LIBS += \
+    -L$$PWD/../build/Desktop_Qt_6_8_3_MSVC2022_64bit-Debug/interpreter/debug -linterpreter \
+    -L$$PWD/../build/Desktop_Qt_6_8_3_MSVC2022_64bit-Debug/runtime/debug -lruntime\
+    -L$$PWD/../build/Desktop_Qt_6_8_3_MSVC2022_64bit-Debug/core/debug -lcore
+
+SOURCES += main.cpp
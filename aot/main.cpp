@@ -0,0 +1,105 @@
+#include "aotcompiler.h"
+#include "programloader.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Command line front end of the ahead-of-time compiler
+// Usage: qbasic-aot <input.bas> -o <output> [--emit-cpp <file>] [--map <file>] [--cxx <compiler>]
+//   -o          executable to build
+//   --emit-cpp  keep the generated C++ source at this path (default <output>.cpp)
+//   --map       write the "<cpp line> <basic line>" mapping to this file
+//   --cxx       C++ compiler to invoke (default $CXX, then the platform compiler)
+
+namespace {
+
+void usage() {
+    std::cerr << "usage: qbasic-aot <input.bas> -o <output> [--emit-cpp <file>]"
+                 " [--map <file>] [--cxx <compiler>]\n";
+}
+
+bool writeFile(const std::string &path, const std::string &text) {
+    std::ofstream file(path, std::ios::binary);
+    file << text;
+    return (bool)file;
+}
+
+std::string quote(const std::string &path) {
+    return "\"" + path + "\"";
+}
+
+// Command line that builds an optimized executable from the generated source
+std::string compileCommand(const std::string &compiler, const std::string &source, const std::string &output) {
+#if defined(_WIN32)
+    if (compiler == "cl")
+        return "cl /nologo /O2 /EHsc /std:c++17 " + quote(source) + " /Fe:" + quote(output);
+#endif
+    return compiler + " -std=c++17 -O2 -o " + quote(output) + " " + quote(source);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string input, output, cppPath, mapPath, compiler;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-o" && hasValue) output = argv[++i];
+        else if (arg == "--emit-cpp" && hasValue) cppPath = argv[++i];
+        else if (arg == "--map" && hasValue) mapPath = argv[++i];
+        else if (arg == "--cxx" && hasValue) compiler = argv[++i];
+        else if (input.empty() && !arg.empty() && arg[0] != '-') input = arg;
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (input.empty() || output.empty()) {
+        usage();
+        return 2;
+    }
+
+    // Load and parse the whole program; any bad line aborts the build
+    Program program;
+    try {
+        std::vector<std::string> errors = loadProgramFile(input, program);
+        if (!errors.empty()) {
+            for (const auto &e : errors) std::cerr << input << ": " << e << "\n";
+            return 1;
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "qbasic-aot: " << e.what() << "\n";
+        return 1;
+    }
+
+    AotCompiler aot(program);
+    std::string source = aot.translate(input);
+
+    if (cppPath.empty()) cppPath = output + ".cpp";
+    if (!writeFile(cppPath, source)) {
+        std::cerr << "qbasic-aot: cannot write " << cppPath << "\n";
+        return 1;
+    }
+    if (!mapPath.empty() && !writeFile(mapPath, aot.lineMapText())) {
+        std::cerr << "qbasic-aot: cannot write " << mapPath << "\n";
+        return 1;
+    }
+
+    if (compiler.empty()) {
+        const char *env = std::getenv("CXX");
+#if defined(_WIN32)
+        compiler = env ? env : "cl";
+#else
+        compiler = env ? env : "c++";
+#endif
+    }
+
+    std::string command = compileCommand(compiler, cppPath, output);
+    if (std::system(command.c_str()) != 0) {
+        std::cerr << "qbasic-aot: compiler failed: " << command << "\n";
+        return 1;
+    }
+    return 0;
+}
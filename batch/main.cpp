@@ -0,0 +1,167 @@
+#include "batchrunner.h"
+#include "programloader.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Command line front end of the parallel batch runner
+// Usage: qbasic-batch <manifest> [-j <threads>] [--time-limit <seconds>]
+//                     [--engine vm|tree|spmd] [--detect-loops] [--output]
+//                     [-o <report.jsonl>]
+//        qbasic-batch --sweep <program.bas> <vectors.txt> [same options]
+//        qbasic-batch --replay <session.qbr> [same options]
+//        qbasic-batch --sweep ... --train <profile.txt> | --profile <profile.txt>
+//   --sweep       run one program once per input vector (one vector per line,
+//                 values separated by blanks or commas); output is always
+//                 included and lines are written in input order
+//   --replay      rerun a session recorded by the GUI (SAVE) with its recorded
+//                 INPUT lines; status "diverged" if output or error differ
+//   -j            worker threads (default: one per hardware thread)
+//   --time-limit  wall-clock limit per job in seconds (default: none)
+//   --engine      execution engine (default vm; spmd runs sweep vectors in
+//                 vector lanes, see SpmdEngine)
+//   --detect-loops  stop a job as soon as it provably repeats itself forever
+//                 (status "loop"; not with --engine spmd)
+//   --output      include each program's output in its report line
+//   --train       sweep only: write the line and branch counts of all runs
+//                 to a profile file (see BranchProfile)
+//   --profile     sweep only, engine vm: lay the compiled code out for the
+//                 hot paths of a profile written by --train
+//   -o            write the report here instead of stdout
+// Report lines are written as jobs finish; the exit code is 1 if any job failed
+
+namespace {
+
+void usage() {
+    std::cerr << "usage: qbasic-batch <manifest> [-j <threads>] [--time-limit <seconds>]"
+                 " [--engine vm|tree|spmd] [--detect-loops] [--output] [-o <report.jsonl>]\n"
+                 "       qbasic-batch --sweep <program.bas> <vectors.txt> [options]\n"
+                 "       qbasic-batch --replay <session.qbr> [options]\n"
+                 "       qbasic-batch --sweep ... [--train <profile> | --profile <profile>]\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string manifest, reportPath, sweepProgram, sweepVectors, replayPath, trainPath, profilePath;
+    BatchOptions options;
+    bool includeOutput = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-j" && hasValue) options.threads = std::atoi(argv[++i]);
+        else if (arg == "--time-limit" && hasValue) options.timeLimit = std::atof(argv[++i]);
+        else if (arg == "--engine" && hasValue) {
+            std::string engine = argv[++i];
+            if (engine == "vm") options.engine = BatchEngine::Vm;
+            else if (engine == "tree") options.engine = BatchEngine::Tree;
+            else if (engine == "spmd") options.engine = BatchEngine::Spmd;
+            else {
+                usage();
+                return 2;
+            }
+        }
+        else if (arg == "--sweep" && i + 2 < argc) {
+            sweepProgram = argv[++i];
+            sweepVectors = argv[++i];
+        }
+        else if (arg == "--replay" && hasValue) replayPath = argv[++i];
+        else if (arg == "--detect-loops") options.detectLoops = true;
+        else if (arg == "--output") includeOutput = true;
+        else if (arg == "--train" && hasValue) trainPath = argv[++i];
+        else if (arg == "--profile" && hasValue) profilePath = argv[++i];
+        else if (arg == "-o" && hasValue) reportPath = argv[++i];
+        else if (manifest.empty() && !arg.empty() && arg[0] != '-') manifest = arg;
+        else {
+            usage();
+            return 2;
+        }
+    }
+    bool sweep = !sweepProgram.empty();
+    bool replay = !replayPath.empty();
+    if ((int)!manifest.empty() + (int)sweep + (int)replay != 1) {
+        usage();
+        return 2;
+    }
+    bool training = !trainPath.empty();
+    if ((training || !profilePath.empty()) && (!sweep || options.engine == BatchEngine::Spmd)) {
+        usage();
+        return 2;
+    }
+
+    // Sweep: the program is parsed once for every vector
+    Program program;
+    std::vector<std::vector<std::string>> vectors;
+    std::vector<BatchJob> jobs;
+    SessionRecording recording;
+    BranchProfile profile, trained;
+    try {
+        if (replay) {
+            std::ifstream in(replayPath, std::ios::binary);
+            if (!in) throw std::runtime_error("cannot open " + replayPath);
+            recording = SessionRecording::load(in);
+        } else if (sweep) {
+            std::vector<std::string> errors = loadProgramFile(sweepProgram, program);
+            if (!errors.empty()) {
+                for (const auto &e : errors) std::cerr << sweepProgram << ": " << e << "\n";
+                return 1;
+            }
+            vectors = readSweepVectors(sweepVectors);
+            includeOutput = true;
+            if (!profilePath.empty()) {
+                std::ifstream in(profilePath, std::ios::binary);
+                if (!in) throw std::runtime_error("cannot open " + profilePath);
+                profile = BranchProfile::load(in);
+                if (!profile.matches(program)) throw std::runtime_error("PROFILE OF A DIFFERENT PROGRAM");
+                options.profile = &profile;
+            }
+            if (training) options.training = &trained;
+        } else {
+            jobs = readBatchManifest(manifest);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "qbasic-batch: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::ofstream file;
+    if (!reportPath.empty()) {
+        file.open(reportPath, std::ios::binary);
+        if (!file) {
+            std::cerr << "qbasic-batch: cannot write " << reportPath << "\n";
+            return 1;
+        }
+    }
+    std::ostream &report = reportPath.empty() ? std::cout : file;
+
+    auto write = [&](const BatchResult &result) {
+        report << batchResultJson(result, includeOutput) << "\n";
+        report.flush();
+    };
+    std::vector<BatchResult> results;
+    if (replay) {
+        results.push_back(runReplay(recording, options));
+        results.back().name = replayPath;
+        write(results.back());
+    } else {
+        results = sweep ? runSweep(program, vectors, options, write) : runBatch(jobs, options, write);
+    }
+
+    if (training) {
+        std::ofstream out(trainPath, std::ios::binary);
+        trained.save(out);
+        if (!out) {
+            std::cerr << "qbasic-batch: cannot write " << trainPath << "\n";
+            return 1;
+        }
+    }
+
+    int failed = 0;
+    for (const BatchResult &result : results) {
+        if (result.status != "ok") ++failed;
+    }
+    std::cerr << results.size() << " runs, " << failed << " failed\n";
+    return failed ? 1 : 0;
+}
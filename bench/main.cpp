@@ -0,0 +1,154 @@
+#include "branchprofile.h"
+#include "livestate.h"
+#include "programloader.h"
+#include "vm.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Dispatch benchmark for the register VM
+// Usage: qbasic-bench [repeat]   (default 5 runs per mode, best time kept)
+// Prints, for every built-in workload and dispatch mode, the best run time,
+// the number of VM instructions executed and the cost per instruction.
+// The "live" rows run the default dispatch while publishing to a LiveState
+// that another thread reads at display rate, as the GUI does. The
+// "profiled" rows run the default dispatch on code laid out with the
+// BranchProfile of one training run (see RegisterVM).
+
+namespace {
+
+struct Workload {
+    const char *name;
+    const char *source;
+};
+
+const Workload WORKLOADS[] = {
+    { "counter",
+      "10 LET I = 0\n"
+      "20 LET I = I + 1\n"
+      "30 IF I < 5000000 THEN 20\n"
+      "40 END\n" },
+    { "arithmetic",
+      "10 LET S = 0\n"
+      "20 LET I = 0\n"
+      "30 LET S = S + (I * 3 + 1) MOD 7 - (I - S) / 5\n"
+      "40 LET I = I + 1\n"
+      "50 IF I < 2000000 THEN 30\n"
+      "60 END\n" },
+    { "nested",
+      "10 LET T = 0\n"
+      "20 LET I = 0\n"
+      "30 LET J = 0\n"
+      "40 LET T = T + (I - J) * (I + J)\n"
+      "50 LET J = J + 1\n"
+      "60 IF J < 1000 THEN 40\n"
+      "70 LET I = I + 1\n"
+      "80 IF I < 1000 THEN 30\n"
+      "90 END\n" },
+    { "branchy",
+      "10 LET A = 0\n"
+      "20 LET B = 0\n"
+      "30 LET I = 0\n"
+      "40 IF I MOD 3 = 0 THEN 70\n"
+      "50 LET A = A + I\n"
+      "60 GOTO 80\n"
+      "70 LET B = B - I\n"
+      "80 LET I = I + 1\n"
+      "90 IF I < 2000000 THEN 40\n"
+      "100 END\n" },
+    { "skewed",
+      "10 LET A = 0\n"
+      "20 LET B = 0\n"
+      "30 LET I = 0\n"
+      "40 IF I MOD 16 > 0 THEN 80\n"
+      "50 LET B = B + I\n"
+      "60 IF B > 1000000 THEN 100\n"
+      "70 GOTO 90\n"
+      "80 LET A = A + I MOD 5\n"
+      "90 GOTO 110\n"
+      "100 LET B = 0\n"
+      "110 LET I = I + 1\n"
+      "120 IF I < 3000000 THEN 40\n"
+      "130 END\n" },
+};
+
+struct Measurement {
+    double seconds = 0;
+    uint64_t instructions = 0;
+};
+
+Measurement measure(RegisterVM &vm, const Program &program, int repeat) {
+    Measurement best;
+    for (int i = 0; i < repeat; ++i) {
+        EvalState state;
+        auto start = std::chrono::steady_clock::now();
+        vm.run(state, program);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (i == 0 || seconds < best.seconds) best.seconds = seconds;
+        best.instructions = vm.executedInstructions();
+    }
+    return best;
+}
+
+void report(const char *workload, const char *mode, const Measurement &m) {
+    double ns = m.instructions ? m.seconds * 1e9 / (double)m.instructions : 0;
+    std::printf("%-12s %-9s %10.4f s %14llu instr %8.3f ns/instr\n",
+                workload, mode, m.seconds, (unsigned long long)m.instructions, ns);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    int repeat = argc > 1 ? std::atoi(argv[1]) : 5;
+    if (repeat < 1) repeat = 1;
+
+    if (!RegisterVM::threadedDispatchSupported())
+        std::printf("threaded dispatch not available in this build, only switch is measured\n");
+
+    for (const Workload &w : WORKLOADS) {
+        Program program;
+        std::vector<std::string> errors = loadProgramText(w.source, program);
+        if (!errors.empty()) {
+            std::cerr << w.name << ": " << errors.front() << "\n";
+            return 1;
+        }
+
+        RegisterVM vm(program);
+        vm.setDispatch(VmDispatch::Switch);
+        report(w.name, "switch", measure(vm, program, repeat));
+
+        if (RegisterVM::threadedDispatchSupported()) {
+            vm.setDispatch(VmDispatch::Threaded);
+            report(w.name, "threaded", measure(vm, program, repeat));
+        }
+
+        LiveState live;
+        std::atomic<bool> done{false};
+        std::thread reader([&]() {
+            LiveSnapshot snapshot;
+            while (!done) {
+                live.read(snapshot);
+                std::this_thread::sleep_for(std::chrono::milliseconds(16));
+            }
+        });
+        vm.setLiveState(&live);
+        report(w.name, "live", measure(vm, program, repeat));
+        vm.setLiveState(nullptr);
+        done = true;
+        reader.join();
+
+        EvalState training;
+        vm.run(training, program);
+        BranchProfile profile;
+        profile.add(program, *training.getRuntimeStats());
+        RegisterVM profiled(program, &profile);
+        report(w.name, "profiled", measure(profiled, program, repeat));
+    }
+    return 0;
+}
@@ -1,12 +1,15 @@
 TEMPLATE = lib
 CONFIG += staticlib c++17
+CONFIG -= qt
 
 INCLUDEPATH += $$PWD
 
 SOURCES += program.cpp \
+           lineindex.cpp \
            statement.cpp \
            exp.cpp
 
 HEADERS += program.h \
+           lineindex.h \
            statement.h \
            exp.h
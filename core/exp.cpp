@@ -1,17 +1,29 @@
 #include "exp.h"
 #include "../runtime/evalstate.h"
 #include "../runtime/tokenizer.h"
+#include <climits>
+#include <cmath>
+#include <cstdint>
 #include <stdexcept>
 #include <iostream>
 #include <sstream>
 
+// ============ Expression Implementation ============
+
+// Syntax tree as a string: the streamed form collected once
+std::string Expression::toSyntaxTree(int indent) const {
+    std::ostringstream out;
+    writeSyntaxTree(out, indent);
+    return out.str();
+}
+
 // ============ ConstantExp Implementation ============
 
 // Constructor: initialize with constant value
 ConstantExp::ConstantExp(int v) : value(v) {}
 
 // Evaluation: return the constant value
-int ConstantExp::eval(EvalState &state) {
+int ConstantExp::eval(EvalState &state) const {
     return value;
 }
 
@@ -31,8 +43,9 @@ int ConstantExp::getConstantValue(){
 }
 
 // Syntax tree representation
-std::string ConstantExp:: toSyntaxTree(int indent) const{
-    return indentHelper(indent) + std::to_string(value);
+void ConstantExp::writeSyntaxTree(std::ostream &out, int indent) const {
+    writeIndent(out, indent);
+    out << value;
 }
 
 // ============ IdentifierExp Implementation ============
@@ -45,7 +58,7 @@ IdentifierExp::IdentifierExp(const std::string &n) : name(n) {
 }
 
 // Evaluation: look up variable value in symbol table
-int IdentifierExp::eval(EvalState &state) {
+int IdentifierExp::eval(EvalState &state) const {
     // Check if variable is defined
     if (!state.isDefined(name)) {
         throw std::runtime_error("VARIABLE NOT DEFINED: " + name);
@@ -79,8 +92,9 @@ std::string IdentifierExp::getIdentifierName() {
 }
 
 // Syntax tree representation
-std::string IdentifierExp::toSyntaxTree(int indent) const {
-    return indentHelper(indent) + name;
+void IdentifierExp::writeSyntaxTree(std::ostream &out, int indent) const {
+    writeIndent(out, indent);
+    out << name;
 }
 
 // ============ CompoundExp Implementation ============
@@ -96,20 +110,22 @@ CompoundExp::~CompoundExp() {
 }
 
 // Evaluation: recursively evaluate operands and apply operator
-int CompoundExp::eval(EvalState &state) {
+int CompoundExp::eval(EvalState &state) const {
 
     // recursion here
     int left = lhs->eval(state);
     int right = rhs->eval(state);
 
     // operation at the current stage
-    if (op == "+") return left + right;
-    if (op == "-") return left - right;
-    if (op == "*") return left * right;
+    // integers wrap around at 32 bits (computed unsigned, signed overflow is undefined)
+    if (op == "+") return (int32_t)((uint32_t)left + (uint32_t)right);
+    if (op == "-") return (int32_t)((uint32_t)left - (uint32_t)right);
+    if (op == "*") return (int32_t)((uint32_t)left * (uint32_t)right);
     if (op == "/") {
         if (right == 0) {
             throw std::runtime_error("DIVIDE BY ZERO");
         }
+        if (right == -1) return (int32_t)(0u - (uint32_t)left);    // INT_MIN / -1 wraps to INT_MIN
         return left / right;
     }
 
@@ -120,6 +136,7 @@ int CompoundExp::eval(EvalState &state) {
 
     if (op == "MOD") {
         if (right == 0) return 0;  // 避免除零
+        if (right == -1) return 0;  // INT_MIN % -1 overflows
 
         int result = left % right;
 
@@ -155,10 +172,10 @@ Expression* CompoundExp::getRHS(){
 }
 
 
-std::string CompoundExp::toSyntaxTree(int indent) const {
-    std::string s;
-    s += indentHelper(indent) + op + "\n";
-    s += lhs->toSyntaxTree(indent + 1) + "\n";
-    s += rhs->toSyntaxTree(indent + 1);
-    return s;
+void CompoundExp::writeSyntaxTree(std::ostream &out, int indent) const {
+    writeIndent(out, indent);
+    out << op << "\n";
+    lhs->writeSyntaxTree(out, indent + 1);
+    out << "\n";
+    rhs->writeSyntaxTree(out, indent + 1);
 }
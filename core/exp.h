@@ -11,6 +11,9 @@
 
 #pragma once
 
+#include <ostream>
+#include <string>
+
 #include "../runtime/evalstate.h"
 
 // Expression type enumeration for distinguishing expression subclasses
@@ -27,7 +30,7 @@ public:
     virtual ~Expression() = default;
 
     // Evaluate expression using runtime state and return integer result
-    virtual int eval(EvalState &state) = 0;
+    virtual int eval(EvalState &state) const = 0;
 
     // Convert expression to human-readable string (for debugging output)
     virtual std::string toString() const = 0;
@@ -35,8 +38,12 @@ public:
     // Get type of expression (CONSTANT, IDENTIFIER, or COMPOUND)
     virtual ExpressionType type() = 0;
 
-    // Convert expression to syntax tree representation (indented for visualization)
-    virtual std::string toSyntaxTree(int indent = 0) const = 0;
+    // Write the syntax tree representation (indented for visualization)
+    // straight to a stream, without building intermediate strings
+    virtual void writeSyntaxTree(std::ostream &out, int indent = 0) const = 0;
+
+    // Syntax tree representation as a string (see writeSyntaxTree)
+    std::string toSyntaxTree(int indent = 0) const;
 
     // Getter methods for convenience (throw if not applicable to this expression type)
     
@@ -66,9 +73,9 @@ public:
     }
 
 protected:
-    // Helper method to generate indentation for tree visualization
-    std::string indentHelper(int n) const {
-        return std::string(n * 2, ' ');
+    // Helper method to write indentation for tree visualization
+    static void writeIndent(std::ostream &out, int n) {
+        for (int i = 0; i < n; ++i) out << "  ";
     }
 };
 
@@ -79,7 +86,7 @@ public:
     ConstantExp(int value);
 
     // Evaluate: returns the constant value regardless of state
-    int eval(EvalState &state) override;
+    int eval(EvalState &state) const override;
     
     // Convert to string representation
     std::string toString() const override;
@@ -91,7 +98,7 @@ public:
     int getConstantValue() override;
 
     // Syntax tree representation
-    std::string toSyntaxTree(int) const override;
+    void writeSyntaxTree(std::ostream &out, int indent) const override;
 
 private:
     int value;          // Numeric value of the constant
@@ -104,7 +111,7 @@ public:
     IdentifierExp(const std::string &name);
 
     // Evaluate: look up variable value in EvalState
-    int eval(EvalState &state) override;
+    int eval(EvalState &state) const override;
     
     // Convert to string representation
     std::string toString() const override;
@@ -116,7 +123,7 @@ public:
     std::string getIdentifierName() override;
 
     // Syntax tree representation
-    std::string toSyntaxTree(int) const override;
+    void writeSyntaxTree(std::ostream &out, int indent) const override;
 
 private:
     std::string name;   // Variable name
@@ -132,7 +139,7 @@ public:
     ~CompoundExp();
 
     // Evaluate: recursively evaluate operands and apply operator
-    int eval(EvalState &state) override;
+    int eval(EvalState &state) const override;
     
     // Convert to string representation
     std::string toString() const override;
@@ -150,7 +157,7 @@ public:
     Expression* getRHS() override;
 
     // Syntax tree representation
-    std::string toSyntaxTree(int) const override;
+    void writeSyntaxTree(std::ostream &out, int indent) const override;
 
 private:
     std::string op;         // Operator (e.g., "+", "-", "*", "/", "MOD", "**", "=", "<", ">")
@@ -0,0 +1,124 @@
+#include "lineindex.h"
+
+// xorshift32: heap priorities only need to look random
+uint32_t LineIndex::nextPriority() {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+// Join two treaps where every line of a is smaller than every line of b
+int LineIndex::merge(int a, int b) {
+    if (a == NIL) return b;
+    if (b == NIL) return a;
+    if (nodes[a].priority > nodes[b].priority) {
+        nodes[a].right = merge(nodes[a].right, b);
+        update(a);
+        return a;
+    }
+    nodes[b].left = merge(a, nodes[b].left);
+    update(b);
+    return b;
+}
+
+// Split into lines < line (<= line if inclusive) and the rest
+void LineIndex::split(int t, int line, bool inclusive, int &left, int &right) {
+    if (t == NIL) {
+        left = right = NIL;
+        return;
+    }
+    bool goesLeft = inclusive ? nodes[t].line <= line : nodes[t].line < line;
+    if (goesLeft) {
+        split(nodes[t].right, line, inclusive, nodes[t].right, right);
+        left = t;
+    } else {
+        split(nodes[t].left, line, inclusive, left, nodes[t].left);
+        right = t;
+    }
+    update(t);
+}
+
+int LineIndex::insert(int line) {
+    int existing = rank(line);
+    if (existing != -1) return existing;
+
+    int node;
+    if (!freeNodes.empty()) {
+        node = freeNodes.back();
+        freeNodes.pop_back();
+    } else {
+        node = (int)nodes.size();
+        nodes.push_back(Node());
+    }
+    nodes[node] = {line, nextPriority(), 1, NIL, NIL};
+
+    int left, right;
+    split(root, line, false, left, right);
+    int position = sizeOf(left);
+    root = merge(merge(left, node), right);
+    return position;
+}
+
+int LineIndex::erase(int line) {
+    int left, middle, right;
+    split(root, line, false, left, right);
+    split(right, line, true, middle, right);
+    int position = middle == NIL ? -1 : sizeOf(left);
+    if (middle != NIL) freeNodes.push_back(middle);
+    root = merge(left, right);
+    return position;
+}
+
+int LineIndex::countBelow(int line) const {
+    int count = 0;
+    int t = root;
+    while (t != NIL) {
+        if (line <= nodes[t].line) {
+            t = nodes[t].left;
+        } else {
+            count += sizeOf(nodes[t].left) + 1;
+            t = nodes[t].right;
+        }
+    }
+    return count;
+}
+
+int LineIndex::rank(int line) const {
+    int position = 0;
+    int t = root;
+    while (t != NIL) {
+        const Node &n = nodes[t];
+        if (line < n.line) {
+            t = n.left;
+        } else if (line > n.line) {
+            position += sizeOf(n.left) + 1;
+            t = n.right;
+        } else {
+            return position + sizeOf(n.left);
+        }
+    }
+    return -1;
+}
+
+int LineIndex::at(int k) const {
+    int t = root;
+    while (t != NIL) {
+        int leftSize = sizeOf(nodes[t].left);
+        if (k < leftSize) {
+            t = nodes[t].left;
+        } else if (k == leftSize) {
+            return nodes[t].line;
+        } else {
+            k -= leftSize + 1;
+            t = nodes[t].right;
+        }
+    }
+    return -1;
+}
+
+void LineIndex::clear() {
+    nodes.clear();
+    freeNodes.clear();
+    root = NIL;
+}
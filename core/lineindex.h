@@ -0,0 +1,64 @@
+/**
+ * @file    lineindex.h
+ * @brief   Ordered set of line numbers with positions (order statistics)
+ *
+ *          A treap (randomized balanced search tree) whose nodes also store
+ *          their subtree size, so besides insert, erase and lookup it answers
+ *          "at which position is line n" and "which line is at position k"
+ *          in O(log n) expected time. Views use it to map program lines to
+ *          rows without walking the whole program.
+ *
+ * @author  simple_wind
+ * @version 1.0
+ * @date    2025-12-16
+ * */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class LineIndex {
+public:
+    LineIndex() = default;
+
+    // Insert a line number; returns its position (also if already present)
+    int insert(int line);
+
+    // Remove a line number; returns the position it had, -1 if absent
+    int erase(int line);
+
+    // Position of a line number, -1 if absent
+    int rank(int line) const;
+
+    // Number of lines smaller than `line` (the position it has or would get)
+    int countBelow(int line) const;
+
+    // Line number at position k (0 <= k < size())
+    int at(int k) const;
+
+    bool contains(int line) const { return rank(line) != -1; }
+    int size() const { return root == NIL ? 0 : nodes[root].size; }
+    void clear();
+
+private:
+    static const int NIL = -1;
+
+    struct Node {
+        int line;
+        uint32_t priority;
+        int size;
+        int left, right;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int> freeNodes;
+    int root = NIL;
+    uint32_t seed = 2463534242u;
+
+    int sizeOf(int t) const { return t == NIL ? 0 : nodes[t].size; }
+    void update(int t) { nodes[t].size = 1 + sizeOf(nodes[t].left) + sizeOf(nodes[t].right); }
+    uint32_t nextPriority();
+    int merge(int a, int b);
+    void split(int t, int line, bool inclusive, int &left, int &right);
+};
@@ -3,11 +3,10 @@
 
 #include "program.h"
 #include "statement.h"
+#include <algorithm>
 
-// Constructor: initialize program with no lines and not ended
-Program::Program() : nextLine(-1) {
-    ended = false;
-}
+// Constructor: initialize program with no lines
+Program::Program() {}
 
 // Destructor: clean up all statements
 Program::~Program() {
@@ -17,6 +16,7 @@ Program::~Program() {
 // Add or update a source line at given line number
 void Program::addSourceLine(int lineNumber, const std::string &line) {
     sourceLines[lineNumber] = line;
+    notifyChanged(lineNumber);
 }
 
 // Remove source line and its parsed statement
@@ -28,6 +28,7 @@ void Program::removeSourceLine(int lineNumber) {
         delete parsedStatements[lineNumber];
         parsedStatements.erase(lineNumber);
     }
+    notifyChanged(lineNumber);
 }
 
 // Retrieve raw source code line by line number
@@ -37,6 +38,17 @@ std::string Program::getSourceLine(int lineNumber) const {
     return "";
 }
 
+// Check whether the line exists
+bool Program::hasLine(int lineNumber) const {
+    return sourceLines.count(lineNumber) > 0;
+}
+
+// Jump targets must exist
+int Program::requireLine(int lineNumber) const {
+    if (!sourceLines.count(lineNumber)) throw std::runtime_error("Goto none-exsiting line");
+    return lineNumber;
+}
+
 // Store parsed statement AST for a line number
 void Program::setParsedStatement(int lineNumber, Statement *stmt) {
     // Delete old statement if exists
@@ -44,6 +56,7 @@ void Program::setParsedStatement(int lineNumber, Statement *stmt) {
         delete parsedStatements[lineNumber];
 
     parsedStatements[lineNumber] = stmt;
+    notifyChanged(lineNumber);
 }
 
 // Fetch parsed statement
@@ -66,19 +79,6 @@ int Program::getNextLineNumber(int lineNumber) const {
     return it->first;
 }
 
-// Set next line number for execution
-void Program::setNextLine(int lineNumber) {
-
-    // TODO : legal checking
-    if (sourceLines.count(lineNumber)) nextLine = lineNumber;
-    else throw std::runtime_error("Goto none-exsiting line");
-}
-
-// Read next line number
-int Program::getNextLine() const {
-    return nextLine;
-}
-
 // Clear the program completely
 void Program::clear() {
     // 1. delete parsedStatements Statement*
@@ -90,23 +90,11 @@ void Program::clear() {
     // 2. clear all source lines
     sourceLines.clear();
 
-    // 3. reset running state
-    nextLine = -1;
-    ended = false;
+    for (ProgramObserver *observer : observers) observer->programCleared();
 }
 
 
-void Program::setEnd(){
-    ended = true;
-    nextLine = -1 ;
-}
-
-bool Program::isEnded() const{
-    return ended;
-}
-
-
-std::string Program::getDisplayText()
+std::string Program::getDisplayText() const
 {
     std::string rawText;
     for (const auto &entry : sourceLines){
@@ -118,8 +106,14 @@ std::string Program::getDisplayText()
     return rawText;
 }
 
-void Program::resetStateCount(){
-    for (auto &p : parsedStatements) {
-        p.second->resetCount();   // Important reset count
-    }
+void Program::addObserver(ProgramObserver *observer) const {
+    observers.push_back(observer);
+}
+
+void Program::removeObserver(ProgramObserver *observer) const {
+    observers.erase(std::remove(observers.begin(), observers.end(), observer), observers.end());
+}
+
+void Program::notifyChanged(int lineNumber) {
+    for (ProgramObserver *observer : observers) observer->lineChanged(lineNumber);
 }
@@ -1,8 +1,11 @@
 /**
  * @file    program.h
  * @brief   Program class for managing BASIC program structure
- *          Stores source lines, parsed statements, and execution state
+ *          Stores source lines and parsed statements
  *          Acts as the central data structure for program representation
+ *          Running never modifies a Program: the program counter, end flag
+ *          and counters of a run live in its EvalState, so one Program can
+ *          be executed by several runs at once
  *
  * @author  simple_wind
  * @version 1.0
@@ -11,11 +14,24 @@
 
 #pragma once
 
-#include<QString>
 #include <map>
+#include <string>
+#include <vector>
 //#include "statement.h"
 class Statement;
 
+// Receives every edit of a Program (see Program::addObserver)
+class ProgramObserver {
+public:
+    virtual ~ProgramObserver() = default;
+
+    // A line was added, removed, or got new source text or a new statement
+    virtual void lineChanged(int lineNumber) = 0;
+
+    // Every line was removed
+    virtual void programCleared() = 0;
+};
+
 // Program class: manages program representation and execution flow
 // Stores source code lines, parsed statements, and tracks next line to execute
 class Program {
@@ -34,6 +50,13 @@ public:
     // Retrieve source code text by line number
     std::string getSourceLine(int lineNumber) const;
 
+    // Check whether a line number exists (valid jump target)
+    bool hasLine(int lineNumber) const;
+
+    // Validate a jump target: returns lineNumber if the line exists
+    // Throws "Goto none-exsiting line" otherwise
+    int requireLine(int lineNumber) const;
+
     // Parsed statement management
     // Store parsed statement AST for a line number
     void setParsedStatement(int lineNumber, Statement *stmt);
@@ -41,8 +64,6 @@ public:
     // Retrieve parsed statement for a line number
     Statement *getParsedStatement(int lineNumber) const;
 
-    void resetStateCount();
-
     // Line navigation
     // Get first executable line number in program
     int getFirstLineNumber() const;
@@ -50,30 +71,22 @@ public:
     // Get next line number after given line (for sequential execution)
     int getNextLineNumber(int lineNumber) const;
 
-    // Execution control
-    // Set next line to execute (used by GOTO statements)
-    void setNextLine(int lineNumber);
-    
-    // Get next line to execute
-    int getNextLine() const;
-
     // Clear all program data
     void clear();
 
-    // Mark program as finished (for END statement)
-    void setEnd();
-    // used to recover when finishing a round of running
-    void recoverEnd(){ended=false;}
-    
-    // Check if program execution should stop
-    bool isEnded() const;
-
     // Get display text for UI
-    std::string getDisplayText();
+    std::string getDisplayText() const;
+
+    // Edit notifications
+    // Observers are called after each edit; they must remove themselves
+    // before they are destroyed (the Program does not own them)
+    void addObserver(ProgramObserver *observer) const;
+    void removeObserver(ProgramObserver *observer) const;
 
 private:
     std::map<int, std::string> sourceLines;      // Raw BASIC source code lines
     std::map<int, Statement*> parsedStatements;  // Parsed Abstract Syntax Tree (AST) nodes
-    int nextLine;                                // Next line number to execute
-    bool ended;                                  // Flag indicating program termination
+    mutable std::vector<ProgramObserver*> observers;
+
+    void notifyChanged(int lineNumber);
 };
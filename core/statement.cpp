@@ -3,8 +3,14 @@
 #include "statement.h"
 #include "../runtime/tokenizer.h"
 #include <iostream>
+#include <sstream>
 
-#include <QDebug>
+// Syntax tree as a string: the streamed form collected once
+std::string Statement::toSyntaxTree(const RuntimeStats * stats, int line, int indent) const {
+    std::ostringstream out;
+    writeSyntaxTree(out, stats, line, indent);
+    return out.str();
+}
 
 // ============ REM Statement Implementation ============
 // REM: comment line with no runtime effect
@@ -12,16 +18,16 @@
 RemStmt::RemStmt(const std::string &text) : text(text) {}
 
 // Execute: comment statements have no effect
-void RemStmt::execute(EvalState &state, Program &) {
+void RemStmt::execute(EvalState &state, const Program &) const {
     // No effect during runtime
-    execCount++;
+    state.lineCounters().execCount++;
 }
 
 // Syntax tree representation for REM
-std::string RemStmt::toSyntaxTree(const RuntimeStats * , int indent) const {
-    std::string s;
-    s += indentFunc(indent) + "REM " + std::to_string(execCount) + "\n" + text + "\n";
-    return s;
+void RemStmt::writeSyntaxTree(std::ostream &out, const RuntimeStats * stats, int line, int indent) const {
+    int execCount = stats ? stats->getLineCounters(line).execCount : 0;
+    writeIndent(out, indent);
+    out << "REM " << execCount << "\n" << text << "\n";
 }
 
 // ============ LET Statement Implementation ============
@@ -41,8 +47,8 @@ LetStmt::~LetStmt() {
 }
 
 // Execute: evaluate expression and assign to variable
-void LetStmt::execute(EvalState &state, Program &) {
-    execCount++;
+void LetStmt::execute(EvalState &state, const Program &) const {
+    state.lineCounters().execCount++;
 
     // Evaluate the expression and store result in variable
     int value = exp->eval(state);
@@ -50,17 +56,19 @@ void LetStmt::execute(EvalState &state, Program &) {
 }
 
 // Syntax tree representation for LET
-std::string LetStmt::toSyntaxTree(const RuntimeStats * stats, int indent) const {
-    std::string s;
+void LetStmt::writeSyntaxTree(std::ostream &out, const RuntimeStats * stats, int line, int indent) const {
+    int execCount = stats ? stats->getLineCounters(line).execCount : 0;
     int useCount = 0;
     if (stats) {
         auto it = stats->identifierUseCount.find(var);
         if (it != stats->identifierUseCount.end()) useCount = it->second;
     }
-    s += indentFunc(indent) + "LET = " + std::to_string(execCount) + "\n";
-    s += indentFunc(indent + 1) + var + " " + std::to_string(useCount) + "\n";
-    s += exp->toSyntaxTree(indent + 1) + "\n";
-    return s;
+    writeIndent(out, indent);
+    out << "LET = " << execCount << "\n";
+    writeIndent(out, indent + 1);
+    out << var << " " << useCount << "\n";
+    exp->writeSyntaxTree(out, indent + 1);
+    out << "\n";
 }
 
 // ============ PRINT Statement Implementation ============
@@ -75,23 +83,33 @@ PrintStmt::~PrintStmt() {
 }
 
 // Execute: evaluate expression and print result
-void PrintStmt::execute(EvalState &state, Program &) {
-    execCount++;
+void PrintStmt::execute(EvalState &state, const Program &) const {
+    state.lineCounters().execCount++;
 
     // Evaluate expression
     int value = exp->eval(state);
+    print(state, value);
+}
 
-    // Output result (using Qt debug output for now)
-    qDebug() << value;
+// Output result to the run's output consumer if there is one,
+// otherwise to the console
+void PrintStmt::print(EvalState &state, int value) {
+    if (state.outputConsumer) {
+        state.outputConsumer(std::to_string(value) + "\n");
+        return;
+    }
 
     std::cout << value << std::endl;
 }
 
 // Syntax tree representation for PRINT
-std::string PrintStmt::toSyntaxTree(const RuntimeStats *, int indent) const {
-    std::string s = indentFunc(indent) + "PRINT " + std::to_string(execCount) + "\n";
-    s += indentFunc(indent + 1) + exp->toSyntaxTree() + "\n";
-    return s;
+void PrintStmt::writeSyntaxTree(std::ostream &out, const RuntimeStats * stats, int line, int indent) const {
+    int execCount = stats ? stats->getLineCounters(line).execCount : 0;
+    writeIndent(out, indent);
+    out << "PRINT " << execCount << "\n";
+    writeIndent(out, indent + 1);
+    exp->writeSyntaxTree(out);
+    out << "\n";
 }
 
 // ============ INPUT Statement Implementation ============
@@ -105,8 +123,8 @@ InputStmt::InputStmt(const std::string &varName) : var(varName) {
 }
 
 // Execute: read integer from input and store in variable
-void InputStmt::execute(EvalState &state, Program &) {
-    execCount++;
+void InputStmt::execute(EvalState &state, const Program &) const {
+    state.lineCounters().execCount++;
 
     // Check if input provider is configured
     if (!state.inputProvider) {
@@ -117,8 +135,7 @@ void InputStmt::execute(EvalState &state, Program &) {
     // Loop until valid integer is entered
     while (true) {
         // Call input provider callback
-        QString qinput = state.inputProvider();
-        std::string temp = qinput.toStdString();
+        std::string temp = state.inputProvider();
 
         try {
             // Parse as integer
@@ -133,10 +150,8 @@ void InputStmt::execute(EvalState &state, Program &) {
 }
 
 // Syntax tree representation for INPUT
-std::string InputStmt::toSyntaxTree(const RuntimeStats *, int indent) const {
-    std::string s = "INPUT " + var;
-    s += "\n";
-    return s;
+void InputStmt::writeSyntaxTree(std::ostream &out, const RuntimeStats *, int, int) const {
+    out << "INPUT " << var << "\n";
 }
 
 // ============ GOTO Statement Implementation ============
@@ -146,18 +161,19 @@ std::string InputStmt::toSyntaxTree(const RuntimeStats *, int indent) const {
 GotoStmt::GotoStmt(int targetLine) : target(targetLine) {}
 
 // Execute: set next line to target (unconditional jump)
-void GotoStmt::execute(EvalState &, Program &program) {
-    execCount++;
+void GotoStmt::execute(EvalState &state, const Program &program) const {
+    state.lineCounters().execCount++;
     // Transfer control to target line
-    program.setNextLine(target);
+    state.setNextLine(program.requireLine(target));
 }
 
 // Syntax tree representation for GOTO
-std::string GotoStmt::toSyntaxTree(const RuntimeStats *, const int indent) const {
-    std::string s;
-    s += indentFunc(indent) + "GOTO " + std::to_string(execCount) + "\n";
-    s += indentFunc(indent + 1) + std::to_string(target) + "\n";
-    return s;
+void GotoStmt::writeSyntaxTree(std::ostream &out, const RuntimeStats * stats, int line, int indent) const {
+    int execCount = stats ? stats->getLineCounters(line).execCount : 0;
+    writeIndent(out, indent);
+    out << "GOTO " << execCount << "\n";
+    writeIndent(out, indent + 1);
+    out << target << "\n";
 }
 
 // Constructor: create IF statement
@@ -172,12 +188,13 @@ IfStmt::~IfStmt() {
 }
 
 // Execute: evaluate condition and jump to target if true
-void IfStmt::execute(EvalState &state, Program &program) {
+void IfStmt::execute(EvalState &state, const Program &program) const {
     // Evaluate both sides
     int l = left->eval(state);
     int r = right->eval(state);
 
-    execCount++;
+    LineCounters &counters = state.lineCounters();
+    counters.execCount++;
 
     // Evaluate condition based on operator
     bool cond = false;
@@ -187,36 +204,39 @@ void IfStmt::execute(EvalState &state, Program &program) {
 
     // If condition true, jump to target line
     if (cond) {
-        thenCount++;
-        program.setNextLine(target);
+        counters.thenCount++;
+        state.setNextLine(program.requireLine(target));
     } else {
-        ifCount++;
+        counters.ifCount++;
     }
 }
 
 // Syntax tree representation for IF
-std::string IfStmt::toSyntaxTree(const RuntimeStats * stats, int indent) const {
-    std::string s;
-    s += indentFunc(indent) + "IF THEN " + std::to_string(ifCount) + " " + std::to_string(thenCount) + "\n";
-    s += left->toSyntaxTree(indent + 1) + "\n";
-    s += indentFunc(indent + 1) + op + "\n";
-    s += right->toSyntaxTree(indent + 1) + "\n";
-    s += indentFunc(indent + 1) + std::to_string(target) + "\n";
-    return s;
+void IfStmt::writeSyntaxTree(std::ostream &out, const RuntimeStats * stats, int line, int indent) const {
+    LineCounters counters = stats ? stats->getLineCounters(line) : LineCounters();
+    writeIndent(out, indent);
+    out << "IF THEN " << counters.ifCount << " " << counters.thenCount << "\n";
+    left->writeSyntaxTree(out, indent + 1);
+    out << "\n";
+    writeIndent(out, indent + 1);
+    out << op << "\n";
+    right->writeSyntaxTree(out, indent + 1);
+    out << "\n";
+    writeIndent(out, indent + 1);
+    out << target << "\n";
 }
 
 // ============ END Statement Implementation ============
 // END: terminate program execution
 
 // Execute: mark program as ended
-void EndStmt::execute(EvalState &, Program &program) {
-    // Set program end flag
-    program.setEnd();
+void EndStmt::execute(EvalState &state, const Program &) const {
+    // Set end flag of this run
+    state.setEnd();
 }
 
 // Syntax tree representation for END
-std::string EndStmt::toSyntaxTree(const RuntimeStats *, int indent) const {
-    std::string s;
-    s+=indentFunc(indent) +"END" + "\n";
-    return s;
+void EndStmt::writeSyntaxTree(std::ostream &out, const RuntimeStats *, int, int indent) const {
+    writeIndent(out, indent);
+    out << "END\n";
 }
@@ -10,11 +10,24 @@
 
 #pragma once
 
-#include <QObject>
+#include <ostream>
+#include <stdexcept>
+#include <string>
 #include "../runtime/evalstate.h"
 #include "exp.h"
 #include "program.h"
 
+// Statement type enumeration for distinguishing statement subclasses
+enum class StatementType {
+    REM,            // Comment
+    LET,            // Variable assignment
+    PRINT,          // Output
+    INPUT,          // Read user input
+    GOTO,           // Unconditional branch
+    IF,             // Conditional branch
+    END             // Program termination
+};
+
 // Abstract base class for all BASIC statements
 // Each subclass implements execute() to define runtime behavior
 class Statement {
@@ -22,22 +35,55 @@ public:
     virtual ~Statement() {}
     
     // Execute statement: perform runtime action with given state and program
-    virtual void execute(EvalState &state, Program &program) = 0;
+    // Statements are immutable: control flow and counters go to the state
+    // (counted under state.getCurrentLine())
+    virtual void execute(EvalState &state, const Program &program) const = 0;
 
     // Convert statement to text representation
     virtual std::string toString() const = 0;
 
-    // Convert statement to syntax tree visualization
-    virtual std::string toSyntaxTree(const RuntimeStats * stats, int indent = 0) const = 0;
+    // Write statement syntax tree visualization straight to a stream
+    // stats: counters of a run (may be nullptr), line: this statement's line number
+    virtual void writeSyntaxTree(std::ostream &out, const RuntimeStats * stats, int line, int indent = 0) const = 0;
 
-    void resetCount() {execCount = 0;}
+    // Syntax tree visualization as a string (see writeSyntaxTree)
+    std::string toSyntaxTree(const RuntimeStats * stats, int line, int indent = 0) const;
 
-protected:
-    int execCount = 0;  // Track execution count for debugging
+    // Get type of statement (LET, IF, GOTO, ...)
+    virtual StatementType type() const = 0;
+
+    // Getter methods for analysis passes (throw if not applicable to this statement type)
+
+    // Get assigned/read variable name (only valid for LetStmt and InputStmt)
+    virtual std::string getVariableName() const {
+        throw std::runtime_error("getVariableName() not implemented for this statement type");
+    }
+
+    // Get expression operand (only valid for LetStmt and PrintStmt)
+    virtual Expression* getExpression() const {
+        throw std::runtime_error("getExpression() not implemented for this statement type");
+    }
+
+    // Get jump target line (only valid for GotoStmt and IfStmt)
+    virtual int getTargetLine() const {
+        throw std::runtime_error("getTargetLine() not implemented for this statement type");
+    }
+
+    // Get condition operands and relational operator (only valid for IfStmt)
+    virtual Expression* getLHS() const {
+        throw std::runtime_error("getLHS() not implemented for this statement type");
+    }
+    virtual Expression* getRHS() const {
+        throw std::runtime_error("getRHS() not implemented for this statement type");
+    }
+    virtual std::string getOperator() const {
+        throw std::runtime_error("getOperator() not implemented for this statement type");
+    }
 
-    // Helper method to generate indentation for tree visualization
-    std::string indentFunc(int n) const {
-        return std::string(n * 2, ' ');
+protected:
+    // Helper method to write indentation for tree visualization
+    static void writeIndent(std::ostream &out, int n) {
+        for (int i = 0; i < n; ++i) out << "  ";
     }
 };
 
@@ -49,7 +95,7 @@ public:
     RemStmt(const std::string &text);
     
     // Execute: comment statements do nothing
-    void execute(EvalState &state, Program &program) override;
+    void execute(EvalState &state, const Program &program) const override;
 
     // String representation
     std::string toString() const override {
@@ -57,7 +103,9 @@ public:
     }
 
     // Syntax tree representation
-    std::string toSyntaxTree(const RuntimeStats * stats, int indent) const override;
+    void writeSyntaxTree(std::ostream &out, const RuntimeStats * stats, int line, int indent) const override;
+
+    StatementType type() const override { return StatementType::REM; }
 
 private:
     std::string text;   // Comment text
@@ -74,7 +122,7 @@ public:
     ~LetStmt();
     
     // Execute: evaluate expression and assign to variable
-    void execute(EvalState &state, Program &program) override;
+    void execute(EvalState &state, const Program &program) const override;
 
     // String representation
     std::string toString() const override {
@@ -82,7 +130,11 @@ public:
     }
 
     // Syntax tree representation
-    std::string toSyntaxTree(const RuntimeStats * stats, int indent) const override;
+    void writeSyntaxTree(std::ostream &out, const RuntimeStats * stats, int line, int indent) const override;
+
+    StatementType type() const override { return StatementType::LET; }
+    std::string getVariableName() const override { return var; }
+    Expression* getExpression() const override { return exp; }
 
 private:
     std::string var;    // Variable name
@@ -100,7 +152,11 @@ public:
     ~PrintStmt();
     
     // Execute: evaluate expression and output result
-    void execute(EvalState &state, Program &program) override;
+    void execute(EvalState &state, const Program &program) const override;
+
+    // Output one value the way PRINT does (shared with other execution engines)
+    // Goes to state.outputConsumer as "<value>\n" when set, else to std::cout
+    static void print(EvalState &state, int value);
 
     // String representation
     std::string toString() const override {
@@ -108,7 +164,10 @@ public:
     }
 
     // Syntax tree representation
-    std::string toSyntaxTree(const RuntimeStats * stats, int indent) const override;
+    void writeSyntaxTree(std::ostream &out, const RuntimeStats * stats, int line, int indent) const override;
+
+    StatementType type() const override { return StatementType::PRINT; }
+    Expression* getExpression() const override { return exp; }
 
 private:
     Expression *exp;    // Expression to print
@@ -123,7 +182,7 @@ public:
     InputStmt(const std::string &varName);
     
     // Execute: read integer from input and assign to variable
-    void execute(EvalState &state, Program &program) override;
+    void execute(EvalState &state, const Program &program) const override;
 
     // String representation
     std::string toString() const override {
@@ -131,7 +190,10 @@ public:
     }
 
     // Syntax tree representation
-    std::string toSyntaxTree(const RuntimeStats * stats, int indent) const override;
+    void writeSyntaxTree(std::ostream &out, const RuntimeStats * stats, int line, int indent) const override;
+
+    StatementType type() const override { return StatementType::INPUT; }
+    std::string getVariableName() const override { return var; }
 
 private:
     std::string var;    // Target variable name
@@ -146,7 +208,7 @@ public:
     GotoStmt(int targetLine);
     
     // Execute: set next line to target line
-    void execute(EvalState &state, Program &program) override;
+    void execute(EvalState &state, const Program &program) const override;
 
     // String representation
     std::string toString() const override {
@@ -154,7 +216,10 @@ public:
     }
 
     // Syntax tree representation
-    std::string toSyntaxTree(const RuntimeStats * stats, int indent) const override;
+    void writeSyntaxTree(std::ostream &out, const RuntimeStats * stats, int line, int indent) const override;
+
+    StatementType type() const override { return StatementType::GOTO; }
+    int getTargetLine() const override { return target; }
 
 private:
     int target;         // Target line number
@@ -172,7 +237,7 @@ public:
     ~IfStmt();
     
     // Execute: evaluate condition, jump to target if true
-    void execute(EvalState &state, Program &program) override;
+    void execute(EvalState &state, const Program &program) const override;
 
     // String representation
     std::string toString() const override {
@@ -181,16 +246,19 @@ public:
     }
 
     // Syntax tree representation
-    std::string toSyntaxTree(const RuntimeStats * stats, int indent) const override;
+    void writeSyntaxTree(std::ostream &out, const RuntimeStats * stats, int line, int indent) const override;
+
+    StatementType type() const override { return StatementType::IF; }
+    int getTargetLine() const override { return target; }
+    Expression* getLHS() const override { return left; }
+    Expression* getRHS() const override { return right; }
+    std::string getOperator() const override { return op; }
 
 private:
     Expression *left;   // Left-hand side expression
     Expression *right;  // Right-hand side expression
     std::string op;     // Relational operator (=, <, >, etc.)
     int target;         // Target line number if condition true
-
-    int ifCount = 0;    // Debug counter
-    int thenCount = 0;  // Debug counter
 };
 
 // END Statement: Program termination
@@ -202,7 +270,7 @@ public:
     EndStmt() {}
     
     // Execute: mark program as ended
-    void execute(EvalState &state, Program &program) override;
+    void execute(EvalState &state, const Program &program) const override;
     
     // String representation
     std::string toString() const override {
@@ -210,5 +278,7 @@ public:
     }
     
     // Syntax tree representation
-    std::string toSyntaxTree(const RuntimeStats * stats, int indent) const override;
+    void writeSyntaxTree(std::ostream &out, const RuntimeStats * stats, int line, int indent) const override;
+
+    StatementType type() const override { return StatementType::END; }
 };
@@ -0,0 +1,267 @@
+#include "aotcompiler.h"
+#include "../core/statement.h"
+
+namespace {
+
+// Runtime support emitted at the top of every generated program
+const char *PRELUDE = R"(#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+int qb_line = 0;    // BASIC line being executed (for error reports)
+
+int qb_fail(const std::string &message) {
+    throw std::runtime_error(message);
+}
+
+inline int qb_get(bool defined, int value, const char *name) {
+    if (!defined) qb_fail(std::string("VARIABLE NOT DEFINED: ") + name);
+    return value;
+}
+
+inline int qb_add(int l, int r) { return (int)((unsigned)l + (unsigned)r); }
+inline int qb_sub(int l, int r) { return (int)((unsigned)l - (unsigned)r); }
+inline int qb_mul(int l, int r) { return (int)((unsigned)l * (unsigned)r); }
+
+inline int qb_div(int l, int r) {
+    if (r == 0) qb_fail("DIVIDE BY ZERO");
+    if (r == -1) return (int)(0u - (unsigned)l);    // INT_MIN / -1 wraps to INT_MIN
+    return l / r;
+}
+
+inline int qb_mod(int l, int r) {
+    if (r == 0) return 0;
+    if (r == -1) return 0;      // INT_MIN % -1 overflows
+    int result = l % r;
+    if ((r > 0 && result < 0) || (r < 0 && result > 0)) result += r;
+    return result;
+}
+
+inline int qb_pow(int l, int r) { return std::pow(l, r); }
+
+inline int qb_unknown(const char *op) {
+    return qb_fail(std::string("UNKNOWN OPERATOR: ") + op);
+}
+
+inline void qb_print(int value) { std::cout << value << '\n'; }
+
+// Read lines from stdin until one starts with an integer
+int qb_input() {
+    std::cout.flush();
+    std::string line;
+    while (true) {
+        if (!std::getline(std::cin, line)) qb_fail("END OF INPUT");
+        try {
+            return std::stoi(line);
+        } catch (...) {
+            std::cout << "INVALID NUMBER\n";
+        }
+    }
+}
+
+)";
+
+const char *EPILOGUE = R"(
+} // namespace
+
+int main() {
+    std::ios::sync_with_stdio(false);
+    try {
+        qb_run();
+    } catch (const std::exception &e) {
+        std::cout.flush();
+        std::cerr << "Runtime Error: " << e.what() << "\n";
+        std::cerr << "  at BASIC line " << qb_line << "\n";
+        return 1;
+    }
+    std::cout.flush();
+    return 0;
+}
+)";
+
+void collectNames(Expression *exp, std::map<std::string, bool> &names) {
+    if (exp->type() == IDENTIFIER) names[exp->getIdentifierName()] = true;
+    else if (exp->type() == COMPOUND) {
+        collectNames(exp->getLHS(), names);
+        collectNames(exp->getRHS(), names);
+    }
+}
+
+std::string label(int line) {
+    return "L" + std::to_string(line);
+}
+
+} // namespace
+
+// ============ AotCompiler Implementation ============
+
+AotCompiler::AotCompiler(const Program &program) : program(program) {}
+
+// Append text, tracking generated line numbers
+void AotCompiler::emit(const std::string &text) {
+    out << text;
+    for (char c : text) if (c == '\n') ++cppLine;
+}
+
+void AotCompiler::collectVariables() {
+    for (int line = program.getFirstLineNumber(); line != -1; line = program.getNextLineNumber(line)) {
+        Statement *stmt = program.getParsedStatement(line);
+        if (!stmt) continue;
+        switch (stmt->type()) {
+        case StatementType::LET:
+            variables[stmt->getVariableName()] = true;
+            collectNames(stmt->getExpression(), variables);
+            break;
+        case StatementType::INPUT:
+            variables[stmt->getVariableName()] = true;
+            break;
+        case StatementType::PRINT:
+            collectNames(stmt->getExpression(), variables);
+            break;
+        case StatementType::IF:
+            collectNames(stmt->getLHS(), variables);
+            collectNames(stmt->getRHS(), variables);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+std::string AotCompiler::translate(const std::string &sourceName) {
+    out.str("");
+    cppLine = 1;
+    temp = 0;
+    variables.clear();
+    lines.clear();
+    collectVariables();
+
+    emit("// Generated by qbasic-aot from " + sourceName + "\n");
+    emit(PRELUDE);
+
+    emit("void qb_run() {\n");
+    for (const auto &v : variables) {
+        emit("    int v_" + v.first + " = 0;\n");
+        emit("    bool d_" + v.first + " = false;\n");
+    }
+
+    // Interpreter::run starts by jumping to the first line
+    int first = program.getFirstLineNumber();
+    emit("    " + jump(first) + "\n");
+
+    for (int line = first; line != -1; line = program.getNextLineNumber(line)) {
+        lines.push_back({cppLine, line});
+        emit(label(line) + ":\n");
+        emit("    qb_line = " + std::to_string(line) + ";\n");
+
+        Statement *stmt = program.getParsedStatement(line);
+        if (stmt) statement(line, stmt, program.getNextLineNumber(line));
+    }
+
+    // Falling off the last line is reported like a jump to a missing line
+    if (first != -1) emit("    qb_fail(\"Goto none-exsiting line\");\n");
+    emit("}\n");
+    emit(EPILOGUE);
+    return out.str();
+}
+
+std::string AotCompiler::lineMapText() const {
+    std::string text;
+    for (const auto &entry : lines)
+        text += std::to_string(entry.first) + " " + std::to_string(entry.second) + "\n";
+    return text;
+}
+
+// Jump statement for a target line (missing lines fail like Program::requireLine)
+std::string AotCompiler::jump(int target) {
+    if (!program.hasLine(target)) return "qb_fail(\"Goto none-exsiting line\");";
+    return "goto " + label(target) + ";";
+}
+
+void AotCompiler::statement(int line, Statement *stmt, int fallthrough) {
+    // Interpreter::run treats a jump to the current line as no jump at all
+    auto jumpFrom = [&](int target) {
+        return jump(target == line ? fallthrough : target);
+    };
+
+    switch (stmt->type()) {
+    case StatementType::REM:
+        break;
+    case StatementType::LET: {
+        emit("    {\n");
+        std::string value = expression(stmt->getExpression());
+        std::string var = stmt->getVariableName();
+        emit("        v_" + var + " = " + value + ";\n");
+        emit("        d_" + var + " = true;\n");
+        emit("    }\n");
+        break;
+    }
+    case StatementType::PRINT: {
+        emit("    {\n");
+        std::string value = expression(stmt->getExpression());
+        emit("        qb_print(" + value + ");\n");
+        emit("    }\n");
+        break;
+    }
+    case StatementType::INPUT: {
+        std::string var = stmt->getVariableName();
+        emit("    v_" + var + " = qb_input();\n");
+        emit("    d_" + var + " = true;\n");
+        break;
+    }
+    case StatementType::GOTO:
+        emit("    " + jumpFrom(stmt->getTargetLine()) + "\n");
+        return;
+    case StatementType::IF: {
+        emit("    {\n");
+        std::string l = expression(stmt->getLHS());
+        std::string r = expression(stmt->getRHS());
+        std::string op = stmt->getOperator();
+        // Other relational operators are never true in IfStmt::execute
+        if (op == "=" || op == "<" || op == ">") {
+            std::string cop = op == "=" ? "==" : op;
+            emit("        if (" + l + " " + cop + " " + r + ") " + jumpFrom(stmt->getTargetLine()) + "\n");
+        }
+        emit("    }\n");
+        break;
+    }
+    case StatementType::END:
+        emit("    return;\n");
+        return;
+    }
+}
+
+// Emit one temporary per node in evaluation order; returns the result temporary
+std::string AotCompiler::expression(Expression *exp) {
+    std::string value;
+    switch (exp->type()) {
+    case CONSTANT:
+        value = "(" + std::to_string(exp->getConstantValue()) + ")";
+        break;
+    case IDENTIFIER: {
+        std::string name = exp->getIdentifierName();
+        value = "qb_get(d_" + name + ", v_" + name + ", \"" + name + "\")";
+        break;
+    }
+    case COMPOUND: {
+        std::string l = expression(exp->getLHS());
+        std::string r = expression(exp->getRHS());
+        std::string op = exp->getOperator();
+        if (op == "+") value = "qb_add(" + l + ", " + r + ")";
+        else if (op == "-") value = "qb_sub(" + l + ", " + r + ")";
+        else if (op == "*") value = "qb_mul(" + l + ", " + r + ")";
+        else if (op == "/") value = "qb_div(" + l + ", " + r + ")";
+        else if (op == "MOD") value = "qb_mod(" + l + ", " + r + ")";
+        else if (op == "**") value = "qb_pow(" + l + ", " + r + ")";
+        else value = "qb_unknown(\"" + op + "\")";
+        break;
+    }
+    }
+
+    std::string t = "t" + std::to_string(temp++);
+    emit("        int " + t + " = " + value + ";\n");
+    return t;
+}
@@ -0,0 +1,61 @@
+/**
+ * @file    aotcompiler.h
+ * @brief   Ahead-of-time translation of a parsed Program into C++ source
+ *
+ *          Every BASIC line becomes a label, every variable a local of a
+ *          single function and GOTO/IF jumps become goto. The generated
+ *          program reads INPUT values from stdin, writes PRINT output to
+ *          stdout and stops with the same error messages as Interpreter::run
+ *          (printed as "Runtime Error: <message>" plus the BASIC line on
+ *          stderr, exit code 1).
+ *
+ *          Expressions are emitted as one temporary per node in the
+ *          interpreter's evaluation order so that the first error raised is
+ *          the same one the interpreter would raise.
+ *
+ * @author  simple_wind
+ * @version 1.0
+ * @date    2025-12-10
+ * */
+
+#pragma once
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../core/program.h"
+
+class Statement;
+class Expression;
+
+class AotCompiler {
+public:
+    explicit AotCompiler(const Program &program);
+
+    // Translate the program into a complete C++17 translation unit
+    // sourceName: BASIC file name mentioned in the generated header comment
+    std::string translate(const std::string &sourceName = "program.bas");
+
+    // Line mapping of the last translation: (generated C++ line, BASIC line)
+    const std::vector<std::pair<int, int>> &lineMap() const { return lines; }
+
+    // Write the line mapping as "<cpp line> <basic line>" text
+    std::string lineMapText() const;
+
+private:
+    const Program &program;
+    std::ostringstream out;
+    int cppLine = 1;                        // current line in the generated text
+    int temp = 0;                           // next temporary index
+    std::map<std::string, bool> variables;  // every variable of the program
+    std::vector<std::pair<int, int>> lines;
+
+    void emit(const std::string &text);
+    void collectVariables();
+    void statement(int line, Statement *stmt, int fallthrough);
+    std::string expression(Expression *exp);
+    std::string jump(int target);
+};
@@ -0,0 +1,362 @@
+#include "batchrunner.h"
+#include "cycledetector.h"
+#include "interpreter.h"
+#include "runlimits.h"
+#include "threadpool.h"
+#include "programloader.h"
+#include "spmd.h"
+#include "vm.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+std::string readFile(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) throw std::runtime_error("cannot open " + path);
+    std::ostringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+// Directory part of a path, including the trailing separator
+std::string directoryOf(const std::string &path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? "" : path.substr(0, slash + 1);
+}
+
+bool isAbsolute(const std::string &path) {
+    if (!path.empty() && (path[0] == '/' || path[0] == '\\')) return true;
+    return path.size() > 1 && path[1] == ':';
+}
+
+std::string jsonString(const std::string &text) {
+    std::string out = "\"";
+    for (unsigned char c : text) {
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (c < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof buf, "\\u%04x", c);
+                out += buf;
+            } else {
+                out += (char)c;
+            }
+        }
+    }
+    return out + "\"";
+}
+
+uint64_t statementsOf(const EvalState &state) {
+    uint64_t total = 0;
+    const RuntimeStats *rs = state.getRuntimeStats();
+    if (!rs) return 0;
+    for (const auto &entry : rs->lineCounters) total += entry.second.execCount;
+    return total;
+}
+
+// Run an already loaded program with a fresh EvalState
+// vm: the program compiled for the register machine, nullptr for the tree walker
+BatchResult runLoaded(const Program &program, RegisterVM *vm, const std::string &input,
+                      const BatchOptions &options) {
+    BatchResult result;
+
+    Interpreter interpreter;
+    interpreter.setTimeLimit(options.timeLimit);
+    interpreter.setCycleDetection(options.detectLoops);
+
+    CycleDetector detector;
+    std::istringstream lines(input);
+    interpreter.setInputProvider([&lines, &detector]() -> std::string {
+        detector.inputRead();
+        std::string line;
+        if (!std::getline(lines, line)) throw std::runtime_error("END OF INPUT");
+        return line;
+    });
+    interpreter.setOutputConsumer([&result](std::string_view text) {
+        result.output += text;
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    try {
+        if (vm) {
+            // Same as Interpreter::run with the VM enabled, minus the compile
+            if (options.timeLimit > 0)
+                vm->setDeadline(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                            std::chrono::duration<double>(options.timeLimit)));
+            else
+                vm->clearDeadline();
+            vm->setCycleDetector(options.detectLoops ? &detector : nullptr);
+            vm->run(interpreter.getState(), program);
+            interpreter.getState().recoverEnd();
+        } else {
+            interpreter.run(program);
+        }
+        result.status = "ok";
+    } catch (const TimeLimitError &e) {
+        result.status = "timeout";
+        result.message = e.what();
+    } catch (const InfiniteLoopError &e) {
+        result.status = "loop";
+        result.message = e.what();
+    } catch (const std::exception &e) {
+        result.status = "error";
+        result.message = e.what();
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.statements = statementsOf(interpreter.getState());
+
+    if (options.training && interpreter.getState().getRuntimeStats()) {
+        try {
+            options.training->add(program, *interpreter.getState().getRuntimeStats());
+        } catch (const std::exception &e) {
+            result.status = "error";
+            result.message = e.what();
+        }
+    }
+    return result;
+}
+
+// Run up to SpmdEngine::LANES input vectors together
+std::vector<BatchResult> runLanes(SpmdEngine &engine, const std::vector<std::vector<std::string>> &inputs,
+                                  const BatchOptions &options) {
+    auto start = std::chrono::steady_clock::now();
+    if (options.timeLimit > 0)
+        engine.setDeadline(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                       std::chrono::duration<double>(options.timeLimit)));
+    else
+        engine.clearDeadline();
+
+    std::vector<SpmdLaneResult> lanes = engine.run(inputs);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<BatchResult> results(lanes.size());
+    for (size_t l = 0; l < lanes.size(); ++l) {
+        BatchResult &r = results[l];
+        r.status = lanes[l].status == SpmdLaneResult::Ok ? "ok"
+                 : lanes[l].status == SpmdLaneResult::Timeout ? "timeout" : "error";
+        r.message = lanes[l].message;
+        r.output = lanes[l].output;
+        r.statements = lanes[l].statements;
+        r.seconds = seconds;
+    }
+    return results;
+}
+
+std::vector<std::string> splitLines(const std::string &text) {
+    std::vector<std::string> lines;
+    std::istringstream in(text);
+    std::string line;
+    while (std::getline(in, line)) lines.push_back(line);
+    return lines;
+}
+
+} // namespace
+
+std::vector<BatchJob> readBatchManifest(const std::string &path) {
+    std::istringstream text(readFile(path));
+    std::string base = directoryOf(path);
+    auto resolve = [&](const std::string &p) { return isAbsolute(p) ? p : base + p; };
+
+    std::vector<BatchJob> jobs;
+    std::string line;
+    int number = 0;
+    while (std::getline(text, line)) {
+        ++number;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+
+        std::istringstream fields(line);
+        std::string program, input, extra;
+        if (!(fields >> program)) continue;
+        fields >> input;
+        if (fields >> extra)
+            throw std::runtime_error(path + ":" + std::to_string(number) + ": expected <program> [input]");
+
+        BatchJob job;
+        job.name = program;
+        job.programPath = resolve(program);
+        if (!input.empty()) job.inputPath = resolve(input);
+        jobs.push_back(job);
+    }
+    return jobs;
+}
+
+BatchResult runBatchSource(const std::string &source, const std::string &input,
+                           const BatchOptions &options) {
+    Program program;
+    std::vector<std::string> errors = loadProgramText(source, program);
+    if (!errors.empty()) {
+        BatchResult result;
+        result.status = "load_error";
+        result.message = errors.front();
+        return result;
+    }
+
+    if (options.engine == BatchEngine::Spmd) {
+        SpmdEngine engine(program);
+        return runLanes(engine, {splitLines(input)}, options).front();
+    }
+
+    std::unique_ptr<RegisterVM> vm;
+    if (options.engine == BatchEngine::Vm) vm.reset(new RegisterVM(program, options.profile));
+    return runLoaded(program, vm.get(), input, options);
+}
+
+BatchResult runBatchJob(const BatchJob &job, const BatchOptions &options) {
+    BatchResult result;
+    try {
+        std::string source = readFile(job.programPath);
+        std::string input = job.inputPath.empty() ? "" : readFile(job.inputPath);
+        result = runBatchSource(source, input, options);
+    } catch (const std::exception &e) {
+        result.status = "load_error";
+        result.message = e.what();
+    }
+    result.name = job.name;
+    return result;
+}
+
+BatchResult runReplay(const SessionRecording &recording, const BatchOptions &options) {
+    Program program;
+    loadProgramText(recording.source, program);
+
+    std::unique_ptr<RegisterVM> vm;
+    if (options.engine != BatchEngine::Tree) vm.reset(new RegisterVM(program, options.profile));
+    BatchResult result = runLoaded(program, vm.get(), recording.inputText(), options);
+
+    uint64_t hash = OUTPUT_HASH_START;
+    hashOutput(hash, result.output);
+    bool sameOutput = result.output.size() == recording.outputBytes && hash == recording.outputHash;
+    bool sameError = result.status == "ok" ? recording.error.empty() : result.message == recording.error;
+    if ((result.status == "ok" || result.status == "error") && !(sameOutput && sameError)) {
+        result.status = "diverged";
+        result.message = !sameOutput ? "output differs from the recording"
+                       : "recorded \"" + recording.error + "\", got \"" + result.message + "\"";
+    }
+    return result;
+}
+
+std::vector<BatchResult> runBatch(const std::vector<BatchJob> &jobs, const BatchOptions &options,
+                                  std::function<void(const BatchResult &)> onResult) {
+    std::vector<BatchResult> results(jobs.size());
+    std::mutex reportMutex;
+
+    WorkStealingPool pool(options.threads);
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        pool.submit([&, i]() {
+            results[i] = runBatchJob(jobs[i], options);
+            if (onResult) {
+                std::lock_guard<std::mutex> lock(reportMutex);
+                onResult(results[i]);
+            }
+        });
+    }
+    pool.wait();
+    return results;
+}
+
+std::vector<std::vector<std::string>> parseSweepVectors(const std::string &text) {
+    std::vector<std::vector<std::string>> vectors;
+    std::istringstream lines(text);
+    std::string line;
+    while (std::getline(lines, line)) {
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        std::replace(line.begin(), line.end(), ',', ' ');
+
+        std::istringstream fields(line);
+        std::vector<std::string> values;
+        std::string value;
+        while (fields >> value) values.push_back(value);
+        if (!values.empty()) vectors.push_back(values);
+    }
+    return vectors;
+}
+
+std::vector<std::vector<std::string>> readSweepVectors(const std::string &path) {
+    return parseSweepVectors(readFile(path));
+}
+
+std::vector<BatchResult> runSweep(const Program &program,
+                                  const std::vector<std::vector<std::string>> &vectors,
+                                  const BatchOptions &options,
+                                  std::function<void(const BatchResult &)> onResult) {
+    std::vector<BatchResult> results(vectors.size());
+
+    // Results are reported in input order: a finished run waits in `results`
+    // until every run before it has been reported
+    std::vector<uint8_t> finished(vectors.size(), 0);
+    size_t nextReport = 0;
+    std::mutex reportMutex;
+
+    WorkStealingPool pool(options.threads);
+
+    // Several vectors per task so the engine is compiled once per chunk,
+    // enough chunks per worker for stealing to even out slow vectors
+    size_t group = options.engine == BatchEngine::Spmd ? SpmdEngine::LANES : 1;
+    size_t chunk = std::max<size_t>(1, vectors.size() / (pool.size() * 8));
+    chunk = (chunk + group - 1) / group * group;
+    for (size_t first = 0; first < vectors.size(); first += chunk) {
+        size_t last = std::min(vectors.size(), first + chunk);
+        pool.submit([&, first, last]() {
+            std::unique_ptr<RegisterVM> vm;
+            std::unique_ptr<SpmdEngine> lanes;
+            if (options.engine == BatchEngine::Vm) vm.reset(new RegisterVM(program, options.profile));
+            if (options.engine == BatchEngine::Spmd) lanes.reset(new SpmdEngine(program));
+
+            for (size_t i = first; i < last; i += group) {
+                size_t end = std::min(last, i + group);
+                std::vector<BatchResult> done;
+                if (lanes) {
+                    done = runLanes(*lanes, std::vector<std::vector<std::string>>(
+                                                vectors.begin() + i, vectors.begin() + end), options);
+                } else {
+                    std::string input;
+                    for (const std::string &value : vectors[i]) input += value + "\n";
+                    done.push_back(runLoaded(program, vm.get(), input, options));
+                }
+
+                std::lock_guard<std::mutex> lock(reportMutex);
+                for (size_t k = i; k < end; ++k) {
+                    BatchResult &result = done[k - i];
+                    for (const std::string &value : vectors[k])
+                        result.name += (result.name.empty() ? "" : " ") + value;
+                    results[k] = std::move(result);
+                    finished[k] = 1;
+                }
+                while (nextReport < results.size() && finished[nextReport]) {
+                    if (onResult) onResult(results[nextReport]);
+                    ++nextReport;
+                }
+            }
+        });
+    }
+    pool.wait();
+    return results;
+}
+
+std::string batchResultJson(const BatchResult &result, bool includeOutput) {
+    char seconds[32];
+    std::snprintf(seconds, sizeof seconds, "%.6f", result.seconds);
+
+    std::string json = "{\"name\":" + jsonString(result.name)
+                       + ",\"status\":" + jsonString(result.status);
+    if (!result.message.empty()) json += ",\"message\":" + jsonString(result.message);
+    json += ",\"seconds\":" + std::string(seconds)
+            + ",\"statements\":" + std::to_string(result.statements);
+    if (includeOutput) json += ",\"output\":" + jsonString(result.output);
+    return json + "}";
+}
@@ -0,0 +1,109 @@
+/**
+ * @file    batchrunner.h
+ * @brief   Runs many programs in parallel without the GUI
+ *
+ *          A manifest lists one job per line: a program file and an optional
+ *          input file ("#" starts a comment, relative paths are relative to
+ *          the manifest). Jobs run on a WorkStealingPool; each one gets its
+ *          own Program, Interpreter (and so its own EvalState), output buffer
+ *          and time limit. Results are reported as one JSON object per line.
+ *
+ *          A sweep runs one program many times, once per input vector. The
+ *          program is parsed once and shared read-only by all workers; each
+ *          worker compiles it once for its engine and reuses that for every
+ *          vector it runs.
+ *
+ * @author  simple_wind
+ * @version 1.0
+ * @date    2025-12-12
+ * */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "../core/program.h"
+#include "branchprofile.h"
+#include "sessionrecording.h"
+
+struct BatchJob {
+    std::string name;           // label in the report (the program path as written)
+    std::string programPath;
+    std::string inputPath;      // empty: INPUT fails with END OF INPUT
+};
+
+enum class BatchEngine {
+    Tree,       // tree-walking Interpreter
+    Vm,         // RegisterVM
+    Spmd        // SpmdEngine; a sweep runs SpmdEngine::LANES vectors at once
+};
+
+struct BatchOptions {
+    int threads = 0;            // 0 = one per hardware thread
+    double timeLimit = 0;       // seconds per job, 0 = unlimited
+    BatchEngine engine = BatchEngine::Vm;
+    bool detectLoops = false;   // stop proven endless loops (see CycleDetector;
+                                // not available with BatchEngine::Spmd)
+    const BranchProfile *profile = nullptr;     // layout of the register machine code
+                                                // (BatchEngine::Vm; not owned)
+    BranchProfile *training = nullptr;  // add the counters of every run from all threads
+                                        // (runs must all be of one program; not with
+                                        // BatchEngine::Spmd)
+};
+
+struct BatchResult {
+    std::string name;
+    std::string status;         // "ok", "error", "timeout", "loop", "load_error"
+                                // or "diverged" (runReplay)
+    std::string message;        // error text for anything but "ok"
+    double seconds = 0;         // wall time of the run (loading excluded; with
+                                // BatchEngine::Spmd, of the whole lane group)
+    uint64_t statements = 0;    // statements executed (sum of execCount)
+    std::string output;         // everything the program printed
+};
+
+// Read a manifest file
+// Throws std::runtime_error if the file cannot be opened or a line is malformed
+std::vector<BatchJob> readBatchManifest(const std::string &path);
+
+// Run one program given as source text, feeding `input` line by line to INPUT
+BatchResult runBatchSource(const std::string &source, const std::string &input,
+                           const BatchOptions &options);
+
+// Load and run one job from its files
+BatchResult runBatchJob(const BatchJob &job, const BatchOptions &options);
+
+// Replay a recorded session headlessly: its program (lines that did not
+// parse stay without a statement, as in the GUI) fed with its recorded
+// inputs. Status "diverged" if the output or the error differ from the
+// recording; BatchEngine::Spmd replays on the register machine
+BatchResult runReplay(const SessionRecording &recording, const BatchOptions &options);
+
+// Run all jobs on a work-stealing pool
+// onResult (optional) is called as each job finishes, one call at a time
+// Returns: results in manifest order
+std::vector<BatchResult> runBatch(const std::vector<BatchJob> &jobs, const BatchOptions &options,
+                                  std::function<void(const BatchResult &)> onResult = nullptr);
+
+// Parse input vectors: one vector per non-empty line, values separated by
+// blanks or commas, "#" starts a comment. Each value is one INPUT line
+std::vector<std::vector<std::string>> parseSweepVectors(const std::string &text);
+
+// Read input vectors from a file (throws std::runtime_error if unreadable)
+std::vector<std::vector<std::string>> readSweepVectors(const std::string &path);
+
+// Run the program once per input vector on a work-stealing pool
+// Result names are the input vectors as written ("3 5")
+// onResult (optional) is called in input order as results become available
+// Returns: results in input order
+std::vector<BatchResult> runSweep(const Program &program,
+                                  const std::vector<std::vector<std::string>> &vectors,
+                                  const BatchOptions &options,
+                                  std::function<void(const BatchResult &)> onResult = nullptr);
+
+// One-line JSON report of a result
+// includeOutput: add the program output as an "output" field
+std::string batchResultJson(const BatchResult &result, bool includeOutput = false);
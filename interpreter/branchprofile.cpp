@@ -0,0 +1,88 @@
+#include "branchprofile.h"
+#include "snapshot.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+const char *MAGIC = "QBPROFILE 1";
+
+// Next line of the file, without a trailing '\r'
+std::string readLine(std::istream &in) {
+    std::string line;
+    if (!std::getline(in, line)) throw std::runtime_error("truncated profile file");
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    return line;
+}
+
+// Number after "<key> " on a line starting with the key
+uint64_t field(const std::string &line, const std::string &key) {
+    if (line.compare(0, key.size() + 1, key + " ") != 0) throw std::runtime_error("truncated profile file");
+    try {
+        return std::stoull(line.substr(key.size() + 1));
+    } catch (const std::logic_error &) {
+        throw std::runtime_error("truncated profile file");
+    }
+}
+
+} // namespace
+
+// ============ BranchProfile Implementation ============
+
+BranchProfile::BranchProfile(const BranchProfile &other)
+    : programHash(other.programHash), runs(other.runs), lines(other.lines) {}
+
+BranchProfile &BranchProfile::operator=(const BranchProfile &other) {
+    programHash = other.programHash;
+    runs = other.runs;
+    lines = other.lines;
+    return *this;
+}
+
+void BranchProfile::add(const Program &program, const RuntimeStats &stats) {
+    std::lock_guard<std::mutex> lock(addMutex);
+    if (!matches(program)) throw std::runtime_error("PROFILE OF A DIFFERENT PROGRAM");
+    programHash = programFingerprint(program);
+    ++runs;
+    for (const auto &entry : stats.lineCounters) {
+        if (entry.second.execCount == 0) continue;
+        LineProfile &l = lines[entry.first];
+        l.executed += (uint64_t)entry.second.execCount;
+        l.taken += (uint64_t)entry.second.thenCount;
+    }
+}
+
+bool BranchProfile::matches(const Program &program) const {
+    return runs == 0 || programHash == programFingerprint(program);
+}
+
+void BranchProfile::save(std::ostream &out) const {
+    out << MAGIC << "\n";
+    out << "program " << programHash << "\n";
+    out << "runs " << runs << "\n";
+    for (const auto &entry : lines)
+        out << entry.first << " " << entry.second.executed << " " << entry.second.taken << "\n";
+}
+
+BranchProfile BranchProfile::load(std::istream &in) {
+    std::string line;
+    if (!std::getline(in, line)) throw std::runtime_error("not a profile file");
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line != MAGIC) throw std::runtime_error("not a profile file");
+
+    BranchProfile p;
+    p.programHash = field(readLine(in), "program");
+    p.runs = field(readLine(in), "runs");
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        std::istringstream fields(line);
+        int number;
+        LineProfile l;
+        if (!(fields >> number >> l.executed >> l.taken)) throw std::runtime_error("truncated profile file");
+        p.lines[number] = l;
+    }
+    return p;
+}
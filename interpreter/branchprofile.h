@@ -0,0 +1,78 @@
+/**
+ * @file    branchprofile.h
+ * @brief   Line and branch counts of training runs, for profile-guided
+ *          compilation
+ *
+ *          Every engine already counts how often each line ran and, for an
+ *          IF, how often its jump was taken (thenCount) or not (ifCount). A
+ *          BranchProfile sums these counters over any number of training
+ *          runs of one program and keeps them in a file, so a later
+ *          RegisterVM can lay its code out for the paths that are actually
+ *          hot (see RegisterVM's profile constructor).
+ *
+ *          A profile is tied to its program by programFingerprint; merging
+ *          runs of another program or compiling another program with it is
+ *          refused.
+ *
+ *          Profile files are text:
+ *
+ *            QBPROFILE 1
+ *            program <fingerprint>
+ *            runs <training runs merged>
+ *            <line> <executed> <taken>      one per line that ran
+ *
+ * @author  simple_wind
+ * @version 1.0
+ * @date    2025-12-21
+ * */
+
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <mutex>
+#include <ostream>
+
+#include "../core/program.h"
+#include "../runtime/evalstate.h"
+
+// Counts of one line over the training runs
+struct LineProfile {
+    uint64_t executed = 0;      // times the statement ran
+    uint64_t taken = 0;         // IF: times the jump was taken
+};
+
+struct BranchProfile {
+    uint64_t programHash = 0;           // see programFingerprint
+    uint64_t runs = 0;                  // training runs merged
+    std::map<int, LineProfile> lines;   // line number -> counts
+
+    BranchProfile() = default;
+    BranchProfile(const BranchProfile &other);
+    BranchProfile &operator=(const BranchProfile &other);
+
+    // Add the counters of one run of `program`; training runs on several
+    // threads may add at the same time (nothing else may touch the profile
+    // meanwhile)
+    // Throws std::runtime_error("PROFILE OF A DIFFERENT PROGRAM") if runs of
+    // another program were merged before
+    void add(const Program &program, const RuntimeStats &stats);
+
+    // True if the profile was trained on this program (or is empty)
+    bool matches(const Program &program) const;
+
+    // Counts of a line (all zero if it never ran)
+    LineProfile line(int number) const {
+        auto it = lines.find(number);
+        return it == lines.end() ? LineProfile() : it->second;
+    }
+
+    // Throws std::runtime_error("not a profile file") or ("truncated
+    // profile file") if the stream does not hold a profile
+    void save(std::ostream &out) const;
+    static BranchProfile load(std::istream &in);
+
+private:
+    std::mutex addMutex;                // serializes add()
+};
@@ -0,0 +1,103 @@
+#include "cycledetector.h"
+#include "../core/statement.h"
+#include <set>
+
+namespace {
+
+uint64_t hashState(const std::vector<int32_t> &state) {
+    uint64_t h = 0x9E3779B97F4A7C15ull;
+    for (int32_t v : state) {
+        h ^= (uint32_t)v;
+        h *= 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 31;
+    }
+    return h;
+}
+
+} // namespace
+
+// ============ CycleDetector Implementation ============
+
+CycleDetector::CycleDetector() : recent(HISTORY) {}
+
+void CycleDetector::encode(int line, const EvalState &state) {
+    current.clear();
+    current.push_back(line);
+    for (const auto &entry : state.getVariables()) {
+        auto it = ids.find(entry.first);
+        if (it == ids.end()) it = ids.emplace(entry.first, (int32_t)ids.size()).first;
+        current.push_back(it->second);
+        current.push_back(entry.second);
+    }
+}
+
+bool CycleDetector::matches(const Sample &s, uint64_t hash) const {
+    return s.valid && s.hash == hash && s.state == current;
+}
+
+bool CycleDetector::sample(int line, const EvalState &state) {
+    encode(line, state);
+    uint64_t hash = hashState(current);
+
+    if (matches(checkpoint, hash)) return true;
+    for (const Sample &s : recent) {
+        if (matches(s, hash)) return true;
+    }
+
+    Sample &slot = recent[next];
+    next = (next + 1) % HISTORY;
+    slot.hash = hash;
+    slot.state = current;
+    slot.valid = true;
+
+    // Brent: move the checkpoint after 1, 2, 4, 8, ... samples
+    if (++sinceCheckpoint >= power || !checkpoint.valid) {
+        checkpoint = slot;
+        sinceCheckpoint = 0;
+        power *= 2;
+    }
+    return false;
+}
+
+void CycleDetector::inputRead() {
+    for (Sample &s : recent) s.valid = false;
+    checkpoint.valid = false;
+    sinceCheckpoint = 0;
+    power = 1;
+    countdown = INTERVAL;
+}
+
+// Replay one period on a copy: the run is deterministic, so it comes back to
+// the same line with the same variables
+InfiniteLoopError CycleDetector::error(const Program &program, int line, const EvalState &state) {
+    EvalState copy(state);
+    copy.outputConsumer = [](std::string_view) {};
+    const std::map<std::string, int> start = copy.getVariables();
+
+    std::set<int> lines;
+    try {
+        int current = line;
+        do {
+            Statement *stmt = program.getParsedStatement(current);
+            copy.setNextLine(current);
+            if (stmt) {
+                lines.insert(current);
+                copy.setCurrentLine(current);
+                stmt->execute(copy, program);
+                if (copy.isEnded()) break;
+            }
+            if (copy.getNextLine() == current)
+                copy.setNextLine(program.requireLine(program.getNextLineNumber(current)));
+            current = copy.getNextLine();
+        } while (current != line || copy.getVariables() != start);
+    } catch (const std::exception &) {
+        lines.clear();      // not expected: report the line the cycle was found at
+    }
+    if (lines.empty()) lines.insert(line);
+
+    std::string names;
+    for (int l : lines) names += (names.empty() ? "" : ", ") + std::to_string(l);
+    bool one = lines.size() == 1;
+    return InfiniteLoopError(std::string("INFINITE LOOP: ") + (one ? "LINE " : "LINES ") + names
+                             + (one ? " REPEATS" : " REPEAT") + " WITH THE SAME VARIABLES");
+}
@@ -0,0 +1,88 @@
+/**
+ * @file    cycledetector.h
+ * @brief   Proves that a run without INPUT repeats itself forever
+ *
+ *          Without INPUT a program is deterministic: the next line and the
+ *          variables decide everything that follows. If the same state is
+ *          seen twice the run can never end, so it is stopped with
+ *          InfiniteLoopError instead of waiting for a time limit.
+ *
+ *          The state is sampled every INTERVAL back edges (the register VM
+ *          samples every INTERVAL block entries). Each sample is hashed and
+ *          kept in a bounded history: the last HISTORY samples, which catch
+ *          short cycles at once, plus one checkpoint moved at power-of-two
+ *          sample counts (Brent's method), which catches cycles of any
+ *          length within about twice their period. A hash match is only
+ *          accepted after comparing the full states. The error names the
+ *          lines of the cycle, found by replaying one period on a copy of
+ *          the state.
+ *
+ *          A state is only known to repeat while nothing outside it drives
+ *          the run, so the history is dropped whenever INPUT reads a line
+ *          (see inputRead).
+ *
+ * @author  simple_wind
+ * @version 1.0
+ * @date    2025-12-15
+ * */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../core/program.h"
+#include "../runtime/evalstate.h"
+
+// Thrown when a run is proven never to end
+class InfiniteLoopError : public std::runtime_error {
+public:
+    explicit InfiniteLoopError(const std::string &message) : std::runtime_error(message) {}
+};
+
+class CycleDetector {
+public:
+    static const int INTERVAL = 16;     // back edges between samples
+    static const int HISTORY = 32;      // recent samples kept
+
+    CycleDetector();
+
+    // A back edge was taken; true when the state should be sampled now
+    bool backEdge() {
+        if (--countdown > 0) return false;
+        countdown = INTERVAL;
+        return true;
+    }
+
+    // Record the state about to execute `line`; true if it was seen before
+    bool sample(int line, const EvalState &state);
+
+    // INPUT read a line: earlier samples prove nothing any more
+    void inputRead();
+
+    // Error naming the lines executed by one period of the cycle that starts
+    // at `line` with the variables of `state` (the state is not modified)
+    static InfiniteLoopError error(const Program &program, int line, const EvalState &state);
+
+private:
+    struct Sample {
+        uint64_t hash = 0;
+        std::vector<int32_t> state;     // line, then (variable id, value) by name
+        bool valid = false;
+    };
+
+    int countdown = INTERVAL;
+    std::map<std::string, int32_t> ids;     // variable name -> id in snapshots
+    std::vector<int32_t> current;
+    std::vector<Sample> recent;             // ring of the last HISTORY samples
+    int next = 0;                           // ring slot for the next sample
+    Sample checkpoint;
+    long long sinceCheckpoint = 0;
+    long long power = 1;                    // samples until the checkpoint moves
+
+    void encode(int line, const EvalState &state);
+    bool matches(const Sample &s, uint64_t hash) const;
+};
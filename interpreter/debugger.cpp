@@ -0,0 +1,190 @@
+#include "debugger.h"
+#include "../runtime/parser.h"
+
+// ============ Debugger Implementation ============
+
+Debugger::Debugger(const Program &program) : program(program) {}
+
+Debugger::~Debugger() = default;
+
+void Debugger::setBreakpoint(int line, const std::string &condition) {
+    Breakpoint bp;
+    if (!condition.empty()) {
+        // Parsed as the condition of an IF: same relations, same errors
+        Parser parser;
+        bp.condition.reset(parser.parseLine(line, "IF " + condition + " THEN " + std::to_string(line)));
+        if (!bp.condition || bp.condition->type() != StatementType::IF)
+            throw std::runtime_error("INVALID CONDITION: " + condition);
+    }
+    breakpoints[line] = std::move(bp);
+}
+
+void Debugger::clearBreakpoint(int line) {
+    breakpoints.erase(line);
+}
+
+void Debugger::watch(const std::string &name) {
+    watches.emplace(name, WatchedValue());
+}
+
+void Debugger::unwatch(const std::string &name) {
+    watches.erase(name);
+}
+
+void Debugger::clearAll() {
+    breakpoints.clear();
+    watches.clear();
+}
+
+// Start a run if none is paused; true if one was started
+bool Debugger::begin(Interpreter &interpreter) {
+    if (interpreter.isSuspended()) return false;
+    interpreter.start(program);
+    return true;
+}
+
+bool Debugger::conditionHolds(const Breakpoint &bp, EvalState &state) const {
+    if (!bp.condition) return true;
+
+    // Evaluate against scratch statistics: identifier counts stay the run's
+    RuntimeStats scratch;
+    RuntimeStats *stats = state.getRuntimeStats();
+    state.setRuntimeStats(&scratch);
+    bool holds = false;
+    try {
+        int l = bp.condition->getLHS()->eval(state);
+        int r = bp.condition->getRHS()->eval(state);
+        std::string op = bp.condition->getOperator();
+        holds = op == "=" ? l == r : op == "<" ? l < r : op == ">" ? l > r : false;
+    } catch (const std::exception &) {
+        holds = false;
+    }
+    state.setRuntimeStats(stats);
+    return holds;
+}
+
+void Debugger::rememberWatched(const EvalState &state) {
+    const std::map<std::string, int> &vars = state.getVariables();
+    for (auto &entry : watches) {
+        auto it = vars.find(entry.first);
+        entry.second.defined = it != vars.end();
+        entry.second.value = entry.second.defined ? it->second : 0;
+    }
+}
+
+bool Debugger::watchTriggered(const EvalState &state, DebugStop &stop) {
+    const std::map<std::string, int> &vars = state.getVariables();
+    for (const auto &entry : watches) {
+        auto it = vars.find(entry.first);
+        if (it == vars.end()) continue;
+        const WatchedValue &before = entry.second;
+        if (before.defined && before.value == it->second) continue;
+
+        stop.event = DebugEvent::Watchpoint;
+        stop.variable = entry.first;
+        stop.wasDefined = before.defined;
+        stop.oldValue = before.value;
+        stop.newValue = it->second;
+        return true;
+    }
+    return false;
+}
+
+bool Debugger::advance(Interpreter &interpreter, DebugStop &stop) {
+    EvalState &state = interpreter.getState();
+    if (!watches.empty()) rememberWatched(state);
+
+    bool running = interpreter.step(program);
+    stop.line = running ? state.getNextLine() : -1;
+    if (!watches.empty() && watchTriggered(state, stop)) return true;
+    if (!running) {
+        stop.event = DebugEvent::Finished;
+        return true;
+    }
+    return false;
+}
+
+bool Debugger::breakpointAt(Interpreter &interpreter, DebugStop &stop) {
+    if (breakpoints.empty()) return false;
+    EvalState &state = interpreter.getState();
+    auto it = breakpoints.find(state.getNextLine());
+    if (it == breakpoints.end() || !conditionHolds(it->second, state)) return false;
+    stop.event = DebugEvent::Breakpoint;
+    stop.line = state.getNextLine();
+    return true;
+}
+
+std::set<int> Debugger::stopLines() const {
+    std::set<int> lines;
+    for (const auto &entry : breakpoints) lines.insert(entry.first);
+    if (watches.empty()) return lines;
+    for (int line = program.getFirstLineNumber(); line != -1; line = program.getNextLineNumber(line)) {
+        Statement *stmt = program.getParsedStatement(line);
+        if (stmt && (stmt->type() == StatementType::LET || stmt->type() == StatementType::INPUT)
+            && watches.count(stmt->getVariableName()))
+            lines.insert(line);
+    }
+    return lines;
+}
+
+bool Debugger::runTo(Interpreter &interpreter, const std::set<int> &lines, DebugStop &stop) {
+    interpreter.setStopLines(&lines);
+    try {
+        interpreter.resume(program);
+    } catch (...) {
+        interpreter.setStopLines(nullptr);
+        throw;
+    }
+    interpreter.setStopLines(nullptr);
+    if (interpreter.isSuspended()) return false;
+    stop.event = DebugEvent::Finished;
+    stop.line = -1;
+    return true;
+}
+
+DebugStop Debugger::stepInto(Interpreter &interpreter) {
+    DebugStop stop;
+    stop.event = DebugEvent::Step;
+    if (begin(interpreter)) {
+        stop.line = interpreter.getState().getNextLine();
+        return stop;
+    }
+    if (advance(interpreter, stop)) return stop;
+    stop.event = DebugEvent::Step;
+    return stop;
+}
+
+DebugStop Debugger::stepOver(Interpreter &interpreter) {
+    DebugStop stop;
+    begin(interpreter);
+    int line = interpreter.getState().getNextLine();
+    if (advance(interpreter, stop)) return stop;
+
+    // Jumped back: run the loop until control passes below the line
+    while (interpreter.getState().getNextLine() <= line) {
+        if (breakpointAt(interpreter, stop)) return stop;
+        if (advance(interpreter, stop)) return stop;
+    }
+    stop.event = DebugEvent::Step;
+    return stop;
+}
+
+DebugStop Debugger::continueRun(Interpreter &interpreter) {
+    DebugStop stop;
+
+    // Nothing can stop the run: full speed
+    if (!hasStops()) {
+        if (!interpreter.isSuspended()) interpreter.start(program);
+        interpreter.resume(program);
+        return stop;
+    }
+
+    // Step the stop lines, run everything between them at full speed
+    std::set<int> lines = stopLines();
+    if (begin(interpreter) && breakpointAt(interpreter, stop)) return stop;
+    while (true) {
+        if (advance(interpreter, stop)) return stop;
+        if (!lines.count(interpreter.getState().getNextLine()) && runTo(interpreter, lines, stop)) return stop;
+        if (breakpointAt(interpreter, stop)) return stop;
+    }
+}
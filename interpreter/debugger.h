@@ -0,0 +1,120 @@
+/**
+ * @file    debugger.h
+ * @brief   Breakpoints, watchpoints and stepping on top of Interpreter::step
+ *
+ *          A Debugger holds the stops of one program and drives paused runs
+ *          of it (see Interpreter::start and step), one Interpreter per run:
+ *
+ *            - line breakpoints stop before the line executes,
+ *            - conditional breakpoints only when their condition holds
+ *              ("X > 5", the same relation IF takes; a condition that
+ *              cannot be evaluated, e.g. with an undefined variable, does
+ *              not stop),
+ *            - watchpoints after a statement changed a variable (a first
+ *              assignment counts as a change).
+ *
+ *          continueRun hands the run to Interpreter::resume, so it runs
+ *          with loop acceleration and the JIT like an ordinary run. Only
+ *          breakpoint lines and the LET and INPUT lines assigning a watched
+ *          variable can stop it: resume pauses before each of those (see
+ *          Interpreter::setStopLines), which is then stepped with its checks.
+ *          Loops over such a line are walked statement by statement, and so
+ *          is the loop stepOver runs. Evaluating a condition does not touch
+ *          the run's counters.
+ *
+ * @author  simple_wind
+ * @version 1.0
+ * @date    2025-12-19
+ * */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+#include "../core/program.h"
+#include "interpreter.h"
+
+// Why the debugger returned control
+enum class DebugEvent {
+    Step,           // a step finished
+    Breakpoint,     // about to execute a breakpoint line
+    Watchpoint,     // a watched variable changed
+    Finished        // the run is over (END)
+};
+
+struct DebugStop {
+    DebugEvent event = DebugEvent::Finished;
+    int line = -1;              // line to execute next, -1 when finished
+    std::string variable;       // Watchpoint: the variable that changed
+    bool wasDefined = false;    // Watchpoint: value before the change
+    int oldValue = 0;
+    int newValue = 0;
+};
+
+class Debugger {
+public:
+    // Stops for runs of `program` (the program must outlive the debugger)
+    explicit Debugger(const Program &program);
+    ~Debugger();
+
+    Debugger(const Debugger &) = delete;
+    Debugger &operator=(const Debugger &) = delete;
+
+    // Stop before `line`; with a condition only when it holds. Setting a
+    // breakpoint again replaces its condition
+    // Throws std::runtime_error if the condition does not parse
+    void setBreakpoint(int line, const std::string &condition = "");
+    void clearBreakpoint(int line);
+    bool hasBreakpoint(int line) const { return breakpoints.count(line) > 0; }
+
+    // Stop after a statement changes `name`
+    void watch(const std::string &name);
+    void unwatch(const std::string &name);
+
+    // Remove every breakpoint and watchpoint
+    void clearAll();
+    bool hasStops() const { return !breakpoints.empty() || !watches.empty(); }
+
+    // Each call continues the paused run of `interpreter`, or starts one at
+    // the first line. Runtime errors end the run and are rethrown
+    //
+    // stepInto: execute one statement (a run just started stops before its
+    // first line instead)
+    // stepOver: execute the line; when it jumps back (a loop), keep going
+    // until control reaches a line after it. This BASIC has no GOSUB, so
+    // loops are what there is to step over
+    // continueRun: run to the next stop or to the end
+    DebugStop stepInto(Interpreter &interpreter);
+    DebugStop stepOver(Interpreter &interpreter);
+    DebugStop continueRun(Interpreter &interpreter);
+
+private:
+    struct Breakpoint {
+        std::unique_ptr<Statement> condition;   // IF statement, nullptr: always
+    };
+
+    struct WatchedValue {
+        bool defined = false;
+        int value = 0;
+    };
+
+    const Program &program;
+    std::unordered_map<int, Breakpoint> breakpoints;
+    std::map<std::string, WatchedValue> watches;    // value before the current step
+
+    bool begin(Interpreter &interpreter);
+    bool conditionHolds(const Breakpoint &bp, EvalState &state) const;
+    void rememberWatched(const EvalState &state);
+    bool watchTriggered(const EvalState &state, DebugStop &stop);
+    // One statement with watch checking; `stop` is set if the run must stop
+    bool advance(Interpreter &interpreter, DebugStop &stop);
+    bool breakpointAt(Interpreter &interpreter, DebugStop &stop);
+    // Lines that may stop continueRun
+    std::set<int> stopLines() const;
+    // Resume at full speed up to the next of `lines`; true if the run finished
+    bool runTo(Interpreter &interpreter, const std::set<int> &lines, DebugStop &stop);
+};
@@ -0,0 +1,58 @@
+#include "engine.h"
+#include "../runtime/programloader.h"
+#include <algorithm>
+#include <stdexcept>
+
+// ============ CompiledProgram Implementation ============
+
+CompiledProgram::CompiledProgram(const std::string &source) {
+    auto built = std::make_shared<Compiled>();
+    std::vector<std::string> errors = loadProgramText(source, built->program);
+    if (!errors.empty()) {
+        std::string message = "SYNTAX ERROR: " + errors.front();
+        for (size_t i = 1; i < errors.size(); ++i) message += "; " + errors[i];
+        throw std::runtime_error(message);
+    }
+    compiled = std::move(built);
+}
+
+// ============ Evaluation Implementation ============
+
+Evaluation::Evaluation(const CompiledProgram &program) : program(program) {
+    program.compiled->linked.prepare(frame);
+}
+
+int Evaluation::requireSlot(const std::string &name) const {
+    int s = program.slot(name);
+    if (s == -1) throw std::runtime_error("VARIABLE NOT USED BY PROGRAM: " + name);
+    return s;
+}
+
+void Evaluation::set(int slot, int value) {
+    frame.values[slot] = value;
+    frame.defined[slot] = 1;
+}
+
+void Evaluation::set(const std::string &name, int value) {
+    set(requireSlot(name), value);
+}
+
+int Evaluation::get(int slot) const {
+    if (!frame.defined[slot]) throw std::runtime_error("VARIABLE NOT DEFINED: " + program.variableName(slot));
+    return frame.values[slot];
+}
+
+int Evaluation::get(const std::string &name) const {
+    return get(requireSlot(name));
+}
+
+void Evaluation::reset() {
+    std::fill(frame.defined.begin(), frame.defined.end(), 0);
+}
+
+void Evaluation::run() {
+    // Variables of an earlier hand-back must not leak into this run
+    if (!state.getVariables().empty()) state.clear();
+    state.recoverEnd();
+    program.compiled->linked.run(frame, state);
+}
@@ -0,0 +1,101 @@
+/**
+ * @file    engine.h
+ * @brief   Embedding API: compile BASIC source once, evaluate it many times
+ *
+ *          For host programs that use BASIC snippets as rules:
+ *
+ *              CompiledProgram rule("10 LET Y = X * 2 + 1\n20 END\n");
+ *              Evaluation eval(rule);
+ *              int x = eval.slot("X"), y = eval.slot("Y");
+ *              eval.set(x, 20);
+ *              eval.run();
+ *              int result = eval.get(y);       // 41
+ *
+ *          A CompiledProgram is immutable and may be shared by any number of
+ *          Evaluations, also on different threads. An Evaluation holds the
+ *          variables of one caller by slot and runs the LinkedProgram form
+ *          (see linkedprogram.h), so after its first run an evaluation
+ *          allocates nothing unless the program reads INPUT or fails (the
+ *          LinkedProgram hands those lines back, with the same results and
+ *          error messages as Interpreter::run). Execution counters
+ *          (RuntimeStats) are not kept.
+ *
+ * @author  simple_wind
+ * @version 1.0
+ * @date    2025-12-16
+ * */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "../core/program.h"
+#include "../runtime/evalstate.h"
+#include "linkedprogram.h"
+
+class CompiledProgram {
+public:
+    // Parse and link "<line number> <statement>" lines
+    // Throws std::runtime_error listing every line that does not parse
+    explicit CompiledProgram(const std::string &source);
+
+    // Variable slots: count, slot of a name (-1 if the program does not use
+    // it) and name of a slot
+    int variableCount() const { return compiled->linked.variableSlots(); }
+    int slot(const std::string &name) const { return compiled->linked.variableSlot(name); }
+    const std::string &variableName(int slot) const { return compiled->linked.variableName(slot); }
+
+    // The parsed program (read-only)
+    const Program &program() const { return compiled->program; }
+
+private:
+    friend class Evaluation;
+
+    struct Compiled {
+        Program program;
+        LinkedProgram linked{program};
+    };
+    std::shared_ptr<const Compiled> compiled;
+};
+
+class Evaluation {
+public:
+    // Keeps the compiled program alive; every variable starts undefined
+    explicit Evaluation(const CompiledProgram &program);
+
+    int slot(const std::string &name) const { return program.slot(name); }
+
+    // Bind an input (or any) variable before run()
+    // By name: throws std::runtime_error if the program does not use it
+    void set(int slot, int value);
+    void set(const std::string &name, int value);
+
+    // Read a variable after run()
+    // Throws "VARIABLE NOT DEFINED: <name>" if it has no value
+    int get(int slot) const;
+    int get(const std::string &name) const;
+    bool isDefined(int slot) const { return frame.defined[slot] != 0; }
+
+    // Make every variable undefined again
+    void reset();
+
+    // Run from the first line. Variables keep the values they have (inputs
+    // set since the last run and results of earlier runs)
+    // Throws the runtime errors of Interpreter::run; variables assigned
+    // before the error keep their values
+    void run();
+
+    // I/O of the program (PRINT without a consumer writes to std::cout)
+    void setInputProvider(std::function<std::string()> f) { state.inputProvider = std::move(f); }
+    void setOutputConsumer(std::function<void(std::string_view)> f) { state.outputConsumer = std::move(f); }
+
+private:
+    CompiledProgram program;
+    LinkedFrame frame;
+    EvalState state;            // I/O and lines handed back to their statement
+
+    int requireSlot(const std::string &name) const;
+};
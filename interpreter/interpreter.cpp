@@ -1,9 +1,22 @@
 #include "interpreter.h"
+#include "cycledetector.h"
+#include "loopanalyzer.h"
+#include "jit.h"
+#include "linkedprogram.h"
+#include "livestate.h"
+#include "vm.h"
+#include "runlimits.h"
+#include "tracebuffer.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
 #include <iostream>
+#include <memory>
+#include <sstream>
 
 // Constructor: initialize interpreter with empty state
 Interpreter::Interpreter()
-    : state(), inputProvider(nullptr),
+    : state(), jitThreshold(JitEngine::HOT_THRESHOLD), inputProvider(nullptr),
     outputConsumer(nullptr) {
 }
 
@@ -19,19 +32,379 @@ EvalState &Interpreter::getState() {
 void Interpreter::reset() {
     // Create fresh EvalState by reassignment
     state = EvalState();
+    suspended = false;
+    pendingInput.clear();
 }
 
+namespace {
+
+// Thrown by the resumable input provider when no line has been supplied
+struct InputPending {};
+
+} // namespace
+
+RunStatus Interpreter::runUntilBlocked(const Program &program, long long slice) {
+    if (!suspended) start(program);
+
+    // INPUT reads supplied lines; running out suspends the run
+    std::function<std::string()> provider = state.inputProvider;
+    state.inputProvider = [this]() -> std::string {
+        if (pendingInput.empty()) throw InputPending();
+        std::string line = std::move(pendingInput.front());
+        pendingInput.pop_front();
+        return line;
+    };
+
+    RunStatus status = RunStatus::Finished;
+    long long &executed = sliceStatements;
+    executed = 0;
+    try {
+        int current = state.getNextLine();
+        while (current != -1 && !state.isEnded()) {
+            if (slice > 0 && executed == slice) {
+                status = RunStatus::Yielded;
+                break;
+            }
+
+            Statement *stmt = program.getParsedStatement(current);
+            if (!stmt) {
+                current = program.getNextLineNumber(current);
+                state.setNextLine(program.requireLine(current));
+                continue;
+            }
+
+            state.setCurrentLine(current);
+            state.setNextLine(current);
+            try {
+                stmt->execute(state, program);
+            } catch (const InputPending &) {
+                // Run the INPUT again on resume; it counts when it completes
+                state.lineCounters().execCount--;
+                status = RunStatus::NeedsInput;
+                break;
+            }
+            ++executed;
+
+            if (state.getNextLine() == current)
+                state.setNextLine(program.requireLine(program.getNextLineNumber(current)));
+            current = state.getNextLine();
+        }
+    } catch (...) {
+        state.inputProvider = provider;
+        suspended = false;
+        state.recoverEnd();
+        throw;
+    }
+    state.inputProvider = provider;
+
+    if (status == RunStatus::Finished) {
+        suspended = false;
+        state.recoverEnd();
+    }
+    return status;
+}
+
+namespace {
+
+// Fuel consumed so far: the sum of the execution counters
+long long countedStatements(const EvalState &state) {
+    long long total = 0;
+    for (const auto &entry : state.getRuntimeStats()->lineCounters) total += entry.second.execCount;
+    return total;
+}
+
+// Enforces the fuel and time limits in the statement loop. The only work per
+// statement is one countdown; the clock and the fuel are looked at when it
+// runs out, every DEADLINE_POLL statements or exactly at the statement that
+// would exceed the fuel
+class LimitMeter {
+public:
+    static const long long DEADLINE_POLL = 1024;
+
+    explicit LimitMeter(const RunLimits &limits)
+        : fuel(limits.fuel), timed(limits.seconds > 0),
+        deadline(std::chrono::steady_clock::now()
+                 + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                     std::chrono::duration<double>(limits.seconds))) {
+        rearm();
+    }
+
+    std::chrono::steady_clock::time_point getDeadline() const { return deadline; }
+
+    // Fuel consumed elsewhere (by the register machine)
+    void spend(long long statements) {
+        charged += window - countdown + statements;
+        rearm();
+    }
+
+    // Call before executing `stmt`
+    void charge(const Statement *stmt) {
+        if (--countdown == 0) check(stmt);
+    }
+
+private:
+    long long fuel;
+    bool timed;
+    std::chrono::steady_clock::time_point deadline;
+    long long charged = 0;      // statements charged before the current window
+    long long window = 0;       // statements between two checks
+    long long countdown = 0;    // statements left in the current window
+
+    void check(const Statement *stmt) {
+        charged += window;
+        if (timed && std::chrono::steady_clock::now() > deadline) throw TimeLimitError();
+        if (fuel > 0 && charged > fuel) {
+            if (stmt->type() != StatementType::END) throw FuelExhaustedError();
+            charged = fuel;     // END is free
+        }
+        rearm();
+    }
+
+    void rearm() {
+        window = timed ? DEADLINE_POLL : LLONG_MAX;
+        if (fuel > 0) window = std::min(window, fuel + 1 - charged);
+        countdown = window;
+    }
+};
+
+// Enforces the output limit for the lifetime of one run: the output consumer
+// is wrapped while the guard exists. Without a consumer of its own the run
+// writes to stdout
+class OutputGuard {
+public:
+    OutputGuard(EvalState &state, long long maxOutput) : state(state), original(state.outputConsumer) {
+        if (maxOutput <= 0) return;
+        active = true;
+        state.outputConsumer = [this, maxOutput](std::string_view text) {
+            if (written + (long long)text.size() > maxOutput) throw OutputLimitError();
+            written += (long long)text.size();
+            if (original) original(text);
+            else std::cout << text << std::flush;
+        };
+    }
+
+    ~OutputGuard() {
+        if (active) state.outputConsumer = original;
+    }
+
+private:
+    EvalState &state;
+    std::function<void(std::string_view)> original;
+    bool active = false;
+    long long written = 0;
+};
+
+// Tells the cycle detector about every INPUT line for the lifetime of one run
+class InputWatch {
+public:
+    InputWatch(EvalState &state, CycleDetector *detector) : state(state), original(state.inputProvider) {
+        if (!detector || !original) return;
+        active = true;
+        state.inputProvider = [this, detector]() {
+            detector->inputRead();
+            return original();
+        };
+    }
+
+    ~InputWatch() {
+        if (active) state.inputProvider = original;
+    }
+
+private:
+    EvalState &state;
+    std::function<std::string()> original;
+    bool active = false;
+};
+
+// Publishes a run to a LiveState for the lifetime of one run: before every
+// INPUT (the run may wait there for a while), on request at back edges, and
+// once more at the end
+class LivePublisher {
+public:
+    static const int POLL = 1024;       // back edges between publication checks
+
+    LivePublisher(EvalState &state, LiveState *live) : state(state), live(live), original(state.inputProvider) {
+        if (!live || !original) return;
+        wrapped = true;
+        state.inputProvider = [this]() {
+            publish(this->state.getCurrentLine());
+            return original();
+        };
+    }
+
+    ~LivePublisher() {
+        if (wrapped) state.inputProvider = original;
+        if (live) publish(state.getNextLine());
+    }
+
+    // A taken back edge to `next`
+    void backEdge(int next) {
+        if (!live || --countdown > 0) return;
+        countdown = POLL;
+        live->checkStop();
+        if (live->due()) publish(next);
+    }
+
+private:
+    EvalState &state;
+    LiveState *live;
+    std::function<std::string()> original;
+    bool wrapped = false;
+    int countdown = POLL;
+
+    void publish(int line) {
+        live->begin(line);
+        for (const auto &entry : state.getVariables()) live->variable(entry.first, entry.second);
+        if (RuntimeStats *rs = state.getRuntimeStats()) {
+            for (const auto &entry : rs->lineCounters) live->lineCount(entry.first, entry.second.execCount);
+        }
+        live->end();
+    }
+};
+
+} // namespace
+
 // Execute program to completion
-void Interpreter::run(Program &program) {
-    // Get first line number and set as next line to execute
-    int first = program.getFirstLineNumber();
-    program.setNextLine(first);
+void Interpreter::run(const Program &program) {
+    long long before = countedStatements(state);
+    OutputGuard output(state, limits.maxOutput);
+    try {
+        runMetered(program, program.requireLine(program.getFirstLineNumber()));
+    } catch (...) {
+        fuelUsed = countedStatements(state) - before;
+        throw;
+    }
+    fuelUsed = countedStatements(state) - before;
+}
+
+void Interpreter::resume(const Program &program) {
+    suspended = false;
+    if (state.getNextLine() == -1 && !state.isEnded()) return;
+
+    // Queued lines first, then the caller's provider
+    std::function<std::string()> provider = state.inputProvider;
+    if (!pendingInput.empty()) {
+        state.inputProvider = [this, provider]() -> std::string {
+            if (pendingInput.empty()) {
+                if (!provider) throw std::runtime_error("Input provider not set");
+                return provider();
+            }
+            std::string line = std::move(pendingInput.front());
+            pendingInput.pop_front();
+            return line;
+        };
+    }
+
+    long long before = countedStatements(state);
+    OutputGuard output(state, limits.maxOutput);
+    try {
+        runMetered(program, state.getNextLine());
+    } catch (...) {
+        state.inputProvider = provider;
+        fuelUsed = countedStatements(state) - before;
+        throw;
+    }
+    state.inputProvider = provider;
+    fuelUsed = countedStatements(state) - before;
+}
+
+ExecutionSnapshot Interpreter::snapshot(const Program &program) const {
+    ExecutionSnapshot s;
+    s.programHash = programFingerprint(program);
+    s.nextLine = state.getNextLine();
+    s.currentLine = state.getCurrentLine();
+    s.ended = state.isEnded();
+    s.suspended = suspended;
+    s.variables = state.getVariables();
+    s.stats = *state.getRuntimeStats();
+    s.pendingInput.assign(pendingInput.begin(), pendingInput.end());
+    return s;
+}
+
+void Interpreter::restore(const ExecutionSnapshot &s, const Program &program) {
+    if (s.programHash != programFingerprint(program))
+        throw std::runtime_error("SNAPSHOT OF A DIFFERENT PROGRAM");
+
+    state.clear();
+    for (const auto &entry : s.variables) state.setValue(entry.first, entry.second);
+    *state.getRuntimeStats() = s.stats;
+    state.recoverEnd();
+    if (s.ended) state.setEnd();
+    state.setNextLine(s.nextLine);
+    state.setCurrentLine(s.currentLine);
+    suspended = s.suspended;
+    pendingInput.assign(s.pendingInput.begin(), s.pendingInput.end());
+}
+
+void Interpreter::run(const LinkedProgram &linked) {
+    long long before = countedStatements(state);
+    try {
+        linked.run(state);
+    } catch (...) {
+        fuelUsed = countedStatements(state) - before;
+        throw;
+    }
+    state.recoverEnd();
+    fuelUsed = countedStatements(state) - before;
+}
+
+// Run from `start` (the first line, or where a paused run stopped)
+void Interpreter::runMetered(const Program &program, int start) {
+    state.setNextLine(start);
+
+    bool metered = limits.fuel > 0 || limits.seconds > 0;
+    LimitMeter meter(limits);
+
+    std::unique_ptr<CycleDetector> detector;
+    if (cycleDetection) detector.reset(new CycleDetector());
+    InputWatch inputs(state, detector.get());
+    LivePublisher publisher(state, live);
+
+    // Register machine runs the whole program itself (traced runs too: it
+    // records each line it executes)
+    bool vmStopped = false;   // the VM ran out of fuel within a block
+    if ((vmEnabled || trace) && !stopLines && start == program.getFirstLineNumber()) {
+        RegisterVM vm(program, vmEnabled ? branchProfile : nullptr, trace);
+        if (limits.seconds > 0) vm.setDeadline(meter.getDeadline());
+        vm.setFuel(limits.fuel);
+        vm.setCycleDetector(detector.get());
+        vm.setLiveState(live);
+        try {
+            vm.run(state, program);
+            state.recoverEnd();
+            return;
+        } catch (const FuelExhaustedError &) {
+            // Finish the fuel left below the block that did not fit
+            meter.spend(vm.fuelUsed());
+            vmStopped = true;
+        }
+    }
+
+    // Recognize loops that can skip per-iteration execution
+    std::unique_ptr<LoopAnalyzer> loops;
+    if (loopAcceleration && limits.fuel <= 0 && !vmStopped && !trace) loops.reset(new LoopAnalyzer(program));
+    if (loops && stopLines) loops->excludeLines(*stopLines);
+
+    // Compile hot loop regions to native code
+    std::unique_ptr<JitEngine> jit;
+    if (jitEnabled && !limits.any() && !detector && !trace && !live && JitEngine::isSupported()
+        && !JitEngine::killSwitchActive())
+        jit.reset(new JitEngine(program, jitThreshold));
+    if (jit && stopLines) jit->excludeLines(*stopLines);
+    bool interpretNext = false;   // statement after a native exit runs in the interpreter
 
     // Get current line
-    int current = program.getNextLine();
+    int current = state.getNextLine();
 
     // Execute until program ends or END statement
-    while (current != -1 && !program.isEnded()) {
+    while (current != -1 && !state.isEnded()) {
+        // Paused before a stop line
+        if (stopLines && stopLines->count(current)) {
+            state.setNextLine(current);
+            suspended = true;
+            break;
+        }
+
         Statement* stmt = program.getParsedStatement(current);
 
         /*    std::cout << "[DEBUG] current line: " << current
@@ -42,85 +415,128 @@ void Interpreter::run(Program &program) {
 
         if (!stmt) {
             current = program.getNextLineNumber(current);
-            program.setNextLine(current);
+            state.setNextLine(program.requireLine(current));
             continue;
         }
 
 
+        if (metered) meter.charge(stmt);
+
+        // Whole loop executed at once: continue where it left off
+        if (loops && loops->tryAccelerate(current, state)) {
+            // Still looping after a whole batch: sample like a back edge
+            int next = state.getNextLine();
+            if (detector && next == current && detector->sample(next, state))
+                throw CycleDetector::error(program, next, state);
+            if (next == current) publisher.backEdge(next);
+            current = next;
+            continue;
+        }
+
+        if (jit && !interpretNext && jit->tryEnter(current, state)) {
+            interpretNext = true;
+            current = state.getNextLine();
+            continue;
+        }
+        interpretNext = false;
+
         int oldNext = current;
 
         // 执行语句
+        state.setCurrentLine(current);
+        state.setNextLine(current);
+        if (trace) trace->step(current);
         stmt->execute(state, program);
+        if (trace) traceWrite(stmt);
 
-        //std::cout<<"next"<<program.getNextLine()<<std::endl;
+        //std::cout<<"next"<<state.getNextLine()<<std::endl;
 
         // 执行后如果 nextLine 没变（说明语句没有跳转）
-        if (program.getNextLine() == oldNext) {
+        if (state.getNextLine() == oldNext) {
             int defaultNext = program.getNextLineNumber(current);
 
             // 如果已经没有下一行 → 程序结束（设置 -1）
-            program.setNextLine(defaultNext);
+            state.setNextLine(program.requireLine(defaultNext));
+        }
+
+        // Taken back edge: candidate for native compilation, cycle sample
+        int next = state.getNextLine();
+        if (next != -1 && next <= current) {
+            if (jit) jit->noteBackEdge(current, next);
+            if (detector && detector->backEdge() && detector->sample(next, state))
+                throw CycleDetector::error(program, next, state);
+            publisher.backEdge(next);
         }
 
-        current = program.getNextLine();
+        current = next;
     }
-    //TODO: after a round of running, reset the program to 'unend'
-    program.recoverEnd();
+    //TODO: after a round of running, reset the state to 'unend'
+    state.recoverEnd();
 }
 
 
-bool Interpreter::step(Program &program) {
-    //std::cout<<"0101010101" ;
-
-    if (program.isEnded()) {
-        std::cout<<"ended"<<std::endl;
-        return false;}
+// Record the variable a statement just assigned
+void Interpreter::traceWrite(const Statement *stmt) {
+    StatementType type = stmt->type();
+    if (type != StatementType::LET && type != StatementType::INPUT) return;
+    const std::string name = stmt->getVariableName();
+    trace->write(name, state.getValue(name));
+}
 
-    int current = program.getNextLine();
-    std::cout<<current<<std::endl;
+void Interpreter::start(const Program &program) {
+    state.recoverEnd();
+    state.setNextLine(program.requireLine(program.getFirstLineNumber()));
+    suspended = true;
+}
 
-    if (current == -1) return false;
+bool Interpreter::step(const Program &program) {
+    if (!suspended) start(program);
 
-    Statement *stmt = program.getParsedStatement(current);
+    try {
+        int current = state.getNextLine();
+        Statement *stmt = program.getParsedStatement(current);
+        while (!stmt) {
+            current = program.requireLine(program.getNextLineNumber(current));
+            stmt = program.getParsedStatement(current);
+        }
 
-    std::cout<<stmt->toString();
+        state.setCurrentLine(current);
+        state.setNextLine(current);
+        stmt->execute(state, program);
 
-    if (!stmt) {
-        int next = program.getNextLineNumber(current);
-        program.setNextLine(next);
-        return true; // we advanced (no-op statement)
+        if (!state.isEnded()) {
+            if (state.getNextLine() == current)
+                state.setNextLine(program.requireLine(program.getNextLineNumber(current)));
+            return true;
+        }
+    } catch (...) {
+        suspended = false;
+        state.recoverEnd();
+        throw;
     }
 
-    // ensure default advancement if statement doesn't change it
-    defaultAdvanceIfNeeded(program, current);
-
-    stmt->execute(state, program);
-    return true;
-}
-
-void Interpreter::defaultAdvanceIfNeeded(Program &program, int currentLine) {
-    // If nextLine isn't already set to something meaningful, set it to next sequential line.
-    // We can't directly query an internal "next line" other than getNextLine(),
-    // so we set default to Program::getNextLineNumber(currentLine).
-    int defaultNext = program.getNextLineNumber(currentLine);
-    program.setNextLine(defaultNext);
+    suspended = false;
+    state.recoverEnd();
+    return false;
 }
 
 
-std::string Interpreter::toSyntaxTree(Program& program) const{
-    std::string result;
-
+void Interpreter::writeSyntaxTree(std::ostream &out, const Program& program) const{
     int line = program.getFirstLineNumber();
     while(line != -1) {
         Statement* stmt = program.getParsedStatement(line);
         if(stmt) {
-            // 每条语句调用其 toSyntaxTree 并传入缩进级别 0
-            result += std::to_string(line) + " ";
-            result += stmt->toSyntaxTree(state.getRuntimeStats(),0);
-            result += "\n";
+            // 每条语句调用其 writeSyntaxTree 并传入缩进级别 0
+            out << line << " ";
+            stmt->writeSyntaxTree(out, state.getRuntimeStats(), line, 0);
+            out << "\n";
         }
         line = program.getNextLineNumber(line);
     }
+}
 
-    return result;
+std::string Interpreter::toSyntaxTree(const Program& program) const{
+    std::ostringstream out;
+    writeSyntaxTree(out, program);
+    return out.str();
 }
@@ -1,13 +1,22 @@
 #pragma once
 
+#include <deque>
 #include <functional>
-#include <QString>
+#include <ostream>
+#include <set>
 
 #include "../core/statement.h"
 #include "../core/program.h"
 #include "../runtime/evalstate.h"
+#include "runlimits.h"
+#include "snapshot.h"
 //#include "../runtime/parser.h"
 
+struct BranchProfile;
+class LinkedProgram;
+class LiveState;
+class TraceBuffer;
+
 /**
  * Interpreter class
  * 
@@ -20,7 +29,18 @@
  * 
  * Note: For proper decoupling from Statement/Program, statements access I/O callbacks
  * through EvalState or global registry. Callbacks injected via setters.
+ *
+ * The Program is only read: program counter, variables and counters of a run
+ * live in this interpreter's EvalState, so several interpreters (e.g. one per
+ * thread) can run the same Program at the same time.
  */
+// Why runUntilBlocked() returned
+enum class RunStatus {
+    Finished,       // END or the run completed
+    NeedsInput,     // an INPUT is waiting for supplyInput()
+    Yielded         // the statement slice was used up
+};
+
 class Interpreter {
 public:
     // Constructor and destructor
@@ -30,24 +50,142 @@ public:
     // Execution modes
     
     // Run program until completion or END statement
-    void run(Program& program);
+    void run(const Program& program);
+
+    // Run the linked form of a program (see LinkedProgram); results and
+    // counters are the same as run(program). Run limits and cycle detection
+    // do not apply
+    void run(const LinkedProgram &linked);
 
-    // Execute exactly one statement
-    // Returns: true if statement was executed, false if program ended or no statement
-    bool step(Program &program);
+    // Execute exactly one statement of a paused run, starting one at the
+    // first line if none is paused (lines without a statement are passed
+    // over). INPUT reads from the input provider. An error ends the run and
+    // is rethrown
+    // Returns: false once the run is over (END executed), true otherwise
+    bool step(const Program &program);
+
+    // Begin a paused run at the first line without executing anything
+    // (step() and runUntilBlocked() start one themselves)
+    void start(const Program &program);
 
     // Reset interpreter state: clears all variables and resets execution
     void reset();
 
+    // Checkpoints
+    //
+    // Capture a paused run: between step() calls, after runUntilBlocked()
+    // returned NeedsInput or Yielded, or after run()/resume() stopped with
+    // FuelExhaustedError or TimeLimitError (the statement that did not fit is
+    // the next one). `program` is the program being run
+    ExecutionSnapshot snapshot(const Program &program) const;
+
+    // Replace this interpreter's state with a snapshot of `program`; the run
+    // continues with step(), runUntilBlocked() or resume() where it was taken.
+    // Restoring one snapshot into several interpreters forks the run
+    // Throws std::runtime_error if the snapshot was taken of another program
+    void restore(const ExecutionSnapshot &snapshot, const Program &program);
+
+    // Continue a paused or restored run to completion like run(): limits,
+    // loop acceleration, JIT and cycle detection apply (the register machine
+    // only starts runs from the first line). Lines queued with supplyInput
+    // are read first, then the input provider. Does nothing if no run is
+    // paused
+    void resume(const Program &program);
+
+    // Resumable execution
+    //
+    // Runs without ever blocking on INPUT: when an INPUT finds no supplied
+    // line it returns NeedsInput, and the next call continues at that INPUT
+    // (which then counts once). The first call starts from the first line,
+    // later calls resume until Finished or an error is thrown; pass the same
+    // Program every time. Statements are walked one by one (no loop
+    // acceleration, JIT or VM) so one thread can interleave many sessions.
+    // slice: return Yielded after this many statements (0 = no slice)
+    RunStatus runUntilBlocked(const Program &program, long long slice = 0);
+
+    // Queue one line for INPUT (invalid numbers are reported and skipped the
+    // same way InputStmt does)
+    void supplyInput(const std::string &line) { pendingInput.push_back(line); }
+
+    // A resumable run has started and not finished yet
+    bool isSuspended() const { return suspended; }
+
+    // Statements executed by the last runUntilBlocked() call
+    long long lastSliceStatements() const { return sliceStatements; }
+
+    // Enable or disable closed-form/batch execution of simple counting loops
+    // (enabled by default, see LoopAnalyzer)
+    void setLoopAcceleration(bool enabled) { loopAcceleration = enabled; }
+
+    // Enable or disable native compilation of hot loops (see JitEngine)
+    // The QBASIC_NO_JIT environment variable overrides this switch
+    void setJitEnabled(bool enabled) { jitEnabled = enabled; }
+
+    // Number of taken back edges before a loop region is compiled
+    void setJitThreshold(int backEdges) { jitThreshold = backEdges; }
+
+    // Run whole programs on the register machine instead of walking the
+    // statement trees (see RegisterVM; loop acceleration and JIT are not used)
+    void setVmEnabled(bool enabled) { vmEnabled = enabled; }
+
+    // Compile the register machine with the profile of training runs (not
+    // owned; nullptr = line order). Runs of another program throw
+    // "PROFILE OF A DIFFERENT PROGRAM" (see BranchProfile)
+    void setBranchProfile(const BranchProfile *profile) { branchProfile = profile; }
+
+    // Limits for each run() (see RunLimits). Exceeding one stops the run with
+    // TimeLimitError, FuelExhaustedError or OutputLimitError (all derived from
+    // ResourceLimitError); variables and counters keep the values they had
+    // when it stopped. Native JIT code cannot be interrupted, so the JIT is
+    // not used while a limit is set, and loops are not accelerated while fuel
+    // is limited (every statement has to be metered)
+    void setRunLimits(const RunLimits &runLimits) { limits = runLimits; }
+    const RunLimits &getRunLimits() const { return limits; }
+
+    // Stop run() with TimeLimitError after `seconds` of wall-clock time
+    // (0 = no limit); shorthand for the seconds field of the run limits
+    void setTimeLimit(double seconds) { limits.seconds = seconds; }
+
+    // Stop run() with InfiniteLoopError when a run without INPUT comes back
+    // to the same line with the same variables (see CycleDetector). The JIT
+    // is not used while detection is on
+    void setCycleDetection(bool enabled) { cycleDetection = enabled; }
+
+    // Record every statement executed by run() and the variable it assigned
+    // into `buffer` (not owned; nullptr turns tracing off). Traced runs use
+    // the register machine, which records from compiled code, also when it
+    // is not enabled; loop acceleration and JIT, which skip statements, are
+    // not used. Resumed runs and runs with stop lines walk the statements
+    void setTrace(TraceBuffer *buffer) { trace = buffer; }
+
+    // Pause run() and resume() before any of these lines executes (not
+    // owned; nullptr = run to the end): the run stays suspended with that
+    // line next, as between step() calls. Loops and JIT regions over such a
+    // line are walked statement by statement; the register machine is not
+    // used (see Debugger::continueRun)
+    void setStopLines(const std::set<int> *lines) { stopLines = lines; }
+
+    // Publish the line, variables and line counts of run() and resume() to `liveState`
+    // (not owned; nullptr turns it off) so another thread can watch them
+    // (see LiveState). Publication points are checked every few thousand
+    // back edges or register machine blocks, before each INPUT and at the
+    // end of the run. The JIT is not used, as native loops cannot publish.
+    // A stop request ends the run with RunStoppedError
+    void setLiveState(LiveState *liveState) { live = liveState; }
+
+    // Fuel (counted statements) consumed by the last run(), also when it
+    // stopped with an error or ran without limits
+    long long lastFuelUsed() const { return fuelUsed; }
+
     // I/O callback configuration
     
     // Set input provider callback (called by INPUT statements)
-    void setInputProvider(std::function<QString()> f) {
+    void setInputProvider(std::function<std::string()> f) {
         state.inputProvider = std::move(f);
     }
     
     // Set output consumer callback (called by PRINT statements)
-    void setOutputConsumer(std::function<void(const QString&)> f) {
+    void setOutputConsumer(std::function<void(std::string_view)> f) {
         state.outputConsumer = std::move(f);
     }
 
@@ -60,16 +198,33 @@ public:
     
     // Get syntax tree representation (use after running program)
     // Shows execution counts and structure
-    std::string toSyntaxTree(Program &program) const;
+    std::string toSyntaxTree(const Program &program) const;
+
+    // Same text written straight to a stream, one statement at a time
+    void writeSyntaxTree(std::ostream &out, const Program &program) const;
 
 private:
     EvalState state;                                // Variable bindings and runtime state
+    bool loopAcceleration = true;                   // Use LoopAnalyzer during run()
+    bool jitEnabled = true;                         // Use JitEngine during run()
+    int jitThreshold;                               // Back edges before compiling a region
+    bool vmEnabled = false;                         // Execute with RegisterVM during run()
+    const BranchProfile *branchProfile = nullptr;   // Layout of the RegisterVM code
+    RunLimits limits;                               // Limits of each run()
+    long long fuelUsed = 0;                         // Fuel consumed by the last run()
+    bool cycleDetection = false;                    // Use CycleDetector during run()
+    bool suspended = false;                         // runUntilBlocked() is mid-program
+    long long sliceStatements = 0;                  // executed by the last runUntilBlocked()
+    std::deque<std::string> pendingInput;           // lines for INPUT in resumable runs
+    TraceBuffer *trace = nullptr;                   // Records run() steps when set
+    LiveState *live = nullptr;                      // Receives run() publications when set
+    const std::set<int> *stopLines = nullptr;       // run() pauses before these lines
     
     // I/O callbacks (may be nullptr if not configured)
     std::function<int()> inputProvider;             // Provides input for INPUT statement
-    std::function<void(const QString&)> outputConsumer;  // Consumes output from PRINT statement
+    std::function<void(std::string_view)> outputConsumer;  // Consumes output from PRINT statement
 
-    // Internal helper method
-    // Advance to next line if needed (used after conditional branches)
-    void defaultAdvanceIfNeeded(Program &program, int currentLine);
+    // Internal helper methods
+    void runMetered(const Program &program, int start);
+    void traceWrite(const Statement *stmt);
 };
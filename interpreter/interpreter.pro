@@ -1,5 +1,6 @@
 TEMPLATE = lib
-CONFIG += staticlib
+CONFIG += staticlib c++17
+CONFIG -= qt
 
 TARGET = interpreter
 
@@ -12,8 +13,48 @@ LIBS += \
     -L$$PWD/../build/Desktop_Qt_6_8_3_MSVC2022_64bit-Debug/runtime/debug -lruntime\
 
 SOURCES += \
-    interpreter.cpp
+    aotcompiler.cpp \
+    batchrunner.cpp \
+    branchprofile.cpp \
+    cycledetector.cpp \
+    debugger.cpp \
+    engine.cpp \
+    interpreter.cpp \
+    jit.cpp \
+    linkedprogram.cpp \
+    livestate.cpp \
+    loopanalyzer.cpp \
+    replsession.cpp \
+    sessionrecording.cpp \
+    snapshot.cpp \
+    spmd.cpp \
+    threadpool.cpp \
+    tracebuffer.cpp \
+    vm.cpp
 
 HEADERS += \
-    interpreter.h
+    aotcompiler.h \
+    batchrunner.h \
+    branchprofile.h \
+    cycledetector.h \
+    debugger.h \
+    engine.h \
+    interpreter.h \
+    jit.h \
+    linkedprogram.h \
+    livestate.h \
+    loopanalyzer.h \
+    replsession.h \
+    runlimits.h \
+    sessionrecording.h \
+    snapshot.h \
+    spmd.h \
+    spmdexec.h \
+    threadpool.h \
+    tracebuffer.h \
+    vm.h
 
+# SpmdEngine lane kernels: built with AVX2 code generation, used only when
+# the CPU reports AVX2 at run time
+CONFIG += simd
+AVX2_SOURCES += spmd_avx2.cpp
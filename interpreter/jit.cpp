@@ -0,0 +1,677 @@
+#include "jit.h"
+#include "interpreter.h"
+#include "../core/statement.h"
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define QBASIC_JIT_X64 1
+#endif
+
+namespace {
+
+// Native entry point: vars = variable array, counters = two 64-bit counters
+// per region line (executions, taken branches), entry = index of first line
+// Returns the line to continue at, or JIT_END after an END statement
+typedef int (*JitFunction)(int32_t *vars, uint64_t *counters, int32_t entry);
+
+const int JIT_END = INT_MIN;
+
+// ============ Executable memory ============
+
+class ExecutableMemory {
+public:
+    ExecutableMemory(const std::vector<uint8_t> &code) {
+        size = code.size();
+#if defined(_WIN32)
+        mem = VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+        if (!mem) return;
+        std::memcpy(mem, code.data(), size);
+        DWORD old;
+        if (!VirtualProtect(mem, size, PAGE_EXECUTE_READ, &old)) release();
+#else
+        mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) {
+            mem = nullptr;
+            return;
+        }
+        std::memcpy(mem, code.data(), size);
+        if (mprotect(mem, size, PROT_READ | PROT_EXEC) != 0) release();
+#endif
+    }
+
+    ~ExecutableMemory() { release(); }
+
+    JitFunction function() const { return reinterpret_cast<JitFunction>(mem); }
+    bool valid() const { return mem != nullptr; }
+
+private:
+    void *mem = nullptr;
+    size_t size = 0;
+
+    void release() {
+        if (!mem) return;
+#if defined(_WIN32)
+        VirtualFree(mem, 0, MEM_RELEASE);
+#else
+        munmap(mem, size);
+#endif
+        mem = nullptr;
+    }
+};
+
+// ============ x86-64 assembler ============
+// Only the handful of encodings the code generator needs; all arithmetic is
+// 32-bit so it wraps exactly like the interpreter's int operations
+
+enum Reg { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+
+enum Cond { CC_E = 0x4, CC_NE = 0x5, CC_S = 0x8, CC_NS = 0x9, CC_L = 0xC, CC_G = 0xF };
+
+enum AluOp { ALU_ADD = 0x01, ALU_SUB = 0x29, ALU_XOR = 0x31, ALU_CMP = 0x39, ALU_TEST = 0x85 };
+
+class Assembler {
+public:
+    std::vector<uint8_t> code;
+
+    int newLabel() {
+        labels.push_back(-1);
+        return (int)labels.size() - 1;
+    }
+
+    void bind(int label) { labels[label] = (int)code.size(); }
+
+    void jmp(int label) {
+        byte(0xE9);
+        fixup(label);
+    }
+
+    void jcc(Cond cc, int label) {
+        byte(0x0F);
+        byte(0x80 | cc);
+        fixup(label);
+    }
+
+    // 32-bit register operations
+    void movRR(int dst, int src)          { rex(false, src, dst); byte(0x89); modrmReg(src, dst); }
+    void alu(AluOp op, int dst, int src)  { rex(false, src, dst); byte(op); modrmReg(src, dst); }
+    void imul(int dst, int src)           { rex(false, dst, src); byte(0x0F); byte(0xAF); modrmReg(dst, src); }
+    void movRI(int dst, int32_t imm)      { rex(false, 0, dst); byte(0xB8 + (dst & 7)); dword(imm); }
+    void cmpRI(int r, int32_t imm)        { rex(false, 0, r); byte(0x81); modrmReg(7, r); dword(imm); }
+    void idiv(int r)                      { rex(false, 0, r); byte(0xF7); modrmReg(7, r); }
+    void cdq()                            { byte(0x99); }
+
+    // Memory operands [base + disp32]
+    void load(int dst, int base, int32_t disp)  { rex(false, dst, base); byte(0x8B); modrmMem(dst, base, disp); }
+    void store(int base, int32_t disp, int src) { rex(false, src, base); byte(0x89); modrmMem(src, base, disp); }
+    void incMem64(int base, int32_t disp)       { rex(true, 0, base); byte(0x83); modrmMem(0, base, disp); byte(1); }
+
+    // 64-bit register operations
+    void mov64(int dst, int src) { rex(true, src, dst); byte(0x89); modrmReg(src, dst); }
+    void push(int r)             { if (r & 8) byte(0x41); byte(0x50 + (r & 7)); }
+    void pop(int r)              { if (r & 8) byte(0x41); byte(0x58 + (r & 7)); }
+    void addRsp(int32_t imm)     { rex(true, 0, RSP); byte(0x81); modrmReg(0, RSP); dword(imm); }
+    void ret()                   { byte(0xC3); }
+
+    // Resolve label references; returns false if a label was never bound
+    bool finalize() {
+        for (const auto &f : fixups) {
+            int target = labels[f.second];
+            if (target < 0) return false;
+            int32_t rel = target - (f.first + 4);
+            std::memcpy(&code[f.first], &rel, 4);
+        }
+        return true;
+    }
+
+private:
+    std::vector<int> labels;                     // label -> code offset
+    std::vector<std::pair<int, int>> fixups;     // (rel32 offset, label)
+
+    void byte(uint8_t b) { code.push_back(b); }
+
+    void dword(int32_t v) {
+        for (int i = 0; i < 4; ++i) byte((uint8_t)((uint32_t)v >> (8 * i)));
+    }
+
+    void fixup(int label) {
+        fixups.push_back({(int)code.size(), label});
+        dword(0);
+    }
+
+    void rex(bool w, int reg, int rm) {
+        uint8_t r = 0x40 | (w ? 8 : 0) | ((reg & 8) ? 4 : 0) | ((rm & 8) ? 1 : 0);
+        if (r != 0x40) byte(r);
+    }
+
+    void modrmReg(int reg, int rm) { byte(0xC0 | ((reg & 7) << 3) | (rm & 7)); }
+
+    void modrmMem(int reg, int base, int32_t disp) {
+        byte(0x80 | ((reg & 7) << 3) | (base & 7));
+        if ((base & 7) == RSP) byte(0x24);   // SIB needed for rsp/r12 bases
+        dword(disp);
+    }
+};
+
+// Registers holding variables; everything else lives in the array at r11
+const int VAR_REGS[] = { RBX, RBP, RSI, RDI, R8, R9, R12, R13, R14, R15 };
+const int NUM_VAR_REGS = sizeof(VAR_REGS) / sizeof(VAR_REGS[0]);
+
+// Registers pushed by the prologue (callee-saved on System V and Windows)
+const int SAVED_REGS[] = { RBX, RBP, RSI, RDI, R12, R13, R14, R15 };
+
+const int VARS_BASE = R11;      // int32_t *vars
+const int COUNTERS_BASE = R10;  // uint64_t *counters
+
+bool supportedOperator(const std::string &op) {
+    return op == "+" || op == "-" || op == "*" || op == "/" || op == "MOD";
+}
+
+bool compilableExp(Expression *exp) {
+    if (exp->type() != COMPOUND) return true;
+    return supportedOperator(exp->getOperator())
+           && compilableExp(exp->getLHS()) && compilableExp(exp->getRHS());
+}
+
+bool compilable(Statement *stmt) {
+    switch (stmt->type()) {
+    case StatementType::REM:
+    case StatementType::GOTO:
+    case StatementType::END:
+        return true;
+    case StatementType::LET:
+        return compilableExp(stmt->getExpression());
+    case StatementType::IF:
+        return compilableExp(stmt->getLHS()) && compilableExp(stmt->getRHS());
+    default:
+        return false;   // PRINT and INPUT always go through the interpreter
+    }
+}
+
+void collectVars(Expression *exp, std::map<std::string, int> &slots, std::vector<std::string> &names) {
+    if (exp->type() == IDENTIFIER) {
+        std::string name = exp->getIdentifierName();
+        if (!slots.count(name)) {
+            slots[name] = (int)names.size();
+            names.push_back(name);
+        }
+    } else if (exp->type() == COMPOUND) {
+        collectVars(exp->getLHS(), slots, names);
+        collectVars(exp->getRHS(), slots, names);
+    }
+}
+
+void countUses(Expression *exp, std::map<std::string, int> &uses) {
+    if (exp->type() == IDENTIFIER) uses[exp->getIdentifierName()]++;
+    else if (exp->type() == COMPOUND) {
+        countUses(exp->getLHS(), uses);
+        countUses(exp->getRHS(), uses);
+    }
+}
+
+} // namespace
+
+// ============ Compiled region ============
+
+struct JitRegion {
+    struct Line {
+        int number;                                  // BASIC line number
+        Statement *stmt;                             // nullptr for unparsed lines
+        bool native;                                 // compiled (entry point) or exit to interpreter
+        std::vector<std::pair<std::string, int>> uses;  // identifier evaluations per execution
+    };
+
+    std::vector<Line> lines;
+    std::vector<std::string> names;                  // slot -> variable name
+    std::unique_ptr<ExecutableMemory> memory;
+    std::vector<int32_t> vars;                       // reused between entries
+    std::vector<uint64_t> counters;
+};
+
+namespace {
+
+// Code generator for one region
+class RegionCompiler {
+public:
+    RegionCompiler(JitRegion &region, const std::map<std::string, int> &slots, int fallthrough)
+        : region(region), slots(slots), fallthrough(fallthrough) {}
+
+    bool compile() {
+        int n = (int)region.lines.size();
+        for (int i = 0; i < n; ++i) lineLabels.push_back(as.newLabel());
+        exitLabel = as.newLabel();
+
+        prologue();
+
+        // Entry dispatch: eax holds the entry index
+        for (int i = 0; i < n; ++i) {
+            if (!region.lines[i].native) continue;
+            as.cmpRI(RAX, i);
+            as.jcc(CC_E, lineLabels[i]);
+        }
+        exitTo(fallthrough);
+
+        for (int i = 0; i < n; ++i) {
+            as.bind(lineLabels[i]);
+            statement(i);
+        }
+        exitTo(fallthrough);
+
+        // Out-of-line bailouts: drop temporaries and hand the line back
+        for (const Bailout &b : bailouts) {
+            as.bind(b.label);
+            if (b.depth > 0) as.addRsp(8 * b.depth);
+            exitTo(region.lines[b.line].number);
+        }
+
+        epilogue();
+        return as.finalize();
+    }
+
+    std::vector<uint8_t> &code() { return as.code; }
+
+private:
+    struct Bailout {
+        int label;
+        int depth;      // temporaries pushed at the bailout point
+        int line;       // region line index
+    };
+
+    JitRegion &region;
+    const std::map<std::string, int> &slots;
+    int fallthrough;                // line after the region (may be -1)
+    Assembler as;
+    std::vector<int> lineLabels;
+    int exitLabel = -1;
+    std::vector<Bailout> bailouts;
+    int depth = 0;
+    int currentLine = 0;
+
+    void prologue() {
+        for (int r : SAVED_REGS) as.push(r);
+#if defined(_WIN32)
+        as.mov64(VARS_BASE, RCX);
+        as.mov64(COUNTERS_BASE, RDX);
+        as.movRR(RAX, R8);
+#else
+        as.mov64(VARS_BASE, RDI);
+        as.mov64(COUNTERS_BASE, RSI);
+        as.movRR(RAX, RDX);
+#endif
+        for (int i = 0; i < (int)region.names.size() && i < NUM_VAR_REGS; ++i)
+            as.load(VAR_REGS[i], VARS_BASE, 4 * i);
+    }
+
+    void epilogue() {
+        as.bind(exitLabel);
+        for (int i = 0; i < (int)region.names.size() && i < NUM_VAR_REGS; ++i)
+            as.store(VARS_BASE, 4 * i, VAR_REGS[i]);
+        for (int i = (int)(sizeof(SAVED_REGS) / sizeof(SAVED_REGS[0])) - 1; i >= 0; --i)
+            as.pop(SAVED_REGS[i]);
+        as.ret();
+    }
+
+    void exitTo(int line) {
+        as.movRI(RAX, line);
+        as.jmp(exitLabel);
+    }
+
+    // Jump to a line: stay native inside the region, exit otherwise
+    void jumpTo(int line) {
+        for (size_t i = 0; i < region.lines.size(); ++i) {
+            if (region.lines[i].number == line) {
+                as.jmp(lineLabels[i]);
+                return;
+            }
+        }
+        exitTo(line);
+    }
+
+    int bailout() {
+        Bailout b = { as.newLabel(), depth, currentLine };
+        bailouts.push_back(b);
+        return b.label;
+    }
+
+    void loadVar(int dst, const std::string &name) {
+        int slot = slots.at(name);
+        if (slot < NUM_VAR_REGS) as.movRR(dst, VAR_REGS[slot]);
+        else as.load(dst, VARS_BASE, 4 * slot);
+    }
+
+    void storeVar(const std::string &name, int src) {
+        int slot = slots.at(name);
+        if (slot < NUM_VAR_REGS) as.movRR(VAR_REGS[slot], src);
+        else as.store(VARS_BASE, 4 * slot, src);
+    }
+
+    void countExec(int i) { as.incMem64(COUNTERS_BASE, 16 * i); }
+    void countTaken(int i) { as.incMem64(COUNTERS_BASE, 16 * i + 8); }
+
+    // Evaluate expression into eax (clobbers ecx, edx)
+    void expression(Expression *exp) {
+        switch (exp->type()) {
+        case CONSTANT:
+            as.movRI(RAX, exp->getConstantValue());
+            return;
+        case IDENTIFIER:
+            loadVar(RAX, exp->getIdentifierName());
+            return;
+        case COMPOUND:
+            break;
+        }
+
+        Expression *rhs = exp->getRHS();
+        expression(exp->getLHS());
+        if (rhs->type() == CONSTANT) {
+            as.movRI(RCX, rhs->getConstantValue());
+        } else if (rhs->type() == IDENTIFIER) {
+            loadVar(RCX, rhs->getIdentifierName());
+        } else {
+            as.push(RAX);
+            ++depth;
+            expression(rhs);
+            as.movRR(RCX, RAX);
+            as.pop(RAX);
+            --depth;
+        }
+
+        std::string op = exp->getOperator();
+        if (op == "+") as.alu(ALU_ADD, RAX, RCX);
+        else if (op == "-") as.alu(ALU_SUB, RAX, RCX);
+        else if (op == "*") as.imul(RAX, RCX);
+        else if (op == "/") {
+            // Zero divisor and INT_MIN / -1 go back to the interpreter
+            as.alu(ALU_TEST, RCX, RCX);
+            as.jcc(CC_E, bailout());
+            int ok = as.newLabel();
+            as.cmpRI(RCX, -1);
+            as.jcc(CC_NE, ok);
+            as.cmpRI(RAX, INT_MIN);
+            as.jcc(CC_E, bailout());
+            as.bind(ok);
+            as.cdq();
+            as.idiv(RCX);
+        } else {
+            // MOD: zero divisor yields 0, result takes the divisor's sign
+            int zero = as.newLabel(), ok = as.newLabel(), done = as.newLabel();
+            as.alu(ALU_TEST, RCX, RCX);
+            as.jcc(CC_E, zero);
+            as.cmpRI(RCX, -1);
+            as.jcc(CC_NE, ok);
+            as.cmpRI(RAX, INT_MIN);
+            as.jcc(CC_E, bailout());
+            as.bind(ok);
+            as.cdq();
+            as.idiv(RCX);
+            as.movRR(RAX, RDX);
+            as.alu(ALU_TEST, RAX, RAX);
+            as.jcc(CC_E, done);
+            as.movRR(RDX, RAX);
+            as.alu(ALU_XOR, RDX, RCX);
+            as.jcc(CC_NS, done);
+            as.alu(ALU_ADD, RAX, RCX);
+            as.jmp(done);
+            as.bind(zero);
+            as.movRI(RAX, 0);
+            as.bind(done);
+        }
+    }
+
+    void statement(int i) {
+        currentLine = i;
+        const JitRegion::Line &line = region.lines[i];
+        int next = i + 1 < (int)region.lines.size() ? region.lines[i + 1].number : fallthrough;
+
+        if (!line.stmt) return;          // unparsed line: the interpreter skips it too
+        if (!line.native) {
+            exitTo(line.number);
+            return;
+        }
+
+        Statement *stmt = line.stmt;
+        switch (stmt->type()) {
+        case StatementType::REM:
+            countExec(i);
+            break;
+        case StatementType::LET:
+            expression(stmt->getExpression());
+            storeVar(stmt->getVariableName(), RAX);
+            countExec(i);
+            break;
+        case StatementType::GOTO:
+            countExec(i);
+            jumpTo(stmt->getTargetLine() == line.number ? next : stmt->getTargetLine());
+            break;
+        case StatementType::END:
+            exitTo(JIT_END);
+            break;
+        case StatementType::IF: {
+            expression(stmt->getLHS());
+            Expression *rhs = stmt->getRHS();
+            if (rhs->type() == CONSTANT) {
+                as.movRI(RCX, rhs->getConstantValue());
+            } else if (rhs->type() == IDENTIFIER) {
+                loadVar(RCX, rhs->getIdentifierName());
+            } else {
+                as.push(RAX);
+                ++depth;
+                expression(rhs);
+                as.movRR(RCX, RAX);
+                as.pop(RAX);
+                --depth;
+            }
+            countExec(i);
+
+            // Unknown relational operators are never true in IfStmt::execute
+            std::string op = stmt->getOperator();
+            if (op == "=" || op == "<" || op == ">") {
+                int taken = as.newLabel();
+                as.alu(ALU_CMP, RAX, RCX);
+                as.jcc(op == "=" ? CC_E : op == "<" ? CC_L : CC_G, taken);
+                jumpTo(next);
+                as.bind(taken);
+                countTaken(i);
+                // A jump to its own line counts as no jump in Interpreter::run
+                jumpTo(stmt->getTargetLine() == line.number ? next : stmt->getTargetLine());
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+};
+
+} // namespace
+
+// ============ JitEngine Implementation ============
+
+JitEngine::JitEngine(const Program &program, int threshold)
+    : program(program), threshold(threshold) {}
+
+JitEngine::~JitEngine() = default;
+
+bool JitEngine::isSupported() {
+#ifdef QBASIC_JIT_X64
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool JitEngine::killSwitchActive() {
+    return std::getenv("QBASIC_NO_JIT") != nullptr;
+}
+
+// Count taken back edges per target line and compile once hot
+void JitEngine::noteBackEdge(int from, int to) {
+    if (entries.count(to)) return;
+    int &count = backEdgeCount[to];
+    if (++count == threshold) compileRegion(to, from);
+}
+
+void JitEngine::compileRegion(int head, int tail) {
+    auto inside = excluded.lower_bound(head);
+    if (inside != excluded.end() && *inside <= tail) return;
+#ifdef QBASIC_JIT_X64
+    std::unique_ptr<JitRegion> region(new JitRegion());
+    std::map<std::string, int> slots;
+
+    for (int line = head; line != -1 && line <= tail; line = program.getNextLineNumber(line)) {
+        if (entries.count(line)) return;   // overlaps a compiled region
+
+        JitRegion::Line l;
+        l.number = line;
+        l.stmt = program.getParsedStatement(line);
+        l.native = !l.stmt || compilable(l.stmt);
+
+        if (l.stmt && l.native) {
+            std::map<std::string, int> uses;
+            switch (l.stmt->type()) {
+            case StatementType::LET:
+                if (!slots.count(l.stmt->getVariableName())) {
+                    slots[l.stmt->getVariableName()] = (int)region->names.size();
+                    region->names.push_back(l.stmt->getVariableName());
+                }
+                collectVars(l.stmt->getExpression(), slots, region->names);
+                countUses(l.stmt->getExpression(), uses);
+                break;
+            case StatementType::IF:
+                collectVars(l.stmt->getLHS(), slots, region->names);
+                collectVars(l.stmt->getRHS(), slots, region->names);
+                countUses(l.stmt->getLHS(), uses);
+                countUses(l.stmt->getRHS(), uses);
+                break;
+            default:
+                break;
+            }
+            l.uses.assign(uses.begin(), uses.end());
+        }
+        region->lines.push_back(l);
+    }
+    if (region->lines.empty()) return;
+
+    int fallthrough = program.getNextLineNumber(region->lines.back().number);
+    RegionCompiler compiler(*region, slots, fallthrough);
+    if (!compiler.compile()) return;
+
+    region->memory.reset(new ExecutableMemory(compiler.code()));
+    if (!region->memory->valid()) return;
+    region->vars.assign(region->names.size() + 1, 0);
+    region->counters.assign(2 * region->lines.size(), 0);
+
+    for (int i = 0; i < (int)region->lines.size(); ++i) {
+        if (region->lines[i].native) entries[region->lines[i].number] = {region.get(), i};
+    }
+    regions.push_back(std::move(region));
+#else
+    (void)head;
+    (void)tail;
+#endif
+}
+
+// Enter native code at `line` and credit everything it executed
+bool JitEngine::tryEnter(int line, EvalState &state) {
+    auto it = entries.find(line);
+    if (it == entries.end()) return false;
+    JitRegion &region = *it->second.first;
+
+    // Native code cannot raise VARIABLE NOT DEFINED: leave that to the interpreter
+    for (size_t i = 0; i < region.names.size(); ++i) {
+        if (!state.isDefined(region.names[i])) return false;
+        region.vars[i] = state.getValue(region.names[i]);
+    }
+    std::fill(region.counters.begin(), region.counters.end(), 0);
+
+    int next = region.memory->function()(region.vars.data(), region.counters.data(), it->second.second);
+
+    for (size_t i = 0; i < region.names.size(); ++i) state.setValue(region.names[i], region.vars[i]);
+
+    RuntimeStats *rs = state.getRuntimeStats();
+    for (size_t i = 0; i < region.lines.size(); ++i) {
+        const JitRegion::Line &l = region.lines[i];
+        uint64_t executed = region.counters[2 * i];
+        if (!l.stmt || executed == 0 || !rs) continue;
+
+        LineCounters &counters = rs->lineCounters[l.number];
+        counters.execCount += (int)executed;
+        if (l.stmt->type() == StatementType::IF) {
+            uint64_t taken = region.counters[2 * i + 1];
+            counters.thenCount += (int)taken;
+            counters.ifCount += (int)(executed - taken);
+        }
+        for (const auto &u : l.uses) rs->identifierUseCount[u.first] += (int)(u.second * executed);
+    }
+
+    if (next == JIT_END) state.setEnd();
+    else state.setNextLine(program.requireLine(next));
+    return true;
+}
+
+// ============ Differential testing ============
+
+namespace {
+
+struct RunRecord {
+    std::string output;
+    std::string error;
+    std::map<std::string, int> variables;
+    std::string tree;
+};
+
+RunRecord recordRun(const Program &program, const std::vector<int> &inputs, bool jit) {
+    RunRecord record;
+    Interpreter itp;
+    itp.setLoopAcceleration(false);
+    itp.setJitEnabled(jit);
+    if (jit) itp.setJitThreshold(1);
+
+    size_t next = 0;
+    itp.setInputProvider([&]() -> std::string {
+        if (next >= inputs.size()) throw std::runtime_error("OUT OF INPUT");
+        return std::to_string(inputs[next++]);
+    });
+
+    std::ostringstream out;
+    std::streambuf *old = std::cout.rdbuf(out.rdbuf());
+    try {
+        itp.run(program);
+    } catch (const std::exception &e) {
+        record.error = e.what();
+    }
+    std::cout.rdbuf(old);
+
+    record.output = out.str();
+    record.variables = itp.getState().getVariables();
+    record.tree = itp.toSyntaxTree(program);
+    return record;
+}
+
+} // namespace
+
+JitComparison compareJitWithInterpreter(const Program &program, const std::vector<int> &inputs) {
+    JitComparison result;
+    RunRecord reference = recordRun(program, inputs, false);
+    RunRecord native = recordRun(program, inputs, true);
+
+    if (reference.output != native.output) result.details = "output differs";
+    else if (reference.error != native.error)
+        result.details = "error differs: '" + reference.error + "' vs '" + native.error + "'";
+    else if (reference.variables != native.variables) result.details = "variables differ";
+    else if (reference.tree != native.tree) result.details = "execution counters differ";
+
+    result.identical = result.details.empty();
+    return result;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file    jit.h
+ * @brief   Tiered native compilation of hot loops for x86-64
+ *
+ *          The interpreter reports every taken back edge (IF/GOTO to an
+ *          earlier or the same line). Once a target line has been reached
+ *          that way HOT_THRESHOLD times, the line range [target, source] is
+ *          compiled into x86-64 machine code placed in executable memory.
+ *          Up to ten variables of the region live in registers, the rest in
+ *          a flat array.
+ *
+ *          Native code only covers LET, IF, GOTO, REM and END. PRINT, INPUT,
+ *          unsupported operators and anything that would raise an error
+ *          (DIVIDE BY ZERO) leave native code and the interpreter runs that
+ *          statement itself, so output and error messages are unchanged.
+ *          Execution counters and identifier use counts are credited on exit.
+ *
+ *          Kill switch: set the environment variable QBASIC_NO_JIT or call
+ *          Interpreter::setJitEnabled(false).
+ *
+ * @author  simple_wind
+ * @version 1.0
+ * @date    2025-12-09
+ * */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../core/program.h"
+#include "../runtime/evalstate.h"
+
+struct JitRegion;
+
+class JitEngine {
+public:
+    // threshold: back edges needed before a region gets compiled
+    explicit JitEngine(const Program &program, int threshold = HOT_THRESHOLD);
+    ~JitEngine();
+
+    // True if native code can be generated for this build (x86-64 only)
+    static bool isSupported();
+
+    // True if the QBASIC_NO_JIT environment variable disables the JIT
+    static bool killSwitchActive();
+
+    // Record a taken back edge; compiles the enclosed region once it is hot
+    void noteBackEdge(int from, int to);
+
+    // Never compile a region containing one of these lines
+    void excludeLines(const std::set<int> &lines) { excluded = lines; }
+
+    // Run native code if a compiled region has an entry at `line`
+    // Returns: true if native code ran and state.getNextLine() (or the end
+    //          flag) says where to continue; the caller must then interpret at
+    //          least one statement before calling again
+    bool tryEnter(int line, EvalState &state);
+
+    // Number of regions compiled so far
+    int compiledRegionCount() const { return (int)regions.size(); }
+
+    // Default number of back edges before a region gets compiled
+    static const int HOT_THRESHOLD = 50;
+
+private:
+    const Program &program;
+    int threshold;
+    std::map<int, int> backEdgeCount;                   // target line -> taken back edges
+    std::vector<std::unique_ptr<JitRegion>> regions;    // compiled code
+    std::map<int, std::pair<JitRegion*, int>> entries;  // line -> (region, entry index)
+    std::set<int> excluded;                             // lines no region may contain
+
+    void compileRegion(int head, int tail);
+};
+
+// Result of comparing a JIT run against a reference run
+struct JitComparison {
+    bool identical = true;      // true if output, error, variables and counters match
+    std::string details;        // first difference found (empty if identical)
+};
+
+// Differential test mode: runs the program once with Interpreter::run with
+// all acceleration disabled, then once with the JIT forced on (threshold
+// reached immediately), feeding both the same INPUT values, and compares
+// printed output, error messages, final variables and the syntax tree
+// (which carries every execution counter)
+JitComparison compareJitWithInterpreter(const Program &program, const std::vector<int> &inputs = {});
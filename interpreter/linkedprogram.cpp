@@ -0,0 +1,452 @@
+#include "linkedprogram.h"
+#include "../core/statement.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <sstream>
+
+// ============ Linking ============
+
+LinkedProgram::LinkedProgram(const Program &program) : program(program) {
+    for (int line = program.getFirstLineNumber(); line != -1; line = program.getNextLineNumber(line))
+        lineChanged(line);
+    program.addObserver(this);
+}
+
+LinkedProgram::~LinkedProgram() {
+    program.removeObserver(this);
+}
+
+int LinkedProgram::acquireVariable(const std::string &name) {
+    auto it = varSlot.find(name);
+    if (it != varSlot.end()) {
+        ++varRefs[it->second];
+        return it->second;
+    }
+
+    int slot;
+    if (!freeVars.empty()) {
+        slot = freeVars.back();
+        freeVars.pop_back();
+        varNames[slot] = name;
+        varRefs[slot] = 1;
+    } else {
+        slot = (int)varNames.size();
+        varNames.push_back(name);
+        varRefs.push_back(1);
+    }
+    varSlot[name] = slot;
+    return slot;
+}
+
+void LinkedProgram::releaseVariable(int slot) {
+    if (--varRefs[slot] > 0) return;
+    varSlot.erase(varNames[slot]);
+    varNames[slot].clear();
+    freeVars.push_back(slot);
+}
+
+void LinkedProgram::compile(Line &line, Expression *exp) {
+    switch (exp->type()) {
+    case CONSTANT:
+        line.code.push_back({LinkOp::CONST, exp->getConstantValue()});
+        break;
+    case IDENTIFIER: {
+        int slot = acquireVariable(exp->getIdentifierName());
+        line.vars.push_back(slot);
+        line.code.push_back({LinkOp::VAR, slot});
+        break;
+    }
+    case COMPOUND: {
+        compile(line, exp->getLHS());
+        compile(line, exp->getRHS());
+        std::string op = exp->getOperator();
+        LinkOp::Kind kind = op == "+" ? LinkOp::ADD : op == "-" ? LinkOp::SUB
+                          : op == "*" ? LinkOp::MUL : op == "/" ? LinkOp::DIV
+                          : op == "MOD" ? LinkOp::MOD : op == "**" ? LinkOp::POW
+                          : LinkOp::UNKNOWN;
+        line.code.push_back({kind, 0});
+        break;
+    }
+    }
+}
+
+// Drop everything the line's statement contributed (variables, reverse jump entry)
+void LinkedProgram::unlink(int slot) {
+    Line &line = lines[slot];
+    for (int v : line.vars) releaseVariable(v);
+    if (line.target != -1) {
+        auto it = referrers.find(line.target);
+        std::vector<int> &from = it->second;
+        from.erase(std::find(from.begin(), from.end(), slot));
+        if (from.empty()) referrers.erase(it);
+    }
+    line.stmt = nullptr;
+    line.target = line.jump = line.var = -1;
+    line.relation = line.split = 0;
+    line.code.clear();
+    line.vars.clear();
+    line.uses.clear();
+}
+
+// Compile the current statement of the line and resolve its jump
+void LinkedProgram::link(int slot) {
+    Line &line = lines[slot];
+    Statement *stmt = program.getParsedStatement(line.number);
+    line.stmt = stmt;
+    ++work;
+    if (!stmt) return;
+
+    switch (stmt->type()) {
+    case StatementType::LET:
+        line.var = acquireVariable(stmt->getVariableName());
+        line.vars.push_back(line.var);
+        compile(line, stmt->getExpression());
+        break;
+    case StatementType::PRINT:
+        compile(line, stmt->getExpression());
+        break;
+    case StatementType::INPUT:
+        line.var = acquireVariable(stmt->getVariableName());
+        line.vars.push_back(line.var);
+        break;
+    case StatementType::GOTO:
+        line.target = stmt->getTargetLine();
+        break;
+    case StatementType::IF: {
+        compile(line, stmt->getLHS());
+        line.split = (int)line.code.size();
+        compile(line, stmt->getRHS());
+        std::string op = stmt->getOperator();
+        // Other relational operators are never true in IfStmt::execute
+        line.relation = op == "=" || op == "<" || op == ">" ? op[0] : 0;
+        line.target = stmt->getTargetLine();
+        break;
+    }
+    default:
+        break;
+    }
+
+    if (line.target != -1) {
+        referrers[line.target].push_back(slot);
+        auto it = slotOf.find(line.target);
+        line.jump = it == slotOf.end() ? -1 : it->second;
+    }
+
+    std::map<int, int> uses;
+    for (const LinkOp &op : line.code) {
+        if (op.kind == LinkOp::VAR) uses[op.value]++;
+    }
+    line.uses.assign(uses.begin(), uses.end());
+}
+
+void LinkedProgram::lineChanged(int number) {
+    auto it = slotOf.find(number);
+    bool exists = program.hasLine(number);
+
+    if (it != slotOf.end()) {
+        int slot = it->second;
+        unlink(slot);
+        if (exists) {
+            link(slot);
+            return;
+        }
+
+        // Removed: the predecessor skips it, jumps to it miss
+        int next = lines[slot].next;
+        if (it == slotOf.begin()) {
+            first = next;
+        } else {
+            lines[std::prev(it)->second].next = next;
+            ++work;
+        }
+        auto from = referrers.find(number);
+        if (from != referrers.end()) {
+            for (int r : from->second) {
+                lines[r].jump = -1;
+                ++work;
+            }
+        }
+        slotOf.erase(it);
+        lines[slot] = Line();
+        freeLines.push_back(slot);
+        return;
+    }
+    if (!exists) return;
+
+    // New line: splice it in and resolve the jumps waiting for it
+    int slot;
+    if (!freeLines.empty()) {
+        slot = freeLines.back();
+        freeLines.pop_back();
+    } else {
+        slot = (int)lines.size();
+        lines.emplace_back();
+    }
+    Line &line = lines[slot];
+    line.number = number;
+    line.live = true;
+
+    it = slotOf.emplace(number, slot).first;
+    auto after = std::next(it);
+    line.next = after == slotOf.end() ? -1 : after->second;
+    if (it == slotOf.begin()) {
+        first = slot;
+    } else {
+        lines[std::prev(it)->second].next = slot;
+        ++work;
+    }
+    auto from = referrers.find(number);
+    if (from != referrers.end()) {
+        for (int r : from->second) {
+            lines[r].jump = slot;
+            ++work;
+        }
+    }
+    link(slot);
+}
+
+void LinkedProgram::programCleared() {
+    lines.clear();
+    freeLines.clear();
+    slotOf.clear();
+    referrers.clear();
+    varNames.clear();
+    varRefs.clear();
+    freeVars.clear();
+    varSlot.clear();
+    first = -1;
+}
+
+std::string LinkedProgram::describe() const {
+    std::ostringstream out;
+    for (const auto &entry : slotOf) {
+        const Line &line = lines[entry.second];
+        out << line.number << ": next ";
+        if (line.next == -1) out << "-";
+        else out << lines[line.next].number;
+        if (line.target != -1) {
+            out << ", jump " << line.target;
+            if (line.jump == -1) out << " (missing)";
+        }
+        if (!line.vars.empty()) {
+            std::vector<std::string> names;
+            for (int v : line.vars) names.push_back(varNames[v]);
+            std::sort(names.begin(), names.end());
+            names.erase(std::unique(names.begin(), names.end()), names.end());
+            out << ", vars";
+            for (const std::string &name : names) out << " " << name;
+        }
+        if (!line.stmt) out << ", no statement";
+        out << "\n";
+    }
+    return out.str();
+}
+
+// ============ Execution ============
+
+// Evaluate code[begin, end); false where the expression would raise an error
+bool LinkedProgram::evaluate(const Line &line, int begin, int end, const int32_t *values,
+                             const uint8_t *defined, int32_t &result, std::vector<int32_t> &stack) const {
+    stack.clear();
+    for (int i = begin; i < end; ++i) {
+        const LinkOp &op = line.code[i];
+        if (op.kind == LinkOp::CONST) {
+            stack.push_back(op.value);
+            continue;
+        }
+        if (op.kind == LinkOp::VAR) {
+            if (!defined[op.value]) return false;
+            stack.push_back(values[op.value]);
+            continue;
+        }
+
+        int32_t r = stack.back();
+        stack.pop_back();
+        int32_t l = stack.back();
+        int32_t &out = stack.back();
+        switch (op.kind) {
+        case LinkOp::ADD: out = (int32_t)((uint32_t)l + (uint32_t)r); break;
+        case LinkOp::SUB: out = (int32_t)((uint32_t)l - (uint32_t)r); break;
+        case LinkOp::MUL: out = (int32_t)((uint32_t)l * (uint32_t)r); break;
+        case LinkOp::DIV:
+            if (r == 0 || (r == -1 && l == INT_MIN)) return false;
+            out = l / r;
+            break;
+        case LinkOp::MOD:
+            if (r == 0) {
+                out = 0;
+            } else {
+                if (r == -1 && l == INT_MIN) return false;
+                int32_t m = l % r;
+                if ((r > 0 && m < 0) || (r < 0 && m > 0)) m += r;
+                out = m;
+            }
+            break;
+        case LinkOp::POW: out = (int32_t)std::pow(l, r); break;
+        default: return false;  // the statement reports UNKNOWN OPERATOR
+        }
+    }
+    result = stack.back();
+    return true;
+}
+
+void LinkedProgram::prepare(LinkedFrame &frame) const {
+    frame.values.assign(varNames.size(), 0);
+    frame.defined.assign(varNames.size(), 0);
+    frame.stack.reserve(64);
+}
+
+// Variables in the state <-> frame (hand-back and whole runs)
+void LinkedProgram::load(LinkedFrame &frame, const EvalState &state) const {
+    for (size_t v = 0; v < varNames.size(); ++v) {
+        frame.defined[v] = varRefs[v] > 0 && state.isDefined(varNames[v]);
+        if (frame.defined[v]) frame.values[v] = state.getValue(varNames[v]);
+    }
+}
+
+void LinkedProgram::store(const LinkedFrame &frame, EvalState &state) const {
+    for (size_t v = 0; v < varNames.size(); ++v) {
+        if (frame.defined[v]) state.setValue(varNames[v], frame.values[v]);
+    }
+}
+
+// Counters of compiled executions, credited at the end
+void LinkedProgram::flush(const LinkedFrame &frame, EvalState &state) const {
+    RuntimeStats *rs = state.getRuntimeStats();
+    if (!rs) return;
+    for (int slot : frame.touched) {
+        const Line &line = lines[slot];
+        LineCounters &counters = rs->lineCounters[line.number];
+        counters.execCount += (int)frame.runs[slot];
+        if (line.stmt->type() == StatementType::IF) {
+            counters.thenCount += (int)frame.taken[slot];
+            counters.ifCount += (int)(frame.runs[slot] - frame.taken[slot]);
+        }
+        for (const auto &u : line.uses) rs->identifierUseCount[varNames[u.first]] += (int)(u.second * frame.runs[slot]);
+    }
+}
+
+void LinkedProgram::run(EvalState &state) const {
+    LinkedFrame frame;
+    prepare(frame);
+    frame.runs.assign(lines.size(), 0);
+    frame.taken.assign(lines.size(), 0);
+    load(frame, state);
+    try {
+        execute(frame, state, true);
+    } catch (...) {
+        store(frame, state);
+        flush(frame, state);
+        throw;
+    }
+    store(frame, state);
+    flush(frame, state);
+}
+
+void LinkedProgram::run(LinkedFrame &frame, EvalState &state) const {
+    execute(frame, state, false);
+}
+
+void LinkedProgram::execute(LinkedFrame &frame, EvalState &state, bool counting) const {
+    // Same start as Interpreter::run (throws on an empty program)
+    if (first == -1) program.requireLine(-1);
+    state.setNextLine(lines[first].number);
+
+    int32_t *values = frame.values.data();
+    uint8_t *defined = frame.defined.data();
+    std::vector<int32_t> &stack = frame.stack;
+    auto count = [&](int slot) {
+        if (counting && frame.runs[slot]++ == 0) frame.touched.push_back(slot);
+    };
+
+    int slot = first;
+    while (true) {
+        const Line &line = lines[slot];
+        int to = line.next;
+        bool handBack = false;
+
+        if (line.stmt) {
+            int end = (int)line.code.size();
+            int32_t value, rhs;
+            switch (line.stmt->type()) {
+            case StatementType::REM:
+                count(slot);
+                break;
+            case StatementType::LET:
+                if (!evaluate(line, 0, end, values, defined, value, stack)) {
+                    handBack = true;
+                    break;
+                }
+                count(slot);
+                values[line.var] = value;
+                defined[line.var] = 1;
+                break;
+            case StatementType::PRINT:
+                if (!evaluate(line, 0, end, values, defined, value, stack)) {
+                    handBack = true;
+                    break;
+                }
+                count(slot);
+                PrintStmt::print(state, value);
+                break;
+            case StatementType::GOTO: {
+                // A jump to the current line is no jump
+                int jump = line.target == line.number ? line.next : line.jump;
+                if (jump == -1) {
+                    handBack = true;
+                    break;
+                }
+                count(slot);
+                to = jump;
+                break;
+            }
+            case StatementType::IF: {
+                if (!evaluate(line, 0, line.split, values, defined, value, stack)
+                    || !evaluate(line, line.split, end, values, defined, rhs, stack)) {
+                    handBack = true;
+                    break;
+                }
+                bool cond = (line.relation == '=' && value == rhs) || (line.relation == '<' && value < rhs)
+                            || (line.relation == '>' && value > rhs);
+                int jump = line.target == line.number ? line.next : line.jump;
+                if (cond && jump == -1) {
+                    handBack = true;
+                    break;
+                }
+                count(slot);
+                if (cond) {
+                    if (counting) ++frame.taken[slot];
+                    to = jump;
+                }
+                break;
+            }
+            case StatementType::END:
+                state.setEnd();
+                return;
+            default:
+                handBack = true;    // INPUT
+                break;
+            }
+        }
+
+        if (handBack) {
+            // Let the statement itself run this line (and raise its error)
+            store(frame, state);
+            state.setCurrentLine(line.number);
+            state.setNextLine(line.number);
+            line.stmt->execute(state, program);
+            load(frame, state);     // before a missing next line can throw
+            if (state.getNextLine() == line.number)
+                state.setNextLine(program.requireLine(program.getNextLineNumber(line.number)));
+            to = slotOf.at(state.getNextLine());
+        }
+
+        // Falling off the last line fails like Interpreter::run
+        if (to == -1) {
+            state.setNextLine(line.number);
+            program.requireLine(-1);
+        }
+        slot = to;
+    }
+}
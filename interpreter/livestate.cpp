@@ -0,0 +1,96 @@
+#include "livestate.h"
+#include <thread>
+
+// ============ LiveState Implementation ============
+
+LiveState::LiveState(double seconds)
+    : values(new std::atomic<int32_t>[MAX_VARIABLES]), names(MAX_VARIABLES),
+    executed(new std::atomic<uint64_t>[MAX_LINES]), numbers(MAX_LINES),
+    interval(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(seconds))) {
+    reset();
+}
+
+void LiveState::reset() {
+    sequence.store(0, std::memory_order_relaxed);
+    line.store(-1, std::memory_order_relaxed);
+    count.store(0, std::memory_order_relaxed);
+    for (int i = 0; i < MAX_VARIABLES; ++i) values[i].store(0, std::memory_order_relaxed);
+    for (std::string &name : names) name.clear();
+    slots.clear();
+    lineTotal.store(0, std::memory_order_relaxed);
+    for (int i = 0; i < MAX_LINES; ++i) executed[i].store(0, std::memory_order_relaxed);
+    lineSlots.clear();
+    stop.store(false, std::memory_order_relaxed);
+    nextDue = std::chrono::steady_clock::time_point();
+}
+
+void LiveState::begin(int at) {
+    sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    line.store(at, std::memory_order_relaxed);
+}
+
+void LiveState::variable(const std::string &name, int value) {
+    auto it = slots.find(name);
+    if (it == slots.end()) {
+        int slot = (int)slots.size();
+        if (slot >= MAX_VARIABLES) return;
+        it = slots.emplace(name, slot).first;
+        names[slot] = name;
+        values[slot].store(value, std::memory_order_relaxed);
+        count.store(slot + 1, std::memory_order_release);
+        return;
+    }
+    values[it->second].store(value, std::memory_order_relaxed);
+}
+
+void LiveState::lineCount(int number, uint64_t count) {
+    auto it = lineSlots.find(number);
+    if (it == lineSlots.end()) {
+        int slot = (int)lineSlots.size();
+        if (slot >= MAX_LINES) return;
+        it = lineSlots.emplace(number, slot).first;
+        numbers[slot] = number;
+        executed[slot].store(count, std::memory_order_relaxed);
+        lineTotal.store(slot + 1, std::memory_order_release);
+        return;
+    }
+    executed[it->second].store(count, std::memory_order_relaxed);
+}
+
+void LiveState::end() {
+    sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    nextDue = std::chrono::steady_clock::now() + interval;
+}
+
+bool LiveState::read(LiveSnapshot &out) const {
+    std::vector<int32_t> copy;
+    std::vector<uint64_t> counts;
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        uint64_t before = sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            std::this_thread::yield();
+            continue;
+        }
+        int n = count.load(std::memory_order_acquire);
+        int at = line.load(std::memory_order_relaxed);
+        copy.resize(n);
+        for (int i = 0; i < n; ++i) copy[i] = values[i].load(std::memory_order_relaxed);
+        int m = lineTotal.load(std::memory_order_acquire);
+        counts.resize(m);
+        for (int i = 0; i < m; ++i) counts[i] = executed[i].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) != before) continue;
+
+        // Names below the count were written before it and stay as they are
+        out.version = before / 2;
+        out.line = at;
+        out.variables.resize(n);
+        for (int i = 0; i < n; ++i) out.variables[i] = {names[i], copy[i]};
+        out.lines.resize(m);
+        for (int i = 0; i < m; ++i) out.lines[i] = {numbers[i], counts[i]};
+        return true;
+    }
+    return false;
+}
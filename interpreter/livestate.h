@@ -0,0 +1,112 @@
+/**
+ * @file    livestate.h
+ * @brief   Variables and line of a running program, readable from another
+ *          thread while it runs
+ *
+ *          The thread running the program publishes the line it is at and
+ *          its variables every so often (see Interpreter::setLiveState and
+ *          RegisterVM::setLiveState: at back edges or block entries, at most
+ *          once per interval). A reader, typically a GUI timer, copies the
+ *          latest publication whenever it likes.
+ *
+ *          Publications go through a seqlock: the writer makes the sequence
+ *          number odd, stores line and values, and makes it even again; a
+ *          reader copies everything and keeps the copy only if the sequence
+ *          number was even and unchanged around it. The writer never waits
+ *          for a reader, and a reader never takes a lock, it only retries.
+ *          Variable names are appended once, before the count that makes
+ *          them visible, and never change during a run.
+ *
+ *          Execution counts of the lines so far travel the same way, for a
+ *          heat map of a run in progress; like names, line numbers get a
+ *          slot once and keep it.
+ *
+ *          A reader can also ask the run to stop; the writer checks at each
+ *          publication point and throws RunStoppedError.
+ *
+ * @author  simple_wind
+ * @version 1.0
+ * @date    2025-12-20
+ * */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Thrown by a run whose LiveState was asked to stop
+class RunStoppedError : public std::runtime_error {
+public:
+    RunStoppedError() : std::runtime_error("RUN STOPPED") {}
+};
+
+// One consistent publication
+struct LiveSnapshot {
+    uint64_t version = 0;       // publications so far, 0: none yet
+    int line = -1;              // line about to execute
+    std::vector<std::pair<std::string, int>> variables;     // in order of first publication
+    std::vector<std::pair<int, uint64_t>> lines;            // line -> times executed, same order
+};
+
+class LiveState {
+public:
+    static const int MAX_VARIABLES = 1024;      // further variables are not published
+    static const int MAX_LINES = 16384;         // further line counts are not published
+
+    // interval: least time between two publications
+    explicit LiveState(double interval = 0.01);
+
+    // Writer side: the thread running the program
+
+    // True when the interval since the last publication has passed
+    bool due() const { return std::chrono::steady_clock::now() >= nextDue; }
+
+    // One publication: begin, every defined variable and executed line, end
+    void begin(int line);
+    void variable(const std::string &name, int value);
+    void lineCount(int number, uint64_t executed);
+    void end();
+
+    // Throw RunStoppedError if a reader asked the run to stop
+    void checkStop() const {
+        if (stop.load(std::memory_order_relaxed)) throw RunStoppedError();
+    }
+
+    // Reader side: any thread
+
+    // Copy the latest publication; false if the writer kept changing it
+    // (the copy is then left as it was)
+    bool read(LiveSnapshot &out) const;
+
+    // Ask the run to stop at its next publication point
+    void requestStop() { stop.store(true, std::memory_order_relaxed); }
+    bool stopRequested() const { return stop.load(std::memory_order_relaxed); }
+
+    // Forget variables, publications and a stop request before a new run
+    // (neither a writer nor a reader may be active)
+    void reset();
+
+private:
+    std::atomic<uint64_t> sequence{0};          // odd while a publication is written
+    std::atomic<int> line{-1};
+    std::atomic<int> count{0};                  // variables published so far
+    std::unique_ptr<std::atomic<int32_t>[]> values;
+    std::vector<std::string> names;             // slot -> name, fixed once counted
+    std::atomic<int> lineTotal{0};              // line counts published so far
+    std::unique_ptr<std::atomic<uint64_t>[]> executed;
+    std::vector<int> numbers;                   // slot -> line number, fixed once counted
+    std::atomic<bool> stop{false};
+
+    // Writer only
+    std::unordered_map<std::string, int> slots;
+    std::unordered_map<int, int> lineSlots;
+    std::chrono::steady_clock::duration interval;
+    std::chrono::steady_clock::time_point nextDue;
+};
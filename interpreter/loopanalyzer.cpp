@@ -0,0 +1,695 @@
+#include "loopanalyzer.h"
+#include "../core/statement.h"
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+// ============ Checked arithmetic ============
+// Symbolic coefficients must stay exact; anything that grows past this bound
+// is treated as "not provable" and the loop falls back to batch execution.
+
+const long long COEF_LIMIT = 1LL << 62;
+
+bool addChecked(long long a, long long b, long long &out) {
+    out = a + b;   // cannot overflow: both operands are below COEF_LIMIT
+    return out < COEF_LIMIT && out > -COEF_LIMIT;
+}
+
+bool mulChecked(long long a, long long b, long long &out) {
+    if (a == 0 || b == 0) {
+        out = 0;
+        return true;
+    }
+    long long absA = a < 0 ? -a : a;
+    long long absB = b < 0 ? -b : b;
+    if (absA > COEF_LIMIT / absB) return false;
+    out = a * b;
+    return true;
+}
+
+bool fitsInt(long long v) {
+    return v >= INT_MIN && v <= INT_MAX;
+}
+
+// ============ Affine forms ============
+// value = c + sum(coef[i] * x[i]) over the loop variable slots
+
+struct Affine {
+    bool ok = true;
+    long long c = 0;
+    std::vector<long long> coef;
+
+    Affine() = default;
+    explicit Affine(int n) : coef(n, 0) {}
+
+    static Affine constant(int n, long long value) {
+        Affine a(n);
+        a.c = value;
+        return a;
+    }
+
+    static Affine variable(int n, int slot) {
+        Affine a(n);
+        a.coef[slot] = 1;
+        return a;
+    }
+
+    static Affine invalid() {
+        Affine a;
+        a.ok = false;
+        return a;
+    }
+
+    bool isConstant() const {
+        for (long long k : coef) if (k != 0) return false;
+        return true;
+    }
+
+    // Evaluate with exact (non-wrapping) arithmetic
+    bool eval(const std::vector<long long> &x, long long &out) const {
+        long long acc = c;
+        for (size_t i = 0; i < coef.size(); ++i) {
+            long long term;
+            if (!mulChecked(coef[i], x[i], term) || !addChecked(acc, term, acc)) return false;
+        }
+        out = acc;
+        return true;
+    }
+};
+
+Affine combine(const Affine &l, const Affine &r, int sign) {
+    if (!l.ok || !r.ok) return Affine::invalid();
+    Affine out((int)l.coef.size());
+    long long rc;
+    if (!mulChecked(r.c, sign, rc) || !addChecked(l.c, rc, out.c)) return Affine::invalid();
+    for (size_t i = 0; i < l.coef.size(); ++i) {
+        long long rk;
+        if (!mulChecked(r.coef[i], sign, rk) || !addChecked(l.coef[i], rk, out.coef[i]))
+            return Affine::invalid();
+    }
+    return out;
+}
+
+Affine scale(const Affine &a, long long k) {
+    if (!a.ok) return Affine::invalid();
+    Affine out((int)a.coef.size());
+    if (!mulChecked(a.c, k, out.c)) return Affine::invalid();
+    for (size_t i = 0; i < a.coef.size(); ++i) {
+        if (!mulChecked(a.coef[i], k, out.coef[i])) return Affine::invalid();
+    }
+    return out;
+}
+
+// ============ Batch code ============
+// Postfix code over a flat variable array; evaluation order matches
+// CompoundExp::eval (left operand first)
+
+struct LoopOp {
+    enum Code { CONST, LOAD, STORE, ADD, SUB, MUL, DIV, MOD, POW, CMP_EQ, CMP_LT, CMP_GT };
+    Code code;
+    int arg;
+};
+
+// Run code over vals; the final value left on the stack (if any) goes to result
+// Returns false if the interpreter would have raised an error here
+bool runCode(const std::vector<LoopOp> &code, int *vals, int *stack, int &result) {
+    int sp = 0;
+    for (const LoopOp &op : code) {
+        switch (op.code) {
+        case LoopOp::CONST: stack[sp++] = op.arg; break;
+        case LoopOp::LOAD:  stack[sp++] = vals[op.arg]; break;
+        case LoopOp::STORE: vals[op.arg] = stack[--sp]; break;
+        default: {
+            int r = stack[--sp];
+            int l = stack[--sp];
+            int v = 0;
+            switch (op.code) {
+            case LoopOp::ADD: v = (int)((unsigned)l + (unsigned)r); break;
+            case LoopOp::SUB: v = (int)((unsigned)l - (unsigned)r); break;
+            case LoopOp::MUL: v = (int)((unsigned)l * (unsigned)r); break;
+            case LoopOp::DIV:
+                if (r == 0 || (l == INT_MIN && r == -1)) return false;
+                v = l / r;
+                break;
+            case LoopOp::MOD:
+                if (r == 0) { v = 0; break; }
+                if (l == INT_MIN && r == -1) return false;
+                v = l % r;
+                if ((r > 0 && v < 0) || (r < 0 && v > 0)) v += r;
+                break;
+            case LoopOp::POW:    v = static_cast<int>(std::pow(l, r)); break;
+            case LoopOp::CMP_EQ: v = (l == r); break;
+            case LoopOp::CMP_LT: v = (l < r); break;
+            case LoopOp::CMP_GT: v = (l > r); break;
+            default: break;
+            }
+            stack[sp++] = v;
+        }
+        }
+    }
+    if (sp > 0) result = stack[sp - 1];
+    return true;
+}
+
+// Smallest t >= 0 such that (base + t * slope  <op>  0) == want, or -1 if none
+long long firstIndex(long long base, long long slope, const std::string &op, bool want) {
+    auto holds = [&](long long v) {
+        bool c = (op == "<") ? v < 0 : (op == ">") ? v > 0 : v == 0;
+        return c == want;
+    };
+    if (holds(base)) return 0;
+
+    if (op == "=") {
+        if (!want) return slope != 0 ? 1 : -1;
+        if (slope == 0 || (-base) % slope != 0) return -1;
+        long long t = -base / slope;
+        return t > 0 ? t : -1;
+    }
+
+    // v > 0 is the same as -v < 0
+    if (op == ">") {
+        base = -base;
+        slope = -slope;
+    }
+
+    if (want) {
+        // base >= 0, need base + t * slope < 0
+        if (slope >= 0) return -1;
+        return base / (-slope) + 1;
+    }
+    // base < 0, need base + t * slope >= 0
+    if (slope <= 0) return -1;
+    return (-base + slope - 1) / slope;
+}
+
+// Square matrix over wrapping 32-bit integers
+typedef std::vector<std::vector<uint32_t>> Matrix;
+
+Matrix multiply(const Matrix &a, const Matrix &b) {
+    size_t n = a.size();
+    Matrix out(n, std::vector<uint32_t>(n, 0));
+    for (size_t i = 0; i < n; ++i)
+        for (size_t k = 0; k < n; ++k) {
+            uint32_t aik = a[i][k];
+            if (aik == 0) continue;
+            for (size_t j = 0; j < n; ++j) out[i][j] += aik * b[k][j];
+        }
+    return out;
+}
+
+Matrix power(Matrix base, long long e) {
+    size_t n = base.size();
+    Matrix result(n, std::vector<uint32_t>(n, 0));
+    for (size_t i = 0; i < n; ++i) result[i][i] = 1;
+    while (e > 0) {
+        if (e & 1) result = multiply(result, base);
+        base = multiply(base, base);
+        e >>= 1;
+    }
+    return result;
+}
+
+const int MAX_CLOSED_FORM_VARS = 32;
+
+} // namespace
+
+// ============ Loop plan ============
+
+struct LoopPlan {
+    bool testAtHead = false;       // IF at head leaves the loop, GOTO at tail closes it
+    int head = -1;                 // first line of the loop
+    int tail = -1;                 // last line of the loop
+    Statement *test = nullptr;     // IF statement deciding whether to iterate again
+    int testLine = -1;             // line of the IF statement
+    int exitLine = -1;             // line reached when the loop is left
+    std::vector<int> body;         // lines executed once per body run
+
+    std::vector<std::string> names;          // slot -> variable name
+    std::vector<int> written;                // slots assigned in the body
+    std::vector<int> exposed;                // slots read before written (must be defined)
+    std::map<std::string, int> bodyUses;     // identifier evaluations per body run
+    std::map<std::string, int> testUses;     // identifier evaluations per test
+
+    std::vector<LoopOp> bodyCode;            // compiled LET statements
+    std::vector<LoopOp> testCode;            // compiled condition, leaves 0 or 1
+    int stackDepth = 0;
+
+    // Closed form data (valid only if closedForm)
+    bool closedForm = false;
+    std::vector<Affine> after;               // variable values after one body run
+    std::vector<Affine> steps;               // per-iteration increment of induction variables
+    std::vector<Affine> testNodes;           // every subexpression of the condition
+    Affine diff;                             // lhs - rhs of the condition
+};
+
+namespace {
+
+void collectNames(Expression *exp, std::map<std::string, int> &slots,
+                  std::vector<std::string> &names) {
+    if (exp->type() == IDENTIFIER) {
+        std::string name = exp->getIdentifierName();
+        if (!slots.count(name)) {
+            slots[name] = (int)names.size();
+            names.push_back(name);
+        }
+    } else if (exp->type() == COMPOUND) {
+        collectNames(exp->getLHS(), slots, names);
+        collectNames(exp->getRHS(), slots, names);
+    }
+}
+
+int slotFor(const std::string &name, std::map<std::string, int> &slots,
+            std::vector<std::string> &names) {
+    if (!slots.count(name)) {
+        slots[name] = (int)names.size();
+        names.push_back(name);
+    }
+    return slots[name];
+}
+
+// Compile expression into postfix code; returns false on unsupported operators
+bool compileExp(Expression *exp, const std::map<std::string, int> &slots,
+                std::vector<LoopOp> &code, int depth, int &maxDepth) {
+    if (depth + 1 > maxDepth) maxDepth = depth + 1;
+    switch (exp->type()) {
+    case CONSTANT:
+        code.push_back({LoopOp::CONST, exp->getConstantValue()});
+        return true;
+    case IDENTIFIER:
+        code.push_back({LoopOp::LOAD, slots.at(exp->getIdentifierName())});
+        return true;
+    case COMPOUND: {
+        if (!compileExp(exp->getLHS(), slots, code, depth, maxDepth)) return false;
+        if (!compileExp(exp->getRHS(), slots, code, depth + 1, maxDepth)) return false;
+        std::string op = exp->getOperator();
+        if (op == "+") code.push_back({LoopOp::ADD, 0});
+        else if (op == "-") code.push_back({LoopOp::SUB, 0});
+        else if (op == "*") code.push_back({LoopOp::MUL, 0});
+        else if (op == "/") code.push_back({LoopOp::DIV, 0});
+        else if (op == "MOD") code.push_back({LoopOp::MOD, 0});
+        else if (op == "**") code.push_back({LoopOp::POW, 0});
+        else return false;   // the interpreter reports UNKNOWN OPERATOR
+        return true;
+    }
+    }
+    return false;
+}
+
+// Symbolically evaluate expression over the current variable forms
+// Every subexpression form is appended to nodes (if given)
+Affine symbolic(Expression *exp, const std::map<std::string, int> &slots,
+                const std::vector<Affine> &env, std::vector<Affine> *nodes) {
+    int n = (int)env.size();
+    Affine result;
+    switch (exp->type()) {
+    case CONSTANT:
+        result = Affine::constant(n, exp->getConstantValue());
+        break;
+    case IDENTIFIER:
+        result = env[slots.at(exp->getIdentifierName())];
+        break;
+    case COMPOUND: {
+        Affine l = symbolic(exp->getLHS(), slots, env, nodes);
+        Affine r = symbolic(exp->getRHS(), slots, env, nodes);
+        std::string op = exp->getOperator();
+        if (!l.ok || !r.ok) result = Affine::invalid();
+        else if (op == "+") result = combine(l, r, 1);
+        else if (op == "-") result = combine(l, r, -1);
+        else if (op == "*") {
+            if (r.isConstant()) result = scale(l, r.c);
+            else if (l.isConstant()) result = scale(r, l.c);
+            else result = Affine::invalid();
+        }
+        else if ((op == "/" || op == "MOD") && l.isConstant() && r.isConstant()
+                 && fitsInt(l.c) && fitsInt(r.c) && r.c != 0
+                 && !(l.c == INT_MIN && r.c == -1)) {
+            // Constant folding with the interpreter's integer semantics
+            long long v = l.c / r.c;
+            if (op == "MOD") {
+                v = l.c % r.c;
+                if ((r.c > 0 && v < 0) || (r.c < 0 && v > 0)) v += r.c;
+            }
+            result = Affine::constant(n, v);
+        }
+        else result = Affine::invalid();
+        break;
+    }
+    }
+    if (nodes) nodes->push_back(result);
+    return result;
+}
+
+void countUses(Expression *exp, std::map<std::string, int> &uses) {
+    if (exp->type() == IDENTIFIER) uses[exp->getIdentifierName()]++;
+    else if (exp->type() == COMPOUND) {
+        countUses(exp->getLHS(), uses);
+        countUses(exp->getRHS(), uses);
+    }
+}
+
+void collectReads(Expression *exp, const std::map<std::string, int> &slots,
+                  std::vector<bool> &writtenSoFar, std::vector<bool> &isExposed) {
+    if (exp->type() == IDENTIFIER) {
+        int slot = slots.at(exp->getIdentifierName());
+        if (!writtenSoFar[slot]) isExposed[slot] = true;
+    } else if (exp->type() == COMPOUND) {
+        collectReads(exp->getLHS(), slots, writtenSoFar, isExposed);
+        collectReads(exp->getRHS(), slots, writtenSoFar, isExposed);
+    }
+}
+
+} // namespace
+
+// ============ LoopAnalyzer Implementation ============
+
+// Constructor: scan for back edges and build a plan for each qualifying loop
+LoopAnalyzer::LoopAnalyzer(const Program &program) {
+    for (int line = program.getFirstLineNumber(); line != -1;
+         line = program.getNextLineNumber(line)) {
+        Statement *stmt = program.getParsedStatement(line);
+        if (!stmt) continue;
+
+        // A jump to its own line counts as no jump in Interpreter::run
+        StatementType t = stmt->type();
+        if ((t == StatementType::IF || t == StatementType::GOTO)
+            && stmt->getTargetLine() < line) {
+            analyze(program, stmt->getTargetLine(), line);
+        }
+    }
+}
+
+LoopAnalyzer::~LoopAnalyzer() = default;
+
+void LoopAnalyzer::excludeLines(const std::set<int> &lines) {
+    for (auto it = loops.begin(); it != loops.end();) {
+        auto inside = lines.lower_bound(it->second->head);
+        if (inside != lines.end() && *inside <= it->second->tail) it = loops.erase(it);
+        else ++it;
+    }
+}
+
+bool LoopAnalyzer::hasLoopAt(int line) const {
+    return loops.count(line) > 0;
+}
+
+bool LoopAnalyzer::isClosedForm(int line) const {
+    auto it = loops.find(line);
+    return it != loops.end() && it->second->closedForm;
+}
+
+// Build a loop plan for the back edge tail -> head (if the shape qualifies)
+void LoopAnalyzer::analyze(const Program &program, int head, int tail) {
+    if (loops.count(head) || !program.hasLine(head)) return;
+
+    std::unique_ptr<LoopPlan> plan(new LoopPlan());
+    plan->head = head;
+    plan->tail = tail;
+
+    Statement *closing = program.getParsedStatement(tail);
+    Statement *first = program.getParsedStatement(head);
+
+    if (closing->type() == StatementType::IF) {
+        plan->test = closing;
+        plan->testLine = tail;
+        plan->exitLine = program.getNextLineNumber(tail);
+    } else {
+        // GOTO at tail: the head must be an IF leaving the loop
+        if (head == tail || !first || first->type() != StatementType::IF) return;
+        int exit = first->getTargetLine();
+        if (exit >= head && exit <= tail) return;
+        plan->testAtHead = true;
+        plan->test = first;
+        plan->testLine = head;
+        plan->exitLine = exit;
+    }
+    // Leaving to a missing line is an error the interpreter reports
+    if (!program.hasLine(plan->exitLine)) return;
+
+    // Collect body statements; only side-effect free lines are allowed
+    std::vector<Statement*> lets;
+    int from = plan->testAtHead ? program.getNextLineNumber(head) : head;
+    for (int line = from; line != -1 && line < tail; line = program.getNextLineNumber(line)) {
+        Statement *stmt = program.getParsedStatement(line);
+        if (!stmt) continue;
+        if (stmt->type() == StatementType::LET) lets.push_back(stmt);
+        else if (stmt->type() != StatementType::REM) return;
+        plan->body.push_back(line);
+    }
+    if (plan->testAtHead) plan->body.push_back(tail);
+
+    // Assign variable slots
+    std::map<std::string, int> slots;
+    for (Statement *let : lets) {
+        slotFor(let->getVariableName(), slots, plan->names);
+        collectNames(let->getExpression(), slots, plan->names);
+    }
+    collectNames(plan->test->getLHS(), slots, plan->names);
+    collectNames(plan->test->getRHS(), slots, plan->names);
+    int n = (int)plan->names.size();
+
+    // Compile batch code
+    std::string op = plan->test->getOperator();
+    LoopOp::Code cmp;
+    if (op == "=") cmp = LoopOp::CMP_EQ;
+    else if (op == "<") cmp = LoopOp::CMP_LT;
+    else if (op == ">") cmp = LoopOp::CMP_GT;
+    else return;
+
+    for (Statement *let : lets) {
+        if (!compileExp(let->getExpression(), slots, plan->bodyCode, 0, plan->stackDepth)) return;
+        plan->bodyCode.push_back({LoopOp::STORE, slots.at(let->getVariableName())});
+    }
+    if (!compileExp(plan->test->getLHS(), slots, plan->testCode, 0, plan->stackDepth)) return;
+    if (!compileExp(plan->test->getRHS(), slots, plan->testCode, 1, plan->stackDepth)) return;
+    plan->testCode.push_back({cmp, 0});
+
+    // Static identifier use counts and read-before-write variables
+    for (Statement *let : lets) countUses(let->getExpression(), plan->bodyUses);
+    countUses(plan->test->getLHS(), plan->testUses);
+    countUses(plan->test->getRHS(), plan->testUses);
+
+    std::vector<bool> writtenSoFar(n, false), isWritten(n, false), isExposed(n, false);
+    if (plan->testAtHead) {
+        collectReads(plan->test->getLHS(), slots, writtenSoFar, isExposed);
+        collectReads(plan->test->getRHS(), slots, writtenSoFar, isExposed);
+    }
+    for (Statement *let : lets) {
+        collectReads(let->getExpression(), slots, writtenSoFar, isExposed);
+        writtenSoFar[slots.at(let->getVariableName())] = true;
+        isWritten[slots.at(let->getVariableName())] = true;
+    }
+    if (!plan->testAtHead) {
+        collectReads(plan->test->getLHS(), slots, writtenSoFar, isExposed);
+        collectReads(plan->test->getRHS(), slots, writtenSoFar, isExposed);
+    }
+    for (int i = 0; i < n; ++i) {
+        if (isWritten[i]) plan->written.push_back(i);
+        if (isExposed[i]) plan->exposed.push_back(i);
+    }
+
+    // Closed form: affine body and a test driven by induction variables only
+    if (n <= MAX_CLOSED_FORM_VARS) {
+        std::vector<Affine> env;
+        for (int i = 0; i < n; ++i) env.push_back(Affine::variable(n, i));
+
+        std::vector<Affine> testEnv = env;   // test at head sees the entry state
+        bool affine = true;
+        for (Statement *let : lets) {
+            Affine v = symbolic(let->getExpression(), slots, env, nullptr);
+            if (!v.ok) affine = false;
+            env[slots.at(let->getVariableName())] = v;
+        }
+        if (!plan->testAtHead) testEnv = env;   // test at end sees the body's result
+
+        if (affine) {
+            plan->after = env;
+
+            // Classify variables: invariant (never written) or induction (x += step)
+            std::vector<bool> usable(n, false);
+            plan->steps.assign(n, Affine::constant(n, 0));
+            for (int i = 0; i < n; ++i) {
+                if (!isWritten[i]) {
+                    usable[i] = true;
+                    continue;
+                }
+                const Affine &a = env[i];
+                if (a.coef[i] != 1) continue;
+                bool ok = true;
+                for (int j = 0; j < n; ++j) {
+                    if (j != i && a.coef[j] != 0 && isWritten[j]) ok = false;
+                }
+                if (!ok) continue;
+                usable[i] = true;
+                plan->steps[i] = a;
+                plan->steps[i].coef[i] = 0;
+            }
+
+            Affine l = symbolic(plan->test->getLHS(), slots, testEnv, &plan->testNodes);
+            Affine r = symbolic(plan->test->getRHS(), slots, testEnv, &plan->testNodes);
+            plan->diff = combine(l, r, -1);
+
+            bool provable = plan->diff.ok;
+            for (const Affine &node : plan->testNodes) {
+                if (!node.ok) provable = false;
+                else for (int i = 0; i < n; ++i) {
+                    if (node.coef[i] != 0 && !usable[i]) provable = false;
+                }
+            }
+            plan->closedForm = provable;
+        }
+    }
+
+    loops[head] = std::move(plan);
+}
+
+// Execute loop iterations for the loop starting at `line`
+bool LoopAnalyzer::tryAccelerate(int line, EvalState &state) {
+    auto it = loops.find(line);
+    if (it == loops.end()) return false;
+    LoopPlan &plan = *it->second;
+    int n = (int)plan.names.size();
+
+    // Every variable read before it is assigned must already exist
+    for (int slot : plan.exposed) {
+        if (!state.isDefined(plan.names[slot])) return false;
+    }
+
+    std::vector<int> vals(n, 0);
+    for (int i = 0; i < n; ++i) {
+        if (state.isDefined(plan.names[i])) vals[i] = state.getValue(plan.names[i]);
+    }
+
+    long long bodyRuns = 0, testsTrue = 0, testsFalse = 0;
+    bool exited = false;
+    bool solved = false;
+
+    // ---- closed form ----
+    if (plan.closedForm) {
+        std::vector<long long> x(vals.begin(), vals.end());
+        std::vector<long long> stepVal(n, 0);
+        bool ok = true;
+        for (int i = 0; i < n && ok; ++i) ok = plan.steps[i].eval(x, stepVal[i]);
+
+        // value(t) = base + t * slope for the t-th evaluation of the test
+        auto progression = [&](const Affine &a, long long &base, long long &slope) {
+            if (!a.eval(x, base)) return false;
+            slope = 0;
+            for (int i = 0; i < n; ++i) {
+                long long term;
+                if (!mulChecked(a.coef[i], stepVal[i], term) || !addChecked(slope, term, slope))
+                    return false;
+            }
+            return true;
+        };
+
+        long long base = 0, slope = 0, t = -1;
+        if (ok && progression(plan.diff, base, slope)) {
+            t = firstIndex(base, slope, plan.test->getOperator(), plan.testAtHead);
+        }
+
+        // t is the index of the deciding test; all earlier ones went the other way
+        if (t >= 0 && t < INT_MAX / 2) {
+            for (const Affine &node : plan.testNodes) {
+                long long b, s, end;
+                if (!progression(node, b, s) || !mulChecked(t, s, end) || !addChecked(b, end, end)
+                    || !fitsInt(b) || !fitsInt(end)) {
+                    ok = false;
+                    break;
+                }
+            }
+
+            if (ok) {
+                bodyRuns = plan.testAtHead ? t : t + 1;
+                testsTrue = plan.testAtHead ? 1 : t;
+                testsFalse = plan.testAtHead ? t : 1;
+                exited = true;
+                solved = true;
+
+                // x_k = M^k * x_0 over wrapping 32-bit arithmetic
+                Matrix m(n + 1, std::vector<uint32_t>(n + 1, 0));
+                for (int i = 0; i < n; ++i) {
+                    for (int j = 0; j < n; ++j) m[i][j] = (uint32_t)plan.after[i].coef[j];
+                    m[i][n] = (uint32_t)plan.after[i].c;
+                }
+                m[n][n] = 1;
+                Matrix mk = power(m, bodyRuns);
+                std::vector<int> result(n);
+                for (int i = 0; i < n; ++i) {
+                    uint32_t acc = mk[i][n];
+                    for (int j = 0; j < n; ++j) acc += mk[i][j] * (uint32_t)vals[j];
+                    result[i] = (int)acc;
+                }
+                vals = result;
+            }
+        }
+    }
+
+    // ---- batch execution ----
+    if (!solved) {
+        std::vector<int> entry = vals;
+        std::vector<int> stack(plan.stackDepth + 1);
+        int cond = 0, ignored = 0;
+        long long iterations = 0;
+        bool failed = false;
+
+        while (iterations < BATCH_LIMIT) {
+            if (plan.testAtHead) {
+                if (!runCode(plan.testCode, vals.data(), stack.data(), cond)) { failed = true; break; }
+                if (cond) { exited = true; break; }
+                if (!runCode(plan.bodyCode, vals.data(), stack.data(), ignored)) { failed = true; break; }
+            } else {
+                if (!runCode(plan.bodyCode, vals.data(), stack.data(), ignored)
+                    || !runCode(plan.testCode, vals.data(), stack.data(), cond)) { failed = true; break; }
+                if (!cond) { exited = true; ++iterations; break; }
+            }
+            ++iterations;
+        }
+
+        if (failed) {
+            // Replay only the iterations that completed; the interpreter then
+            // runs the failing one and reports the error itself
+            if (iterations == 0) return false;
+            vals = entry;
+            for (long long i = 0; i < iterations; ++i) {
+                if (plan.testAtHead) runCode(plan.testCode, vals.data(), stack.data(), cond);
+                runCode(plan.bodyCode, vals.data(), stack.data(), ignored);
+                if (!plan.testAtHead) runCode(plan.testCode, vals.data(), stack.data(), cond);
+            }
+            exited = false;
+        }
+
+        if (plan.testAtHead) {
+            bodyRuns = iterations;
+            testsFalse = iterations;
+            testsTrue = exited ? 1 : 0;
+        } else {
+            bodyRuns = iterations;
+            testsTrue = exited ? iterations - 1 : iterations;
+            testsFalse = exited ? 1 : 0;
+        }
+    }
+
+    // ---- commit ----
+    if (bodyRuns > 0) {
+        for (int slot : plan.written) state.setValue(plan.names[slot], vals[slot]);
+    }
+    RuntimeStats *rs = state.getRuntimeStats();
+    if (rs) {
+        for (int bodyLine : plan.body) rs->lineCounters[bodyLine].execCount += (int)bodyRuns;
+        LineCounters &test = rs->lineCounters[plan.testLine];
+        test.execCount += (int)(testsTrue + testsFalse);
+        test.thenCount += (int)testsTrue;
+        test.ifCount += (int)testsFalse;
+
+        for (const auto &u : plan.bodyUses)
+            rs->identifierUseCount[u.first] += (int)(u.second * bodyRuns);
+        for (const auto &u : plan.testUses)
+            rs->identifierUseCount[u.first] += (int)(u.second * (testsTrue + testsFalse));
+    }
+
+    state.setNextLine(exited ? plan.exitLine : plan.head);
+    return true;
+}
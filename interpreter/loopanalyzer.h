@@ -0,0 +1,75 @@
+/**
+ * @file    loopanalyzer.h
+ * @brief   Recognizes simple counting loops built from IF/GOTO and executes
+ *          them without going through Statement::execute() per iteration
+ *
+ *          A loop qualifies when its body consists only of LET/REM lines and
+ *          it is closed by one of the two IF/GOTO shapes:
+ *
+ *            test at end               test at head
+ *            20 LET S = S + I          20 IF I > N THEN 60
+ *            30 LET I = I + 1          30 LET S = S + I
+ *            40 IF I < N THEN 20       40 LET I = I + 1
+ *                                      50 GOTO 20
+ *
+ *          If every assignment is affine and the exit test only depends on
+ *          induction variables, the trip count and the final state are
+ *          computed in closed form. Otherwise the loop body runs as a compiled
+ *          batch over a flat variable array. Whenever something cannot be
+ *          proven (undefined variable, possible DIVIDE BY ZERO, overflow in
+ *          the exit test) the loop is handed back to the normal interpreter,
+ *          which then produces exactly the same behavior as before.
+ *
+ *          Execution counters, branch counters and identifier use counts are
+ *          credited as if every iteration had run.
+ *
+ * @author  simple_wind
+ * @version 1.0
+ * @date    2025-12-08
+ * */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <set>
+
+#include "../core/program.h"
+#include "../runtime/evalstate.h"
+
+struct LoopPlan;
+
+class LoopAnalyzer {
+public:
+    // Analyze every loop of the program
+    explicit LoopAnalyzer(const Program &program);
+    ~LoopAnalyzer();
+
+    // Try to run the loop whose first line is `line`
+    // Returns: true if iterations were executed and state.getNextLine() now
+    //          holds the line to continue at, false if the caller must execute
+    //          the statement normally (nothing was changed in that case)
+    bool tryAccelerate(int line, EvalState &state);
+
+    // Check whether a loop starts at the given line
+    bool hasLoopAt(int line) const;
+
+    // Check whether the loop at the given line has a closed-form solution
+    bool isClosedForm(int line) const;
+
+    // Forget the loops running over any of these lines, so each of them is
+    // reached statement by statement
+    void excludeLines(const std::set<int> &lines);
+
+    // Number of recognized loops
+    int loopCount() const { return (int)loops.size(); }
+
+    // Maximum iterations executed by one batch call before control goes back
+    // to the interpreter (keeps non-terminating loops interruptible)
+    static const long long BATCH_LIMIT = 1 << 20;
+
+private:
+    std::map<int, std::unique_ptr<LoopPlan>> loops;  // first line -> loop plan
+
+    void analyze(const Program &program, int head, int tail);
+};
@@ -0,0 +1,124 @@
+#include "replsession.h"
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+namespace {
+
+const char *HELP_TEXT =
+    "Commands:\n"
+    "  <line> <statement>   add or replace a program line\n"
+    "  <line>               delete a program line\n"
+    "  RUN                  run the program (lines typed while it runs are INPUT)\n"
+    "  LIST                 show the program\n"
+    "  CLEAR                delete the program\n"
+    "  QUIT                 close the session\n"
+    "Statements: REM, LET, PRINT, INPUT, GOTO, IF ... THEN, END\n";
+
+std::string trim(const std::string &s) {
+    size_t begin = s.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(begin, end - begin + 1);
+}
+
+} // namespace
+
+ReplSession::ReplSession() {
+    interpreter.setOutputConsumer([this](std::string_view text) { output += text; });
+}
+
+std::string ReplSession::takeOutput() {
+    std::string text;
+    text.swap(output);
+    return text;
+}
+
+void ReplSession::handleLine(const std::string &raw) {
+    std::string line = trim(raw);
+
+    // A running program reads everything as INPUT
+    if (running) {
+        interpreter.supplyInput(line);
+        waitingForInput = false;
+        return;
+    }
+
+    if (line.empty()) return;
+    if (std::isdigit((unsigned char)line[0])) {
+        programLine(line);
+        return;
+    }
+
+    std::string upper = line;
+    std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char c) { return std::toupper(c); });
+    command(upper);
+}
+
+void ReplSession::command(const std::string &upper) {
+    if (upper == "RUN") start();
+    else if (upper == "LIST") output += program.getDisplayText();
+    else if (upper == "CLEAR") program.clear();
+    else if (upper == "HELP") output += HELP_TEXT;
+    else if (upper == "QUIT") quit = true;
+    else output += "Unknown command: " + upper + "\n";
+}
+
+// Same split as MainWindow::runParser: line number, then the statement
+void ReplSession::programLine(const std::string &line) {
+    std::stringstream ss(line);
+    int lineNumber;
+    ss >> lineNumber;
+    if (ss.fail()) {
+        output += "Invalid line number\n";
+        return;
+    }
+
+    std::string code;
+    std::getline(ss, code);
+    code = trim(code);
+    if (code.empty()) {
+        program.removeSourceLine(lineNumber);
+        return;
+    }
+
+    program.addSourceLine(lineNumber, code);
+    try {
+        Statement *stmt = parser.parseLine(lineNumber, code);
+        if (!stmt) output += "Syntax Error: cannot parse line " + std::to_string(lineNumber) + "\n";
+        program.setParsedStatement(lineNumber, stmt);
+    } catch (const std::exception &e) {
+        output += "Syntax Error: " + std::string(e.what()) + "\n";
+    }
+}
+
+void ReplSession::start() {
+    interpreter.reset();
+    interpreter.setOutputConsumer([this](std::string_view text) { output += text; });
+    running = true;
+    waitingForInput = false;
+    used = 0;
+}
+
+void ReplSession::runSlice(long long slice) {
+    if (!runnable()) return;
+    if (quota > 0) slice = std::min(slice, quota - used);
+
+    try {
+        RunStatus status = interpreter.runUntilBlocked(program, slice);
+        used += interpreter.lastSliceStatements();
+        if (status == RunStatus::Finished) {
+            running = false;
+        } else if (status == RunStatus::NeedsInput) {
+            waitingForInput = true;
+            output += "? ";
+        } else if (quota > 0 && used >= quota) {
+            running = false;
+            interpreter.reset();
+            output += "Runtime Error: CPU QUOTA EXCEEDED\n";
+        }
+    } catch (const std::exception &e) {
+        running = false;
+        output += "Runtime Error: " + std::string(e.what()) + "\n";
+    }
+}
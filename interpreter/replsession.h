@@ -0,0 +1,63 @@
+/**
+ * @file    replsession.h
+ * @brief   One interactive BASIC session without the GUI (used by the server)
+ *
+ *          A session owns its Program, Parser and Interpreter and accepts
+ *          the commands of the GUI command line: "<line> <statement>" adds or
+ *          replaces a line, "<line>" alone deletes it, and RUN, LIST, CLEAR,
+ *          HELP and QUIT. While a program runs, every line received is INPUT
+ *          for it. Programs run in slices (see runSlice) so that one thread
+ *          can serve many sessions; output is collected until taken.
+ *
+ * @author  simple_wind
+ * @version 1.0
+ * @date    2025-12-14
+ * */
+
+#pragma once
+
+#include <string>
+
+#include "interpreter.h"
+#include "parser.h"
+
+class ReplSession {
+public:
+    ReplSession();
+
+    // Handle one line from the client (without the line break)
+    void handleLine(const std::string &line);
+
+    // Continue the running program for at most `slice` statements
+    void runSlice(long long slice);
+
+    // A program is running and can continue without more input
+    bool runnable() const { return running && !waitingForInput; }
+
+    // A program is running and waits for an INPUT line
+    bool needsInput() const { return running && waitingForInput; }
+
+    // QUIT was received
+    bool closed() const { return quit; }
+
+    // Statements one RUN may execute before it is stopped (0 = unlimited)
+    void setStatementQuota(long long statements) { quota = statements; }
+
+    // Text for the client produced since the last call
+    std::string takeOutput();
+
+private:
+    Program program;
+    Parser parser;
+    Interpreter interpreter;
+    std::string output;
+    bool running = false;
+    bool waitingForInput = false;
+    bool quit = false;
+    long long quota = 0;
+    long long used = 0;         // statements of the current RUN
+
+    void command(const std::string &upper);
+    void programLine(const std::string &line);
+    void start();
+};
@@ -0,0 +1,51 @@
+/**
+ * @file    runlimits.h
+ * @brief   Resource limits a host can put on one run, and the errors raised
+ *          when a run exceeds them (see Interpreter::setRunLimits)
+ *
+ *          Fuel is measured in statements the same way the execution counters
+ *          count them (END is free), so the fuel a run consumed is the growth
+ *          of the sum of execCount over all lines.
+ *
+ * @author  simple_wind
+ * @version 1.1
+ * @date    2025-12-14
+ * */
+
+#pragma once
+
+#include <stdexcept>
+#include <string>
+
+// Limits of one run; 0 means unlimited
+struct RunLimits {
+    long long fuel = 0;         // statements the run may execute
+    double seconds = 0;         // wall-clock time
+    long long maxOutput = 0;    // bytes of output (PRINT and INPUT messages)
+
+    bool any() const { return fuel > 0 || seconds > 0 || maxOutput > 0; }
+};
+
+// Base of the errors raised when a run exceeds one of its limits
+class ResourceLimitError : public std::runtime_error {
+public:
+    explicit ResourceLimitError(const std::string &message) : std::runtime_error(message) {}
+};
+
+// Thrown when a run takes longer than its time limit
+class TimeLimitError : public ResourceLimitError {
+public:
+    TimeLimitError() : ResourceLimitError("TIME LIMIT EXCEEDED") {}
+};
+
+// Thrown before the statement that would exceed the fuel limit
+class FuelExhaustedError : public ResourceLimitError {
+public:
+    FuelExhaustedError() : ResourceLimitError("FUEL EXHAUSTED") {}
+};
+
+// Thrown instead of writing output that would exceed the output limit
+class OutputLimitError : public ResourceLimitError {
+public:
+    OutputLimitError() : ResourceLimitError("OUTPUT LIMIT EXCEEDED") {}
+};
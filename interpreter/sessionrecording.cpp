@@ -0,0 +1,129 @@
+#include "sessionrecording.h"
+
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+const char *MAGIC = "QBREPLAY 1";
+
+std::string escapeLine(const std::string &text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '\\') out += "\\\\";
+        else if (c == '\n') out += "\\n";
+        else if (c == '\r') out += "\\r";
+        else out += c;
+    }
+    return out;
+}
+
+std::string unescapeLine(const std::string &text) {
+    std::string out;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] != '\\' || i + 1 == text.size()) {
+            out += text[i];
+            continue;
+        }
+        char c = text[++i];
+        out += c == 'n' ? '\n' : c == 'r' ? '\r' : c;
+    }
+    return out;
+}
+
+// Next line of the file, without a trailing '\r'
+std::string readLine(std::istream &in) {
+    std::string line;
+    if (!std::getline(in, line)) throw std::runtime_error("truncated replay file");
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    return line;
+}
+
+// Text after "<key> " on a line starting with the key
+std::string field(const std::string &line, const std::string &key) {
+    if (line.compare(0, key.size(), key) != 0) throw std::runtime_error("truncated replay file");
+    return line.size() > key.size() ? line.substr(key.size() + 1) : "";
+}
+
+} // namespace
+
+// ============ SessionRecording Implementation ============
+
+void SessionRecording::begin(const Program &program) {
+    source = programSource(program);
+    inputs.clear();
+    outputBytes = 0;
+    outputHash = OUTPUT_HASH_START;
+    error.clear();
+}
+
+std::function<std::string()> SessionRecording::recordInput(std::function<std::string()> provider) {
+    return [this, provider]() -> std::string {
+        std::string line = provider();
+        inputs.push_back(line);
+        return line;
+    };
+}
+
+std::function<void(std::string_view)> SessionRecording::recordOutput(std::function<void(std::string_view)> consumer) {
+    return [this, consumer](std::string_view text) {
+        outputBytes += text.size();
+        hashOutput(outputHash, text);
+        if (consumer) consumer(text);
+        else std::cout << text << std::flush;
+    };
+}
+
+std::string SessionRecording::inputText() const {
+    std::string text;
+    for (const std::string &line : inputs) text += line + "\n";
+    return text;
+}
+
+void SessionRecording::save(std::ostream &out) const {
+    out << MAGIC << "\n";
+    out << "inputs " << inputs.size() << "\n";
+    for (const std::string &line : inputs) out << escapeLine(line) << "\n";
+    out << "output " << outputBytes << " " << outputHash << "\n";
+    out << "error " << escapeLine(error) << "\n";
+    out << "program\n" << source;
+}
+
+SessionRecording SessionRecording::load(std::istream &in) {
+    std::string line;
+    if (!std::getline(in, line)) throw std::runtime_error("not a replay file");
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line != MAGIC) throw std::runtime_error("not a replay file");
+
+    SessionRecording r;
+    try {
+        size_t count = std::stoull(field(readLine(in), "inputs"));
+        for (size_t i = 0; i < count; ++i) r.inputs.push_back(unescapeLine(readLine(in)));
+
+        std::string output = field(readLine(in), "output");
+        size_t used = 0;
+        r.outputBytes = std::stoull(output, &used);
+        r.outputHash = std::stoull(output.substr(used));
+    } catch (const std::logic_error &) {
+        throw std::runtime_error("truncated replay file");     // stoull: missing or bad number
+    }
+    r.error = unescapeLine(field(readLine(in), "error"));
+    if (readLine(in) != "program") throw std::runtime_error("truncated replay file");
+
+    while (std::getline(in, line)) r.source += line + "\n";
+    return r;
+}
+
+std::string programSource(const Program &program) {
+    std::string text;
+    for (int line = program.getFirstLineNumber(); line != -1; line = program.getNextLineNumber(line))
+        text += std::to_string(line) + " " + program.getSourceLine(line) + "\n";
+    return text;
+}
+
+void hashOutput(uint64_t &hash, std::string_view text) {
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 0x100000001B3ull;
+    }
+}
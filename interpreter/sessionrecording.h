@@ -0,0 +1,75 @@
+/**
+ * @file    sessionrecording.h
+ * @brief   Record an interactive run once, replay it without the GUI
+ *
+ *          A run depends on nothing but its program and the lines INPUT
+ *          reads (integer arithmetic, no clock, no random numbers), so a
+ *          SessionRecording holds exactly these: the program source and
+ *          every line the input provider returned, in order (including
+ *          empty lines from a cancelled dialog and invalid numbers, which
+ *          INPUT reads again). The outcome is kept as well, the output as a
+ *          size and a hash plus the error message, so a replay can tell
+ *          whether it reproduced the run (see runReplay in batchrunner.h).
+ *
+ *          Recording files are text:
+ *
+ *            QBREPLAY 1
+ *            inputs <n>
+ *            <n input lines, "\" and newlines escaped>
+ *            output <bytes> <hash>
+ *            error <message, empty if the run succeeded>
+ *            program
+ *            <source lines, as loadProgramText reads them>
+ *
+ * @author  simple_wind
+ * @version 1.0
+ * @date    2025-12-17
+ * */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../core/program.h"
+
+// Hash of no output (see hashOutput)
+const uint64_t OUTPUT_HASH_START = 0xCBF29CE484222325ull;
+
+struct SessionRecording {
+    std::string source;                 // "<line> <statement>" per line
+    std::vector<std::string> inputs;    // lines returned to INPUT, in order
+    uint64_t outputBytes = 0;
+    uint64_t outputHash = OUTPUT_HASH_START;    // see hashOutput
+    std::string error;                  // what the run threw, empty if it succeeded
+
+    // Start a new recording of `program`: source copied, outcome cleared
+    void begin(const Program &program);
+
+    // Input provider that returns what `provider` returns and records it
+    // (the recording must outlive the provider)
+    std::function<std::string()> recordInput(std::function<std::string()> provider);
+
+    // Output consumer that records and forwards to `consumer`, or to
+    // std::cout when there is none (as PRINT does without a consumer)
+    std::function<void(std::string_view)> recordOutput(std::function<void(std::string_view)> consumer);
+
+    // All inputs as one text, a line each (the input of a batch job)
+    std::string inputText() const;
+
+    // Throws std::runtime_error("not a replay file") or ("truncated replay
+    // file") if the stream does not hold a recording
+    void save(std::ostream &out) const;
+    static SessionRecording load(std::istream &in);
+};
+
+// Source text of a program, one "<line> <statement>" line per source line
+std::string programSource(const Program &program);
+
+// Running FNV-1a hash of printed text (start with OUTPUT_HASH_START)
+void hashOutput(uint64_t &hash, std::string_view text);
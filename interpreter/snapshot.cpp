@@ -0,0 +1,132 @@
+#include "snapshot.h"
+#include "sessionrecording.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+const char MAGIC[8] = {'Q', 'B', 'S', 'N', 'A', 'P', '1', '\0'};
+
+uint64_t zigzag(int64_t v) { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+int64_t unzigzag(uint64_t v) { return (int64_t)(v >> 1) ^ -(int64_t)(v & 1); }
+
+void putVarint(std::ostream &out, uint64_t v) {
+    while (v >= 0x80) {
+        out.put((char)(v | 0x80));
+        v >>= 7;
+    }
+    out.put((char)v);
+}
+
+void putSigned(std::ostream &out, int64_t v) { putVarint(out, zigzag(v)); }
+
+void putString(std::ostream &out, const std::string &s) {
+    putVarint(out, s.size());
+    out.write(s.data(), (std::streamsize)s.size());
+}
+
+uint64_t getVarint(std::istream &in) {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = in.get();
+        if (c == EOF) throw std::runtime_error("truncated snapshot file");
+        v |= (uint64_t)(c & 0x7F) << shift;
+        if (!(c & 0x80)) return v;
+    }
+    throw std::runtime_error("truncated snapshot file");
+}
+
+int getInt(std::istream &in) { return (int)unzigzag(getVarint(in)); }
+
+std::string getString(std::istream &in) {
+    uint64_t size = getVarint(in);
+    std::string s;
+    // Read in pieces: a corrupt length must not allocate gigabytes up front
+    char piece[4096];
+    while (size > 0) {
+        std::streamsize n = (std::streamsize)std::min<uint64_t>(size, sizeof piece);
+        if (!in.read(piece, n)) throw std::runtime_error("truncated snapshot file");
+        s.append(piece, (size_t)n);
+        size -= (uint64_t)n;
+    }
+    return s;
+}
+
+} // namespace
+
+// ============ ExecutionSnapshot Implementation ============
+
+void ExecutionSnapshot::save(std::ostream &out) const {
+    out.write(MAGIC, sizeof MAGIC);
+    putVarint(out, programHash);
+    putSigned(out, nextLine);
+    putSigned(out, currentLine);
+    putVarint(out, (ended ? 1 : 0) | (suspended ? 2 : 0));
+
+    putVarint(out, variables.size());
+    for (const auto &entry : variables) {
+        putString(out, entry.first);
+        putSigned(out, entry.second);
+    }
+
+    putVarint(out, stats.identifierUseCount.size());
+    for (const auto &entry : stats.identifierUseCount) {
+        putString(out, entry.first);
+        putSigned(out, entry.second);
+    }
+
+    putVarint(out, stats.lineCounters.size());
+    int previous = 0;
+    for (const auto &entry : stats.lineCounters) {
+        putSigned(out, (int64_t)entry.first - previous);
+        previous = entry.first;
+        putSigned(out, entry.second.execCount);
+        putSigned(out, entry.second.ifCount);
+        putSigned(out, entry.second.thenCount);
+    }
+
+    putVarint(out, pendingInput.size());
+    for (const std::string &line : pendingInput) putString(out, line);
+}
+
+ExecutionSnapshot ExecutionSnapshot::load(std::istream &in) {
+    char magic[sizeof MAGIC];
+    if (!in.read(magic, sizeof magic) || !std::equal(magic, magic + sizeof magic, MAGIC))
+        throw std::runtime_error("not a snapshot file");
+
+    ExecutionSnapshot s;
+    s.programHash = getVarint(in);
+    s.nextLine = getInt(in);
+    s.currentLine = getInt(in);
+    uint64_t flags = getVarint(in);
+    s.ended = flags & 1;
+    s.suspended = flags & 2;
+
+    for (uint64_t n = getVarint(in); n > 0; --n) {
+        std::string name = getString(in);
+        s.variables[name] = getInt(in);
+    }
+
+    for (uint64_t n = getVarint(in); n > 0; --n) {
+        std::string name = getString(in);
+        s.stats.identifierUseCount[name] = getInt(in);
+    }
+
+    int line = 0;
+    for (uint64_t n = getVarint(in); n > 0; --n) {
+        line += getInt(in);
+        LineCounters &c = s.stats.lineCounters[line];
+        c.execCount = getInt(in);
+        c.ifCount = getInt(in);
+        c.thenCount = getInt(in);
+    }
+
+    for (uint64_t n = getVarint(in); n > 0; --n) s.pendingInput.push_back(getString(in));
+    return s;
+}
+
+uint64_t programFingerprint(const Program &program) {
+    uint64_t hash = OUTPUT_HASH_START;      // same FNV-1a as recorded output
+    hashOutput(hash, programSource(program));
+    return hash;
+}
@@ -0,0 +1,57 @@
+/**
+ * @file    snapshot.h
+ * @brief   Checkpoint of a paused run: restore it later or many times
+ *
+ *          An ExecutionSnapshot holds everything a run has done so far:
+ *          program counter (next and current line, END flag), variables,
+ *          identifier counts and line counters, and the INPUT lines queued
+ *          with supplyInput that were not read yet. Restoring it into any
+ *          Interpreter (see Interpreter::snapshot and restore) continues the
+ *          run exactly where it was taken, so a long initialization is run
+ *          once and then forked by restoring the same snapshot into as many
+ *          interpreters as needed. There is no GOSUB in this BASIC, hence no
+ *          return stack to keep.
+ *
+ *          A snapshot is tied to its program by a hash of the source text;
+ *          restoring it with another program is refused.
+ *
+ *          Snapshot files are binary: "QBSNAP1" and a zero byte, then
+ *          varints (signed values zigzag encoded) and length-prefixed
+ *          strings, in the order of the fields below. Line counters are
+ *          stored with delta-encoded line numbers.
+ *
+ * @author  simple_wind
+ * @version 1.0
+ * @date    2025-12-18
+ * */
+
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "../core/program.h"
+#include "../runtime/evalstate.h"
+
+struct ExecutionSnapshot {
+    uint64_t programHash = 0;           // see programFingerprint
+    int nextLine = -1;                  // line the run continues at
+    int currentLine = -1;
+    bool ended = false;                 // END was executed
+    bool suspended = false;             // a resumable run was in progress
+    std::map<std::string, int> variables;
+    RuntimeStats stats;
+    std::vector<std::string> pendingInput;
+
+    // Throws std::runtime_error("not a snapshot file") or ("truncated
+    // snapshot file") if the stream does not hold a snapshot
+    void save(std::ostream &out) const;
+    static ExecutionSnapshot load(std::istream &in);
+};
+
+// Hash of a program's source lines (line numbers and text)
+uint64_t programFingerprint(const Program &program);
@@ -0,0 +1,401 @@
+#include "spmd.h"
+#include "spmdexec.h"
+#include "runlimits.h"
+#include "../core/statement.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+// ============ Compilation ============
+
+SpmdEngine::SpmdEngine(const Program &program) {
+    compile(program);
+}
+
+int SpmdEngine::message(const std::string &text) {
+    auto it = std::find(messages.begin(), messages.end(), text);
+    if (it != messages.end()) return (int)(it - messages.begin());
+    messages.push_back(text);
+    return (int)messages.size() - 1;
+}
+
+// Register every variable and constant used by an expression
+void SpmdEngine::collect(Expression *exp) {
+    switch (exp->type()) {
+    case CONSTANT:
+        constantRegs[exp->getConstantValue()] = 0;
+        break;
+    case IDENTIFIER:
+        variableRegs.emplace(exp->getIdentifierName(), (int)variableRegs.size());
+        break;
+    case COMPOUND:
+        collect(exp->getLHS());
+        collect(exp->getRHS());
+        break;
+    }
+}
+
+// Line index control reaches after an IF/GOTO is taken, -1 if the target is
+// missing (a jump to the own line continues with the next line)
+int SpmdEngine::jumpTarget(int i) const {
+    int target = lines[i]->getTargetLine();
+    if (target == lineNumbers[i]) return i + 1 < (int)lines.size() ? i + 1 : -1;
+    auto it = lineIndex.find(target);
+    return it == lineIndex.end() ? -1 : it->second;
+}
+
+std::vector<int> SpmdEngine::successors(int i) const {
+    std::vector<int> next;
+    bool fallsThrough = true;
+    if (Statement *stmt = lines[i]) {
+        StatementType t = stmt->type();
+        if (t == StatementType::END) fallsThrough = false;
+        if (t == StatementType::GOTO || t == StatementType::IF) {
+            int target = jumpTarget(i);
+            if (target != -1) next.push_back(target);
+            if (t == StatementType::GOTO) fallsThrough = false;
+        }
+    }
+    if (fallsThrough && i + 1 < (int)lines.size()) next.push_back(i + 1);
+    return next;
+}
+
+// Variables assigned on every path into each line (same forward
+// must-analysis as RegisterVM; unreached lines keep "everything defined")
+std::vector<std::vector<uint8_t>> SpmdEngine::definedOnEntry() const {
+    int n = (int)lines.size();
+    std::vector<std::vector<uint8_t>> in(n, std::vector<uint8_t>(variableCount, 1));
+    std::vector<uint8_t> pending(n, 0);
+    std::vector<int> work;
+    if (n > 0) {
+        std::fill(in[0].begin(), in[0].end(), 0);
+        pending[0] = 1;
+        work.push_back(0);
+    }
+    while (!work.empty()) {
+        int i = work.back();
+        work.pop_back();
+        pending[i] = 0;
+
+        std::vector<uint8_t> out = in[i];
+        Statement *stmt = lines[i];
+        if (stmt && (stmt->type() == StatementType::LET || stmt->type() == StatementType::INPUT))
+            out[variableRegs.at(stmt->getVariableName())] = 1;
+
+        for (int s : successors(i)) {
+            bool changed = false;
+            for (int v = 0; v < variableCount; ++v) {
+                if (in[s][v] && !out[v]) {
+                    in[s][v] = 0;
+                    changed = true;
+                }
+            }
+            if (changed && !pending[s]) {
+                pending[s] = 1;
+                work.push_back(s);
+            }
+        }
+    }
+    return in;
+}
+
+// Compile one expression in evaluation order; returns the register holding
+// its value. `checked` marks variables known to be defined at this point
+int SpmdEngine::expression(Expression *exp, std::vector<uint8_t> &checked, int &temps) {
+    switch (exp->type()) {
+    case CONSTANT:
+        return constantRegs.at(exp->getConstantValue());
+    case IDENTIFIER: {
+        std::string name = exp->getIdentifierName();
+        int reg = variableRegs.at(name);
+        if (!checked[reg]) {
+            code.push_back({LaneOp::CHKDEF, reg, 0, message("VARIABLE NOT DEFINED: " + name)});
+            checked[reg] = 1;
+        }
+        return reg;
+    }
+    case COMPOUND:
+        break;
+    }
+
+    int l = expression(exp->getLHS(), checked, temps);
+    int r = expression(exp->getRHS(), checked, temps);
+    std::string op = exp->getOperator();
+    int dst = tempBase + temps++;
+    if (op == "+") code.push_back({LaneOp::ADD, dst, l, r});
+    else if (op == "-") code.push_back({LaneOp::SUB, dst, l, r});
+    else if (op == "*") code.push_back({LaneOp::MUL, dst, l, r});
+    else if (op == "/") code.push_back({LaneOp::DIV, dst, l, r});
+    else if (op == "MOD") code.push_back({LaneOp::MOD, dst, l, r});
+    else if (op == "**") code.push_back({LaneOp::POW, dst, l, r});
+    else code.push_back({LaneOp::BADOP, dst, 0, message("UNKNOWN OPERATOR: " + op)});
+    return dst;
+}
+
+void SpmdEngine::compile(const Program &program) {
+    message("DIVIDE BY ZERO");
+    message("Goto none-exsiting line");
+    message("END OF INPUT");
+
+    for (int line = program.getFirstLineNumber(); line != -1; line = program.getNextLineNumber(line)) {
+        lineIndex[line] = (int)lines.size();
+        lines.push_back(program.getParsedStatement(line));
+        lineNumbers.push_back(line);
+    }
+
+    // Register file: variables, then constants, then temporaries
+    for (Statement *stmt : lines) {
+        if (!stmt) continue;
+        switch (stmt->type()) {
+        case StatementType::LET:
+        case StatementType::INPUT:
+            variableRegs.emplace(stmt->getVariableName(), (int)variableRegs.size());
+            if (stmt->type() == StatementType::LET) collect(stmt->getExpression());
+            break;
+        case StatementType::PRINT:
+            collect(stmt->getExpression());
+            break;
+        case StatementType::IF:
+            collect(stmt->getLHS());
+            collect(stmt->getRHS());
+            break;
+        default:
+            break;
+        }
+    }
+    variableCount = (int)variableRegs.size();
+    for (auto &c : constantRegs) {
+        c.second = variableCount + (int)constants.size();
+        constants.push_back(c.first);
+    }
+    tempBase = variableCount + (int)constants.size();
+
+    int n = (int)lines.size();
+    std::vector<std::vector<uint8_t>> known = definedOnEntry();
+    int maxTemps = 0;
+    for (int i = 0; i < n; ++i) {
+        int start = (int)code.size();
+        lineStart.push_back(start);
+        countOnEntry.push_back(0);
+        int next = i + 1 < n ? i + 1 : -1;
+        Statement *stmt = lines[i];
+        if (!stmt) {
+            code.push_back({LaneOp::NEXT, 0, 0, next});
+            continue;
+        }
+
+        // Statements count themselves before anything can fail, except IF
+        StatementType type = stmt->type();
+        if (type != StatementType::IF && type != StatementType::END) countOnEntry[i] = 1;
+
+        std::vector<uint8_t> &checked = known[i];
+        int temps = 0;
+        switch (type) {
+        case StatementType::REM:
+            code.push_back({LaneOp::NEXT, 0, 0, next});
+            break;
+        case StatementType::LET: {
+            int var = variableRegs.at(stmt->getVariableName());
+            int value = expression(stmt->getExpression(), checked, temps);
+            // The top operator writes straight into the variable
+            LaneInstr *top = (int)code.size() > start ? &code.back() : nullptr;
+            if (top && top->a == value && value >= tempBase
+                && (top->op == LaneOp::ADD || top->op == LaneOp::SUB || top->op == LaneOp::MUL)) {
+                top->op = top->op == LaneOp::ADD ? LaneOp::LETADD
+                        : top->op == LaneOp::SUB ? LaneOp::LETSUB : LaneOp::LETMUL;
+                top->a = var;
+            } else {
+                code.push_back({LaneOp::STORE, var, value, 0});
+            }
+            code.push_back({LaneOp::NEXT, 0, 0, next});
+            break;
+        }
+        case StatementType::PRINT: {
+            int value = expression(stmt->getExpression(), checked, temps);
+            code.push_back({LaneOp::PRINT, value, 0, 0});
+            code.push_back({LaneOp::NEXT, 0, 0, next});
+            break;
+        }
+        case StatementType::INPUT:
+            code.push_back({LaneOp::INPUT, variableRegs.at(stmt->getVariableName()), 0, 0});
+            code.push_back({LaneOp::NEXT, 0, 0, next});
+            break;
+        case StatementType::GOTO:
+            code.push_back({LaneOp::JMP, 0, 0, jumpTarget(i)});
+            break;
+        case StatementType::IF: {
+            int l = expression(stmt->getLHS(), checked, temps);
+            int r = expression(stmt->getRHS(), checked, temps);
+            // IfStmt::execute counts the line once both sides evaluated: on
+            // entry is the same unless evaluating them can fail
+            bool canFail = false;
+            for (size_t pc = start; pc < code.size(); ++pc) {
+                LaneOp op = code[pc].op;
+                if (op == LaneOp::CHKDEF || op == LaneOp::DIV || op == LaneOp::BADOP) canFail = true;
+            }
+            if (canFail) code.push_back({LaneOp::COUNT, 0, 0, 0});
+            else countOnEntry[i] = 1;
+            // Other relational operators are never true in IfStmt::execute
+            std::string op = stmt->getOperator();
+            if (op == "=") code.push_back({LaneOp::JEQ, l, r, jumpTarget(i)});
+            else if (op == "<") code.push_back({LaneOp::JLT, l, r, jumpTarget(i)});
+            else if (op == ">") code.push_back({LaneOp::JGT, l, r, jumpTarget(i)});
+            code.push_back({LaneOp::NEXT, 0, 0, next});
+            break;
+        }
+        case StatementType::END:
+            code.push_back({LaneOp::END, 0, 0, 0});
+            break;
+        }
+        maxTemps = std::max(maxTemps, temps);
+    }
+    registerCount = tempBase + maxTemps;
+}
+
+// ============ Execution ============
+
+void SpmdEngine::setDeadline(std::chrono::steady_clock::time_point when) {
+    hasDeadline = true;
+    deadline = when;
+}
+
+bool SpmdEngine::avx2Supported() {
+    if (!spmdAvx2Built()) return false;
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    return osSavesYmm && (info[1] & (1 << 5));
+#else
+    return false;
+#endif
+}
+
+bool SpmdEngine::vectorActive() const {
+    return vectorEnabled && avx2Supported();
+}
+
+double SpmdEngine::occupancy() const {
+    return lineSteps ? (double)laneSteps / ((double)lineSteps * LANES) : 0.0;
+}
+
+std::vector<SpmdLaneResult> SpmdEngine::run(const std::vector<std::vector<std::string>> &inputs) {
+    if (inputs.size() > (size_t)LANES)
+        throw std::invalid_argument("SpmdEngine: more input vectors than lanes");
+
+    int used = (int)inputs.size();
+    regs.assign((size_t)registerCount * LANES, 0);
+    for (size_t c = 0; c < constants.size(); ++c)
+        std::fill_n(regs.begin() + (variableCount + c) * LANES, LANES, constants[c]);
+    defined.assign(variableCount, 0);
+    pcs.assign(LANES, 0);
+    statements.assign(LANES, 0);
+    results.assign(LANES, SpmdLaneResult());
+    inputLines = inputs;
+    inputLines.resize(LANES);
+    inputNext.assign(LANES, 0);
+
+    LaneContext ctx;
+    ctx.engine = this;
+    ctx.code = code.data();
+    ctx.lineStart = lineStart.data();
+    ctx.countOnEntry = countOnEntry.data();
+    ctx.regs = regs.data();
+    ctx.defined = defined.data();
+    ctx.pcs = pcs.data();
+    ctx.statements = statements.data();
+    ctx.shared = 0;
+    ctx.alive = used == 32 ? ~(LaneMask)0 : (((LaneMask)1 << used) - 1);
+    ctx.lineSteps = 0;
+    ctx.laneSteps = 0;
+
+    // Same start as Interpreter::run: an empty program fails
+    if (lines.empty()) SpmdRuntime::fail(ctx, ctx.alive, MSG_MISSING_LINE_ID);
+
+    if (vectorActive()) spmdRunAvx2(ctx);
+    else spmdRunScalar(ctx);
+
+    lineSteps = ctx.lineSteps;
+    laneSteps = ctx.laneSteps;
+    std::vector<SpmdLaneResult> out(results.begin(), results.begin() + used);
+    for (int l = 0; l < used; ++l) out[l].statements = statements[l];
+    return out;
+}
+
+// ============ Slow paths of the executor ============
+
+// A lane that stops takes its share of the statements all lanes ran together
+void SpmdRuntime::fail(LaneContext &ctx, LaneMask lanes, int message) {
+    SpmdEngine &e = *ctx.engine;
+    for (int l = 0; l < LANES; ++l) {
+        if (!hasLane(lanes, l)) continue;
+        e.results[l].status = SpmdLaneResult::Error;
+        e.results[l].message = e.messages[message];
+    }
+    finish(ctx, lanes);
+}
+
+void SpmdRuntime::finish(LaneContext &ctx, LaneMask lanes) {
+    for (int l = 0; l < LANES; ++l) {
+        if (hasLane(lanes, l)) ctx.statements[l] += ctx.shared;
+    }
+    ctx.alive &= ~lanes;
+}
+
+void SpmdRuntime::print(LaneContext &ctx, int reg, LaneMask lanes) {
+    SpmdEngine &e = *ctx.engine;
+    for (int l = 0; l < LANES; ++l) {
+        if (hasLane(lanes, l)) e.results[l].output += std::to_string(ctx.regs[(size_t)reg * LANES + l]) + "\n";
+    }
+}
+
+// Same parsing as InputStmt::execute: retry invalid lines, fail at the end
+LaneMask SpmdRuntime::input(LaneContext &ctx, int var, LaneMask lanes) {
+    SpmdEngine &e = *ctx.engine;
+    LaneMask read = 0;
+    for (int l = 0; l < LANES; ++l) {
+        if (!hasLane(lanes, l)) continue;
+        std::vector<std::string> &in = e.inputLines[l];
+        size_t &next = e.inputNext[l];
+        while (next < in.size()) {
+            try {
+                ctx.regs[(size_t)var * LANES + l] = std::stoi(in[next++]);
+                read |= (LaneMask)1 << l;
+                break;
+            } catch (...) {
+                e.results[l].output += "INVALID NUMBER\n";
+            }
+        }
+    }
+    ctx.defined[var] |= read;
+    if (LaneMask missing = lanes & ~read) fail(ctx, missing, SpmdEngine::MSG_END_OF_INPUT_ID);
+    return read;
+}
+
+void SpmdRuntime::pow(int32_t *dst, const int32_t *base, const int32_t *exponent) {
+    for (int l = 0; l < LANES; ++l) dst[l] = (int32_t)std::pow(base[l], exponent[l]);
+}
+
+bool SpmdRuntime::timeUp(LaneContext &ctx) {
+    SpmdEngine &e = *ctx.engine;
+    if (!e.hasDeadline || std::chrono::steady_clock::now() <= e.deadline) return false;
+    for (int l = 0; l < LANES; ++l) {
+        if (!hasLane(ctx.alive, l)) continue;
+        e.results[l].status = SpmdLaneResult::Timeout;
+        e.results[l].message = TimeLimitError().what();
+    }
+    finish(ctx, ctx.alive);
+    return true;
+}
+
+void spmdRunScalar(LaneContext &ctx) {
+    runLanes<ScalarLanes>(ctx);
+}
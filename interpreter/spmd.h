@@ -0,0 +1,156 @@
+/**
+ * @file    spmd.h
+ * @brief   Runs several instances of one program side by side in vector lanes
+ *
+ *          Every register holds one value per instance ("lane"), so one
+ *          arithmetic instruction does the work of all instances: an AVX2
+ *          operation per 8 lanes when the CPU has it, plain loops otherwise.
+ *
+ *          Each lane keeps its own line counter. Every step runs the lowest
+ *          line some lane is waiting at, for the mask of lanes waiting there.
+ *          Lanes that take different IF branches therefore run separately
+ *          and merge again as soon as they reach the same line; when all
+ *          lanes follow the same path every step runs the full width.
+ *
+ *          An error stops only the lane that raised it, with the message the
+ *          interpreter would give. Per-line counters are not kept; each lane
+ *          counts the statements it executed (as execCount would).
+ *
+ * @author  simple_wind
+ * @version 1.0
+ * @date    2025-12-13
+ * */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../core/program.h"
+
+class Expression;
+
+// Number of lanes (8 or 16 fit AVX2 registers; at most 32)
+#ifndef QBASIC_SPMD_LANES
+#define QBASIC_SPMD_LANES 8
+#endif
+
+typedef uint32_t LaneMask;      // bit l = lane l
+
+enum class LaneOp : uint8_t {
+    COUNT,      // live lanes executed one more statement (for lines that
+                // cannot count on entry, see countOnEntry)
+    ADD,        // r[a] = r[b] + r[c] in every lane (wrapping)
+    SUB,        // r[a] = r[b] - r[c]
+    MUL,        // r[a] = r[b] * r[c]
+    DIV,        // r[a] = r[b] / r[c], live lanes with a zero divisor fail
+    MOD,        // r[a] = r[b] MOD r[c]
+    POW,        // r[a] = r[b] ** r[c]
+    BADOP,      // live lanes fail with message c (unknown operator)
+    CHKDEF,     // live lanes with variable a undefined fail with message c
+    STORE,      // r[a] = r[b] in live lanes, variable a becomes defined there
+    LETADD,     // r[a] = r[b] + r[c] in live lanes, variable a becomes defined
+    LETSUB,     // r[a] = r[b] - r[c] ditto
+    LETMUL,     // r[a] = r[b] * r[c] ditto
+    PRINT,      // PRINT r[a] for live lanes
+    INPUT,      // INPUT variable a for live lanes
+    JMP,        // live lanes continue at line index c
+    JEQ,        // live lanes with r[a] == r[b] continue at line index c
+    JLT,        // live lanes with r[a] <  r[b] continue at line index c
+    JGT,        // live lanes with r[a] >  r[b] continue at line index c
+    NEXT,       // live lanes continue at line index c
+    END         // live lanes finish
+};
+
+struct LaneInstr {
+    LaneOp op;
+    int32_t a, b, c;
+};
+
+struct SpmdLaneResult {
+    enum Status { Ok, Error, Timeout };
+    Status status = Ok;
+    std::string message;        // error text unless Ok
+    std::string output;         // everything PRINT wrote (and INVALID NUMBER notes)
+    uint64_t statements = 0;
+};
+
+struct LaneContext;
+struct SpmdRuntime;
+
+class SpmdEngine {
+public:
+    static const int LANES = QBASIC_SPMD_LANES;
+
+    // Messages every engine registers first (indices into the message table)
+    enum { MSG_DIVIDE_BY_ZERO_ID, MSG_MISSING_LINE_ID, MSG_END_OF_INPUT_ID };
+
+    // Compile the program (the program must outlive the engine and stay unchanged)
+    explicit SpmdEngine(const Program &program);
+
+    // Run one instance per input vector, at most LANES of them; inputs[i]
+    // holds the lines INPUT reads in lane i (END OF INPUT once used up)
+    // Returns one result per input vector
+    std::vector<SpmdLaneResult> run(const std::vector<std::vector<std::string>> &inputs);
+
+    // Stop later runs once the clock passes `deadline`: unfinished lanes
+    // end with status Timeout
+    void setDeadline(std::chrono::steady_clock::time_point deadline);
+    void clearDeadline() { hasDeadline = false; }
+
+    // Use the AVX2 kernels when they are built in and the CPU supports them
+    // (default); disabled, the portable kernels run
+    void setVectorEnabled(bool enabled) { vectorEnabled = enabled; }
+    bool vectorActive() const;
+    static bool avx2Supported();
+
+    // Share of lanes doing work per executed line in the last run
+    // (1.0 when all instances followed the same path)
+    double occupancy() const;
+
+    int instructionCount() const { return (int)code.size(); }
+
+private:
+    friend struct SpmdRuntime;
+
+    std::vector<Statement *> lines;              // nullptr for unparsed lines
+    std::vector<int> lineNumbers;               // line index -> BASIC line number
+    std::map<int, int> lineIndex;               // line number -> index in lines
+    std::map<std::string, int> variableRegs;    // name -> variable register
+    std::map<int, int> constantRegs;            // value -> constant register
+    int variableCount = 0;
+    int tempBase = 0;
+    int registerCount = 0;
+    std::vector<int32_t> constants;             // value of every constant register
+    std::vector<std::string> messages;          // error texts referenced by instructions
+    std::vector<LaneInstr> code;
+    std::vector<int> lineStart;                 // line index -> first instruction
+    std::vector<uint8_t> countOnEntry;          // line counts as executed before it runs
+
+    bool vectorEnabled = true;
+    bool hasDeadline = false;
+    std::chrono::steady_clock::time_point deadline;
+
+    // Per-run state
+    std::vector<int32_t> regs;                  // register r, lane l at r * LANES + l
+    std::vector<LaneMask> defined;              // per variable: lanes where it is defined
+    std::vector<int32_t> pcs;                   // per lane: line index to run next
+    std::vector<uint64_t> statements;           // per lane
+    std::vector<SpmdLaneResult> results;        // per lane
+    std::vector<std::vector<std::string>> inputLines;
+    std::vector<size_t> inputNext;
+    uint64_t lineSteps = 0;
+    uint64_t laneSteps = 0;
+
+
+    void compile(const Program &program);
+    void collect(Expression *exp);
+    int message(const std::string &text);
+    int jumpTarget(int i) const;
+    std::vector<int> successors(int i) const;
+    std::vector<std::vector<uint8_t>> definedOnEntry() const;
+    int expression(Expression *exp, std::vector<uint8_t> &checked, int &temps);
+};
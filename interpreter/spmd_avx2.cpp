@@ -0,0 +1,98 @@
+// AVX2 lane kernels of SpmdEngine
+// Built with AVX2 code generation (AVX2_SOURCES in interpreter.pro) and only
+// entered after SpmdEngine::avx2Supported() checked the CPU. Without AVX2
+// code generation the file only reports that the kernels are missing.
+
+#include "spmdexec.h"
+
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+
+namespace {
+
+static_assert(LANES % 8 == 0, "AVX2 kernels need a multiple of 8 lanes");
+
+inline __m256i load(const int32_t *p) {
+    return _mm256_loadu_si256((const __m256i *)p);
+}
+
+inline void store(int32_t *p, __m256i v) {
+    _mm256_storeu_si256((__m256i *)p, v);
+}
+
+// All-ones in the 32-bit elements whose lane bit (from lane k) is set
+inline __m256i expand(LaneMask mask, int k) {
+    const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    __m256i m = _mm256_set1_epi32((int)((mask >> k) & 0xff));
+    return _mm256_cmpeq_epi32(_mm256_and_si256(m, bits), bits);
+}
+
+inline LaneMask compress(__m256i v, int k) {
+    return (LaneMask)_mm256_movemask_ps(_mm256_castsi256_ps(v)) << k;
+}
+
+struct Avx2Lanes {
+    static void add(int32_t *d, const int32_t *a, const int32_t *b) {
+        for (int k = 0; k < LANES; k += 8) store(d + k, _mm256_add_epi32(load(a + k), load(b + k)));
+    }
+    static void sub(int32_t *d, const int32_t *a, const int32_t *b) {
+        for (int k = 0; k < LANES; k += 8) store(d + k, _mm256_sub_epi32(load(a + k), load(b + k)));
+    }
+    static void mul(int32_t *d, const int32_t *a, const int32_t *b) {
+        for (int k = 0; k < LANES; k += 8) store(d + k, _mm256_mullo_epi32(load(a + k), load(b + k)));
+    }
+    static void copy(int32_t *d, const int32_t *s) {
+        for (int k = 0; k < LANES; k += 8) store(d + k, load(s + k));
+    }
+    static void select(int32_t *d, const int32_t *s, LaneMask mask) {
+        for (int k = 0; k < LANES; k += 8)
+            store(d + k, _mm256_blendv_epi8(load(d + k), load(s + k), expand(mask, k)));
+    }
+    static void fill(int32_t *d, int32_t value, LaneMask mask) {
+        __m256i v = _mm256_set1_epi32(value);
+        for (int k = 0; k < LANES; k += 8)
+            store(d + k, _mm256_blendv_epi8(load(d + k), v, expand(mask, k)));
+    }
+    static LaneMask equal(const int32_t *a, const int32_t *b) {
+        LaneMask m = 0;
+        for (int k = 0; k < LANES; k += 8) m |= compress(_mm256_cmpeq_epi32(load(a + k), load(b + k)), k);
+        return m;
+    }
+    static LaneMask less(const int32_t *a, const int32_t *b) {
+        return greater(b, a);
+    }
+    static LaneMask greater(const int32_t *a, const int32_t *b) {
+        LaneMask m = 0;
+        for (int k = 0; k < LANES; k += 8) m |= compress(_mm256_cmpgt_epi32(load(a + k), load(b + k)), k);
+        return m;
+    }
+    static LaneMask equalTo(const int32_t *a, int32_t value) {
+        __m256i v = _mm256_set1_epi32(value);
+        LaneMask m = 0;
+        for (int k = 0; k < LANES; k += 8) m |= compress(_mm256_cmpeq_epi32(load(a + k), v), k);
+        return m;
+    }
+};
+
+} // namespace
+
+bool spmdAvx2Built() {
+    return true;
+}
+
+void spmdRunAvx2(LaneContext &ctx) {
+    runLanes<Avx2Lanes>(ctx);
+}
+
+#else
+
+bool spmdAvx2Built() {
+    return false;
+}
+
+void spmdRunAvx2(LaneContext &ctx) {
+    spmdRunScalar(ctx);
+}
+
+#endif
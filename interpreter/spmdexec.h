@@ -0,0 +1,325 @@
+/**
+ * @file    spmdexec.h
+ * @brief   Lane executor of SpmdEngine (internal to spmd.cpp and spmd_avx2.cpp)
+ *
+ *          The executor is a template over the lane kernels. spmd.cpp
+ *          instantiates it with the portable kernels, spmd_avx2.cpp (built
+ *          with AVX2 enabled) with the AVX2 ones. Everything here has
+ *          internal linkage and works on raw arrays only, so no inline
+ *          function compiled for AVX2 can be shared with the rest of the
+ *          program; slow paths (errors, PRINT, INPUT, the clock) call back
+ *          into spmd.cpp through SpmdRuntime.
+ *
+ * @author  simple_wind
+ * @version 1.0
+ * @date    2025-12-13
+ * */
+
+#pragma once
+
+#include <climits>
+#include <cstdint>
+
+#include "spmd.h"
+
+// Run state handed to the executor
+struct LaneContext {
+    SpmdEngine *engine;
+    const LaneInstr *code;
+    const int *lineStart;
+    const uint8_t *countOnEntry;
+    int32_t *regs;              // register r, lane l at r * LANES + l
+    LaneMask *defined;
+    int32_t *pcs;
+    uint64_t *statements;       // per lane, not including `shared`
+    uint64_t shared;            // statements run by all lanes alive at the time
+    LaneMask alive;             // lanes still running
+    uint64_t lineSteps;
+    uint64_t laneSteps;
+};
+
+// Slow paths, implemented in spmd.cpp
+struct SpmdRuntime {
+    static void fail(LaneContext &ctx, LaneMask lanes, int message);
+    static void finish(LaneContext &ctx, LaneMask lanes);
+    static void print(LaneContext &ctx, int reg, LaneMask lanes);
+    static LaneMask input(LaneContext &ctx, int var, LaneMask lanes);   // lanes that read a value
+    static void pow(int32_t *dst, const int32_t *base, const int32_t *exponent);
+    static bool timeUp(LaneContext &ctx);
+};
+
+// Executors: run until every lane has finished or failed
+void spmdRunScalar(LaneContext &ctx);
+void spmdRunAvx2(LaneContext &ctx);
+bool spmdAvx2Built();
+
+namespace {
+
+const int LANES = SpmdEngine::LANES;
+const int DEADLINE_POLL = 1024;     // executed lines between clock checks
+
+inline bool hasLane(LaneMask mask, int l) {
+    return (mask >> l) & 1;
+}
+
+// Kernels without a vector form
+
+inline void laneDiv(int32_t *d, const int32_t *a, const int32_t *b) {
+    for (int l = 0; l < LANES; ++l) {
+        int32_t r = b[l];
+        // Zero divisors belong to failed or idle lanes; INT_MIN / -1 wraps
+        if (r == 0) d[l] = 0;
+        else if (r == -1) d[l] = (int32_t)(0u - (uint32_t)a[l]);
+        else d[l] = a[l] / r;
+    }
+}
+
+inline void laneMod(int32_t *d, const int32_t *a, const int32_t *b) {
+    for (int l = 0; l < LANES; ++l) {
+        int32_t r = b[l];
+        if (r == 0 || r == -1) {
+            d[l] = 0;
+            continue;
+        }
+        int32_t result = a[l] % r;
+        if ((r > 0 && result < 0) || (r < 0 && result > 0)) result += r;
+        d[l] = result;
+    }
+}
+
+inline void laneCount(uint64_t *counts, LaneMask mask) {
+    for (int l = 0; l < LANES; ++l) counts[l] += hasLane(mask, l);
+}
+
+inline int laneTotal(LaneMask mask) {
+    int n = 0;
+    for (; mask; mask &= mask - 1) ++n;
+    return n;
+}
+
+// Portable kernels
+struct ScalarLanes {
+    static void add(int32_t *d, const int32_t *a, const int32_t *b) {
+        for (int l = 0; l < LANES; ++l) d[l] = (int32_t)((uint32_t)a[l] + (uint32_t)b[l]);
+    }
+    static void sub(int32_t *d, const int32_t *a, const int32_t *b) {
+        for (int l = 0; l < LANES; ++l) d[l] = (int32_t)((uint32_t)a[l] - (uint32_t)b[l]);
+    }
+    static void mul(int32_t *d, const int32_t *a, const int32_t *b) {
+        for (int l = 0; l < LANES; ++l) d[l] = (int32_t)((uint32_t)a[l] * (uint32_t)b[l]);
+    }
+    static void copy(int32_t *d, const int32_t *s) {
+        for (int l = 0; l < LANES; ++l) d[l] = s[l];
+    }
+    static void select(int32_t *d, const int32_t *s, LaneMask mask) {
+        for (int l = 0; l < LANES; ++l) if (hasLane(mask, l)) d[l] = s[l];
+    }
+    static void fill(int32_t *d, int32_t value, LaneMask mask) {
+        for (int l = 0; l < LANES; ++l) if (hasLane(mask, l)) d[l] = value;
+    }
+    static LaneMask equal(const int32_t *a, const int32_t *b) {
+        LaneMask m = 0;
+        for (int l = 0; l < LANES; ++l) m |= (LaneMask)(a[l] == b[l]) << l;
+        return m;
+    }
+    static LaneMask less(const int32_t *a, const int32_t *b) {
+        LaneMask m = 0;
+        for (int l = 0; l < LANES; ++l) m |= (LaneMask)(a[l] < b[l]) << l;
+        return m;
+    }
+    static LaneMask greater(const int32_t *a, const int32_t *b) {
+        return less(b, a);
+    }
+    static LaneMask equalTo(const int32_t *a, int32_t value) {
+        LaneMask m = 0;
+        for (int l = 0; l < LANES; ++l) m |= (LaneMask)(a[l] == value) << l;
+        return m;
+    }
+};
+
+// Lanes in `lanes` continue at line index `target` (missing line: they fail)
+template <class Lanes>
+inline void moveLanes(LaneContext &ctx, LaneMask lanes, int target) {
+    if (!lanes) return;
+    if (target < 0) SpmdRuntime::fail(ctx, lanes, SpmdEngine::MSG_MISSING_LINE_ID);
+    else Lanes::fill(ctx.pcs, target, lanes);
+}
+
+inline void countLine(LaneContext &ctx, LaneMask live) {
+    if (live == ctx.alive) ++ctx.shared;
+    else laneCount(ctx.statements, live);
+}
+
+// Lanes in `live` leave the line for line index `target`
+// Returns `target` (their pcs are left to the caller), -1 if it is missing
+inline int leaveLine(LaneContext &ctx, LaneMask live, int target) {
+    if (target >= 0) return target;
+    SpmdRuntime::fail(ctx, live, SpmdEngine::MSG_MISSING_LINE_ID);
+    return -1;
+}
+
+// r[a] = op(r[b], r[c]) for the lanes in `live` (LET with a top operator)
+template <class Lanes>
+inline void letResult(LaneContext &ctx, void (*op)(int32_t *, const int32_t *, const int32_t *),
+                      const LaneInstr *in, LaneMask live) {
+    int32_t *r = ctx.regs;
+    int32_t *dst = r + (size_t)in->a * LANES;
+    // Lanes that stopped keep no state worth preserving
+    if (live == ctx.alive) {
+        op(dst, r + (size_t)in->b * LANES, r + (size_t)in->c * LANES);
+    } else {
+        int32_t value[LANES];
+        op(value, r + (size_t)in->b * LANES, r + (size_t)in->c * LANES);
+        Lanes::select(dst, value, live);
+    }
+    ctx.defined[in->a] |= live;
+}
+
+// Run one line for the lanes in `live`
+// Returns the line every surviving lane of `live` continues at, leaving their
+// pcs alone; -1 if they went different ways (pcs updated) or stopped
+template <class Lanes>
+inline int runLine(LaneContext &ctx, int line, LaneMask live) {
+    int32_t *r = ctx.regs;
+#define LANE_REG(x) (r + (size_t)(x) * LANES)
+
+    if (ctx.countOnEntry[line]) countLine(ctx, live);
+
+    for (const LaneInstr *in = ctx.code + ctx.lineStart[line];; ++in) {
+        switch (in->op) {
+        case LaneOp::COUNT:
+            countLine(ctx, live);
+            break;
+        case LaneOp::ADD:
+            Lanes::add(LANE_REG(in->a), LANE_REG(in->b), LANE_REG(in->c));
+            break;
+        case LaneOp::SUB:
+            Lanes::sub(LANE_REG(in->a), LANE_REG(in->b), LANE_REG(in->c));
+            break;
+        case LaneOp::MUL:
+            Lanes::mul(LANE_REG(in->a), LANE_REG(in->b), LANE_REG(in->c));
+            break;
+        case LaneOp::DIV: {
+            LaneMask bad = Lanes::equalTo(LANE_REG(in->c), 0) & live;
+            if (bad) {
+                SpmdRuntime::fail(ctx, bad, SpmdEngine::MSG_DIVIDE_BY_ZERO_ID);
+                live &= ~bad;
+                if (!live) return -1;
+            }
+            laneDiv(LANE_REG(in->a), LANE_REG(in->b), LANE_REG(in->c));
+            break;
+        }
+        case LaneOp::MOD:
+            laneMod(LANE_REG(in->a), LANE_REG(in->b), LANE_REG(in->c));
+            break;
+        case LaneOp::POW:
+            SpmdRuntime::pow(LANE_REG(in->a), LANE_REG(in->b), LANE_REG(in->c));
+            break;
+        case LaneOp::BADOP:
+            SpmdRuntime::fail(ctx, live, in->c);
+            return -1;
+        case LaneOp::CHKDEF: {
+            LaneMask bad = live & ~ctx.defined[in->a];
+            if (bad) {
+                SpmdRuntime::fail(ctx, bad, in->c);
+                live &= ~bad;
+                if (!live) return -1;
+            }
+            break;
+        }
+        case LaneOp::LETADD:
+            letResult<Lanes>(ctx, Lanes::add, in, live);
+            break;
+        case LaneOp::LETSUB:
+            letResult<Lanes>(ctx, Lanes::sub, in, live);
+            break;
+        case LaneOp::LETMUL:
+            letResult<Lanes>(ctx, Lanes::mul, in, live);
+            break;
+        case LaneOp::STORE:
+            if (live == ctx.alive) Lanes::copy(LANE_REG(in->a), LANE_REG(in->b));
+            else Lanes::select(LANE_REG(in->a), LANE_REG(in->b), live);
+            ctx.defined[in->a] |= live;
+            break;
+        case LaneOp::PRINT:
+            SpmdRuntime::print(ctx, in->a, live);
+            break;
+        case LaneOp::INPUT:
+            live = SpmdRuntime::input(ctx, in->a, live);
+            if (!live) return -1;
+            break;
+        case LaneOp::JMP:
+        case LaneOp::NEXT:
+            return leaveLine(ctx, live, in->c);
+        case LaneOp::JEQ:
+        case LaneOp::JLT:
+        case LaneOp::JGT: {
+            const int32_t *a = LANE_REG(in->a), *b = LANE_REG(in->b);
+            LaneMask taken = live & (in->op == LaneOp::JEQ ? Lanes::equal(a, b)
+                                   : in->op == LaneOp::JLT ? Lanes::less(a, b)
+                                   : Lanes::greater(a, b));
+            // Not taken: the NEXT that follows every conditional jump
+            if (!taken) return leaveLine(ctx, live, in[1].c);
+            if (taken == live) return leaveLine(ctx, live, in->c);
+
+            // Lanes split
+            moveLanes<Lanes>(ctx, taken, in->c);
+            live &= ~taken;
+            if (!live) return -1;
+            moveLanes<Lanes>(ctx, live, in[1].c);
+            return -1;
+        }
+        case LaneOp::END:
+            SpmdRuntime::finish(ctx, live);
+            return -1;
+        }
+    }
+#undef LANE_REG
+}
+
+// While every live lane waits at the same line (`converged`) the lanes run
+// that line without looking at their pcs; after a split each step runs the
+// lowest line some lane waits at until all lanes meet again
+template <class Lanes>
+void runLanes(LaneContext &ctx) {
+    int poll = DEADLINE_POLL;
+    int line = 0;
+    bool converged = true;
+    LaneMask counted = ctx.alive;       // lanes of `width`
+    int width = laneTotal(counted);
+    while (ctx.alive) {
+        if (--poll == 0) {
+            poll = DEADLINE_POLL;
+            if (SpmdRuntime::timeUp(ctx)) return;
+        }
+
+        LaneMask live = ctx.alive;
+        if (converged) {
+            if (live != counted) width = laneTotal(counted = live);
+            ctx.laneSteps += width;
+        } else {
+            line = INT_MAX;
+            for (int l = 0; l < LANES; ++l) {
+                if (hasLane(ctx.alive, l) && ctx.pcs[l] < line) line = ctx.pcs[l];
+            }
+            live = Lanes::equalTo(ctx.pcs, line) & ctx.alive;
+            ctx.laneSteps += laneTotal(live);
+        }
+
+        ++ctx.lineSteps;
+        int next = runLine<Lanes>(ctx, line, live);
+
+        converged = false;
+        if (next >= 0) {
+            LaneMask moved = live & ctx.alive;
+            if (moved == ctx.alive) {
+                line = next;
+                converged = true;
+            } else {
+                Lanes::fill(ctx.pcs, next, moved);
+            }
+        }
+    }
+}
+
+} // namespace
@@ -0,0 +1,110 @@
+#include "threadpool.h"
+
+namespace {
+
+// Pool and worker index of the calling thread (for submits from tasks)
+thread_local const WorkStealingPool *currentPool = nullptr;
+thread_local int currentWorker = -1;
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(int threads) {
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0) threads = 1;
+
+    for (int i = 0; i < threads; ++i) queues.emplace_back(new Queue());
+    for (int i = 0; i < threads; ++i) workers.emplace_back(&WorkStealingPool::work, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return unfinished == 0; });
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &t : workers) t.join();
+}
+
+void WorkStealingPool::submit(std::function<void()> task) {
+    int target;
+    if (currentPool == this) target = currentWorker;
+    else target = (int)(nextQueue++ % queues.size());
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++unfinished;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    {
+        // Publish under the pool mutex so a worker about to sleep sees it
+        std::lock_guard<std::mutex> lock(mutex);
+        ++queued;
+    }
+    wake.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return unfinished == 0; });
+    if (failure) {
+        std::exception_ptr e = failure;
+        failure = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+// Own deque from the back (newest), other deques from the front (oldest)
+bool WorkStealingPool::take(int self, std::function<void()> &task) {
+    {
+        Queue &own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            --queued;
+            return true;
+        }
+    }
+    int n = (int)queues.size();
+    for (int k = 1; k < n; ++k) {
+        Queue &victim = *queues[(self + k) % n];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            --queued;
+            ++steals;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::work(int self) {
+    currentPool = this;
+    currentWorker = self;
+
+    for (;;) {
+        std::function<void()> task;
+        if (!take(self, task)) {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || queued > 0; });
+            if (stopping && queued == 0) return;
+            continue;
+        }
+
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!failure) failure = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--unfinished == 0) done.notify_all();
+    }
+}
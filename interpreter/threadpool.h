@@ -0,0 +1,73 @@
+/**
+ * @file    threadpool.h
+ * @brief   Work-stealing thread pool
+ *
+ *          Every worker owns a task deque. Tasks submitted from outside the
+ *          pool are dealt round-robin over the deques, tasks submitted by a
+ *          worker go to its own deque. A worker takes its newest task first
+ *          and, when its deque is empty, steals the oldest task of another
+ *          worker, so long and short jobs balance out over all cores.
+ *
+ * @author  simple_wind
+ * @version 1.0
+ * @date    2025-12-12
+ * */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkStealingPool {
+public:
+    // threads: number of workers, 0 = one per hardware thread
+    explicit WorkStealingPool(int threads = 0);
+
+    // Waits for all tasks, then stops the workers
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    // Queue a task (may be called from inside a task)
+    void submit(std::function<void()> task);
+
+    // Block until every submitted task has finished
+    // Rethrows the first exception thrown by a task
+    void wait();
+
+    int size() const { return (int)workers.size(); }
+
+    // Tasks taken from another worker's deque so far
+    long long stealCount() const { return steals; }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;                     // guards the fields below
+    std::condition_variable wake;         // new work or stopping
+    std::condition_variable done;         // unfinished reached 0
+    long long unfinished = 0;             // submitted but not finished
+    bool stopping = false;
+    std::exception_ptr failure;
+
+    std::atomic<long long> queued{0};     // tasks sitting in deques
+    std::atomic<unsigned> nextQueue{0};
+    std::atomic<long long> steals{0};
+
+    bool take(int self, std::function<void()> &task);
+    void work(int self);
+};
@@ -0,0 +1,260 @@
+#include "tracebuffer.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+const char MAGIC[8] = {'Q', 'B', 'T', 'R', 'A', 'C', 'E', '1'};
+
+// Longest record: a write (two 5-byte varints); a step also reserves room
+// for the writes that may follow it in the same block
+const size_t MAX_WRITE = 10;
+const size_t STEP_RESERVE = 5 + TraceBuffer::MAX_WRITES_PER_STEP * MAX_WRITE;
+
+uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+void putFixed(std::ostream &out, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; ++i) out.put((char)((v >> (8 * i)) & 0xFF));
+}
+
+uint64_t getFixed(std::istream &in, int bytes) {
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; ++i) {
+        int c = in.get();
+        if (c == EOF) throw std::runtime_error("truncated trace file");
+        v |= (uint64_t)(uint8_t)c << (8 * i);
+    }
+    return v;
+}
+
+// Bytes left in the stream, or UINT64_MAX when it cannot seek
+uint64_t bytesLeft(std::istream &in) {
+    std::istream::pos_type here = in.tellg();
+    if (here == std::istream::pos_type(-1)) return UINT64_MAX;
+    in.seekg(0, std::ios::end);
+    std::istream::pos_type end = in.tellg();
+    in.seekg(here);
+    if (end == std::istream::pos_type(-1) || !in) return UINT64_MAX;
+    return (uint64_t)(end - here);
+}
+
+// A u32 length and that many bytes. A length beyond the end of the file is
+// rejected before allocating; an unseekable stream is read in chunks so that
+// memory only grows with the bytes actually there.
+template <typename Bytes>
+void getBytes(std::istream &in, Bytes &bytes) {
+    uint64_t length = getFixed(in, 4);
+    if (length > bytesLeft(in)) throw std::runtime_error("truncated trace file");
+    const uint64_t CHUNK = 1 << 16;
+    bytes.clear();
+    while (bytes.size() < length) {
+        size_t at = bytes.size();
+        bytes.resize(at + (size_t)std::min(CHUNK, length - at));
+        if (!in.read((char *)&bytes[at], (std::streamsize)(bytes.size() - at)))
+            throw std::runtime_error("truncated trace file");
+    }
+}
+
+// Varint at bytes[pos], advancing pos
+uint64_t getVarint(const std::vector<uint8_t> &bytes, size_t &pos) {
+    uint64_t v = 0;
+    for (int shift = 0; pos < bytes.size() && shift < 64; shift += 7) {
+        uint8_t b = bytes[pos++];
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return v;
+    }
+    throw std::runtime_error("corrupt trace block");
+}
+
+} // namespace
+
+// ============ TraceBuffer Implementation ============
+
+TraceBuffer::TraceBuffer(size_t capacity, size_t size) : blockSize(size < 256 ? 256 : size) {
+    size_t count = capacity / blockSize;
+    if (count < 2) count = 2;
+    bytes.resize(count * blockSize);
+    blocks.resize(count);
+    clear();
+}
+
+void TraceBuffer::clear() {
+    for (Block &b : blocks) b = Block();
+    current = 0;
+    stepCount = 0;
+    dropped = 0;
+    writesThisStep = 0;
+    blocks[0].live = true;
+    lastLine = 0;
+    ++epoch;
+}
+
+// Move on to the next block, dropping the oldest one if the ring is full
+void TraceBuffer::startBlock() {
+    current = (current + 1) % blocks.size();
+    Block &b = blocks[current];
+    b.firstStep = stepCount;
+    b.used = 0;
+    b.live = true;
+    lastLine = 0;
+    ++epoch;
+}
+
+void TraceBuffer::put(uint64_t value) {
+    uint8_t *out = bytes.data() + current * blockSize + blocks[current].used;
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    blocks[current].used += n;
+}
+
+void TraceBuffer::step(int line) {
+    if (room() < STEP_RESERVE) startBlock();
+    put((uint64_t)zigzag((int32_t)((uint32_t)line - (uint32_t)lastLine)) << 1);
+    lastLine = line;
+    writesThisStep = 0;
+    ++stepCount;
+}
+
+void TraceBuffer::write(const std::string &name, int value) {
+    if (stepCount == 0 || writesThisStep == MAX_WRITES_PER_STEP) {
+        ++dropped;
+        return;
+    }
+    write(variableId(name), value);
+}
+
+void TraceBuffer::write(uint32_t id, int value) {
+    if (stepCount == 0 || writesThisStep == MAX_WRITES_PER_STEP) {
+        ++dropped;
+        return;
+    }
+    ++writesThisStep;
+
+    int32_t previous = lastValueEpoch[id] == epoch ? lastValue[id] : 0;
+    put(((uint64_t)id << 1) | 1);
+    put(zigzag((int32_t)((uint32_t)value - (uint32_t)previous)));
+    lastValue[id] = value;
+    lastValueEpoch[id] = epoch;
+}
+
+uint32_t TraceBuffer::variableId(const std::string &name) {
+    auto it = ids.find(name);
+    if (it == ids.end()) {
+        it = ids.emplace(name, (uint32_t)names.size()).first;
+        names.push_back(name);
+        lastValue.push_back(0);
+        lastValueEpoch.push_back(0);
+    }
+    return it->second;
+}
+
+uint64_t TraceBuffer::oldestStep() const {
+    for (size_t i = 1; i <= blocks.size(); ++i) {
+        const Block &b = blocks[(current + i) % blocks.size()];
+        if (b.live) return b.firstStep;
+    }
+    return stepCount;
+}
+
+void TraceBuffer::save(std::ostream &out) const {
+    TraceReader(*this).save(out);
+}
+
+// ============ TraceReader Implementation ============
+
+TraceReader::TraceReader(const TraceBuffer &buffer) : names(buffer.names), stepCount(buffer.stepCount) {
+    size_t n = buffer.blocks.size();
+    for (size_t i = 1; i <= n; ++i) {
+        size_t index = (buffer.current + i) % n;
+        const TraceBuffer::Block &b = buffer.blocks[index];
+        if (!b.live || b.used == 0) continue;
+        const uint8_t *start = buffer.bytes.data() + index * buffer.blockSize;
+        blocks.push_back({b.firstStep, std::vector<uint8_t>(start, start + b.used)});
+    }
+}
+
+TraceReader::TraceReader(std::istream &in) {
+    char magic[sizeof(MAGIC)];
+    if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), MAGIC))
+        throw std::runtime_error("not a trace file");
+
+    stepCount = getFixed(in, 8);
+    uint64_t nameCount = getFixed(in, 4);
+    for (uint64_t i = 0; i < nameCount; ++i) {
+        std::string name;
+        getBytes(in, name);
+        names.push_back(name);
+    }
+    uint64_t blockCount = getFixed(in, 4);
+    for (uint64_t i = 0; i < blockCount; ++i) {
+        Block block;
+        block.firstStep = getFixed(in, 8);
+        getBytes(in, block.bytes);
+        blocks.push_back(std::move(block));
+    }
+}
+
+void TraceReader::forEach(const std::function<void(const TraceStep &)> &f, uint64_t from) const {
+    TraceStep step;
+    std::vector<int32_t> values(names.size());
+    std::vector<uint8_t> seen(names.size());
+
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        const Block &block = blocks[b];
+        uint64_t next = b + 1 < blocks.size() ? blocks[b + 1].firstStep : stepCount;
+        if (next <= from) continue;     // every step of this block is too old
+
+        std::fill(seen.begin(), seen.end(), 0);
+        int32_t line = 0;
+        bool pending = false;
+        step.index = block.firstStep;
+        size_t pos = 0;
+        while (pos < block.bytes.size()) {
+            uint64_t head = getVarint(block.bytes, pos);
+            if (head & 1) {
+                uint64_t id = head >> 1;
+                if (id >= names.size() || !pending) throw std::runtime_error("corrupt trace block");
+                int32_t value = (int32_t)((uint32_t)(seen[id] ? values[id] : 0)
+                                          + (uint32_t)unzigzag((uint32_t)getVarint(block.bytes, pos)));
+                values[id] = value;
+                seen[id] = 1;
+                step.writes.push_back({(uint32_t)id, value});
+                continue;
+            }
+
+            if (pending) {
+                if (step.index >= from) f(step);
+                ++step.index;
+            }
+            line = (int32_t)((uint32_t)line + (uint32_t)unzigzag((uint32_t)(head >> 1)));
+            step.line = line;
+            step.writes.clear();
+            pending = true;
+        }
+        if (pending && step.index >= from) f(step);
+    }
+}
+
+// Layout (integers little endian):
+//   "QBTRACE1", u64 steps, u32 names, per name u32 length + bytes,
+//   u32 blocks, per block u64 first step, u32 length + bytes
+void TraceReader::save(std::ostream &out) const {
+    out.write(MAGIC, sizeof(MAGIC));
+    putFixed(out, stepCount, 8);
+    putFixed(out, names.size(), 4);
+    for (const std::string &name : names) {
+        putFixed(out, name.size(), 4);
+        out.write(name.data(), (std::streamsize)name.size());
+    }
+    putFixed(out, blocks.size(), 4);
+    for (const auto &block : blocks) {
+        putFixed(out, block.firstStep, 8);
+        putFixed(out, block.bytes.size(), 4);
+        out.write((const char *)block.bytes.data(), (std::streamsize)block.bytes.size());
+    }
+}
@@ -0,0 +1,134 @@
+/**
+ * @file    tracebuffer.h
+ * @brief   Execution trace: executed lines and variable writes in a ring
+ *
+ *          TraceBuffer records every executed statement (its line) and the
+ *          variable it assigned, in a fixed amount of memory: the buffer is
+ *          split into blocks and, when full, the oldest block is dropped.
+ *          Records are delta encoded varints:
+ *
+ *            step:  zigzag(line - previous line) << 1
+ *            write: variable id << 1 | 1, then zigzag(value - previous value
+ *                   of that variable)
+ *
+ *          Both deltas restart at every block (previous line and values
+ *          count as 0), so any block decodes on its own. A loop body costs
+ *          one or two bytes per statement. Variable names are kept once, in
+ *          a table outside the ring.
+ *
+ *          TraceReader decodes a buffer or a saved trace file (see
+ *          TraceBuffer::save), oldest step first.
+ *
+ * @author  simple_wind
+ * @version 1.0
+ * @date    2025-12-16
+ * */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class TraceBuffer {
+public:
+    static const int MAX_WRITES_PER_STEP = 4;
+
+    // capacity: bytes kept (rounded down to whole blocks, at least two)
+    explicit TraceBuffer(size_t capacity = 64u << 20, size_t blockSize = 64u << 10);
+
+    // A statement at `line` is executed
+    void step(int line);
+
+    // The current step assigned `value` to `name` (at most
+    // MAX_WRITES_PER_STEP per step; further writes are counted as dropped)
+    void write(const std::string &name, int value);
+
+    // Same with the id of variableId(name), which skips the name lookup
+    void write(uint32_t id, int value);
+
+    // Id of `name` in the name table, added on first use
+    uint32_t variableId(const std::string &name);
+
+    // Steps recorded since construction or clear(), kept or not
+    uint64_t steps() const { return stepCount; }
+
+    // Index of the oldest step still in the buffer (steps are numbered from 0)
+    uint64_t oldestStep() const;
+
+    // Writes that did not fit their step
+    uint64_t droppedWrites() const { return dropped; }
+
+    void clear();
+
+    // Binary trace file: the kept blocks, oldest first, and the name table
+    void save(std::ostream &out) const;
+
+private:
+    friend class TraceReader;
+
+    struct Block {
+        uint64_t firstStep = 0;
+        size_t used = 0;
+        bool live = false;
+    };
+
+    size_t blockSize;
+    std::vector<uint8_t> bytes;
+    std::vector<Block> blocks;
+    size_t current = 0;                         // block being written
+    uint64_t stepCount = 0;
+    uint64_t dropped = 0;
+    int writesThisStep = 0;
+    int32_t lastLine = 0;
+    uint32_t epoch = 1;                         // blocks started so far
+    std::vector<int32_t> lastValue;             // variable id -> previous value
+    std::vector<uint32_t> lastValueEpoch;       // ... valid in this block only
+    std::vector<std::string> names;             // variable id -> name
+    std::unordered_map<std::string, uint32_t> ids;
+
+    void startBlock();
+    void put(uint64_t value);
+    size_t room() const { return blockSize - blocks[current].used; }
+};
+
+// One decoded step
+struct TraceStep {
+    uint64_t index;                                 // step number
+    int line;
+    std::vector<std::pair<uint32_t, int32_t>> writes;   // variable id, value
+};
+
+class TraceReader {
+public:
+    // Snapshot of a live buffer
+    explicit TraceReader(const TraceBuffer &buffer);
+
+    // Saved trace; throws std::runtime_error if it is not a valid trace
+    explicit TraceReader(std::istream &in);
+
+    uint64_t steps() const { return stepCount; }
+    uint64_t oldestStep() const { return blocks.empty() ? stepCount : blocks.front().firstStep; }
+    const std::vector<std::string> &variableNames() const { return names; }
+
+    // Call f for every kept step from `from` on, oldest first
+    void forEach(const std::function<void(const TraceStep &)> &f, uint64_t from = 0) const;
+
+    // Write the trace in the format read by TraceReader(std::istream &)
+    void save(std::ostream &out) const;
+
+private:
+    struct Block {
+        uint64_t firstStep;
+        std::vector<uint8_t> bytes;
+    };
+
+    std::vector<Block> blocks;
+    std::vector<std::string> names;
+    uint64_t stepCount = 0;
+};
@@ -0,0 +1,1025 @@
+#include "vm.h"
+#include "branchprofile.h"
+#include "cycledetector.h"
+#include "livestate.h"
+#include "runlimits.h"
+#include "tracebuffer.h"
+#include "../core/statement.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <sstream>
+
+// Labels as values (GCC, Clang) allow direct-threaded dispatch
+#if defined(__GNUC__) && !defined(QBASIC_VM_NO_THREADED)
+#define QBASIC_VM_THREADED 1
+#endif
+
+namespace {
+
+bool knownOperator(const std::string &op) {
+    return op == "+" || op == "-" || op == "*" || op == "/" || op == "MOD" || op == "**";
+}
+
+bool compilableExp(Expression *exp) {
+    if (exp->type() != COMPOUND) return true;
+    return knownOperator(exp->getOperator())
+           && compilableExp(exp->getLHS()) && compilableExp(exp->getRHS());
+}
+
+void countUses(Expression *exp, std::map<std::string, int> &uses) {
+    if (exp->type() == IDENTIFIER) uses[exp->getIdentifierName()]++;
+    else if (exp->type() == COMPOUND) {
+        countUses(exp->getLHS(), uses);
+        countUses(exp->getRHS(), uses);
+    }
+}
+
+bool isArithmetic(VmOp op) {
+    return op == VmOp::ADD || op == VmOp::SUB || op == VmOp::MUL
+           || op == VmOp::DIV || op == VmOp::MOD || op == VmOp::POW;
+}
+
+// Conditional jump of an IF (the second slot of a fused ADD as well)
+bool isBranch(VmOp op) {
+    return op == VmOp::JEQ || op == VmOp::JLT || op == VmOp::JGT
+           || op == VmOp::JNE || op == VmOp::JGE || op == VmOp::JLE;
+}
+
+bool isJump(VmOp op) {
+    return op == VmOp::JMP || isBranch(op);
+}
+
+// Jump taken exactly when `op` is not
+VmOp inverse(VmOp op) {
+    switch (op) {
+    case VmOp::JEQ: return VmOp::JNE;
+    case VmOp::JNE: return VmOp::JEQ;
+    case VmOp::JLT: return VmOp::JGE;
+    case VmOp::JGE: return VmOp::JLT;
+    case VmOp::JGT: return VmOp::JLE;
+    default:        return VmOp::JGT;   // JLE
+    }
+}
+
+// ADD fused with the conditional jump `op`
+VmOp fusedAdd(VmOp op) {
+    switch (op) {
+    case VmOp::JEQ: return VmOp::ADDJEQ;
+    case VmOp::JNE: return VmOp::ADDJNE;
+    case VmOp::JLT: return VmOp::ADDJLT;
+    case VmOp::JGE: return VmOp::ADDJGE;
+    case VmOp::JGT: return VmOp::ADDJGT;
+    default:        return VmOp::ADDJLE;
+    }
+}
+
+const char *opName(VmOp op) {
+    switch (op) {
+    case VmOp::COUNT:  return "COUNT";
+    case VmOp::ADD:    return "ADD";
+    case VmOp::SUB:    return "SUB";
+    case VmOp::MUL:    return "MUL";
+    case VmOp::DIV:    return "DIV";
+    case VmOp::MOD:    return "MOD";
+    case VmOp::POW:    return "POW";
+    case VmOp::MOVE:   return "MOVE";
+    case VmOp::CHKDEF: return "CHKDEF";
+    case VmOp::DEFINE: return "DEFINE";
+    case VmOp::PRINT:  return "PRINT";
+    case VmOp::JMP:    return "JMP";
+    case VmOp::JEQ:    return "JEQ";
+    case VmOp::JLT:    return "JLT";
+    case VmOp::JGT:    return "JGT";
+    case VmOp::JNE:    return "JNE";
+    case VmOp::JGE:    return "JGE";
+    case VmOp::JLE:    return "JLE";
+    case VmOp::ADDJEQ: return "ADDJEQ";
+    case VmOp::ADDJNE: return "ADDJNE";
+    case VmOp::ADDJLT: return "ADDJLT";
+    case VmOp::ADDJGE: return "ADDJGE";
+    case VmOp::ADDJGT: return "ADDJGT";
+    case VmOp::ADDJLE: return "ADDJLE";
+    case VmOp::LINE:   return "LINE";
+    case VmOp::WRITE:  return "WRITE";
+    case VmOp::STMT:   return "STMT";
+    case VmOp::END:    return "END";
+    case VmOp::FAIL:   return "FAIL";
+    }
+    return "?";
+}
+
+} // namespace
+
+// ============ Compilation ============
+
+RegisterVM::RegisterVM(const Program &program, const BranchProfile *profile, TraceBuffer *traceBuffer)
+    : dispatch(threadedDispatchSupported() ? VmDispatch::Threaded : VmDispatch::Switch), trace(traceBuffer) {
+    if (profile && !profile->matches(program)) throw std::runtime_error("PROFILE OF A DIFFERENT PROGRAM");
+    compile(program, profile);
+}
+
+int RegisterVM::variable(const std::string &name) {
+    auto it = variableRegs.find(name);
+    if (it != variableRegs.end()) return it->second;
+    int reg = (int)names.size();
+    variableRegs[name] = reg;
+    names.push_back(name);
+    return reg;
+}
+
+// Register every variable and constant used by an expression
+void RegisterVM::collect(Expression *exp) {
+    switch (exp->type()) {
+    case CONSTANT:
+        constantRegs[exp->getConstantValue()] = 0;
+        break;
+    case IDENTIFIER:
+        variable(exp->getIdentifierName());
+        break;
+    case COMPOUND:
+        collect(exp->getLHS());
+        collect(exp->getRHS());
+        break;
+    }
+}
+
+// Line index control reaches after an IF/GOTO is taken, -1 if the target is
+// missing (a jump to the own line continues with the next line)
+int RegisterVM::jumpTarget(int i) const {
+    int target = lines[i].stmt->getTargetLine();
+    if (target == lines[i].number) return i + 1 < (int)lines.size() ? i + 1 : -1;
+    auto it = lineIndex.find(target);
+    return it == lineIndex.end() ? -1 : it->second;
+}
+
+std::vector<int> RegisterVM::successors(int i) const {
+    std::vector<int> next;
+    bool fallsThrough = true;
+    if (Statement *stmt = lines[i].stmt) {
+        StatementType t = stmt->type();
+        if (t == StatementType::END) fallsThrough = false;
+        if (t == StatementType::GOTO || t == StatementType::IF) {
+            int target = jumpTarget(i);
+            if (target != -1) next.push_back(target);
+            if (t == StatementType::GOTO) fallsThrough = false;
+        }
+    }
+    if (fallsThrough && i + 1 < (int)lines.size()) next.push_back(i + 1);
+    return next;
+}
+
+void RegisterVM::compile(const Program &program, const BranchProfile *profile) {
+    for (int line = program.getFirstLineNumber(); line != -1; line = program.getNextLineNumber(line)) {
+        Line l;
+        l.number = line;
+        l.stmt = program.getParsedStatement(line);
+        lineIndex[line] = (int)lines.size();
+        lines.push_back(l);
+    }
+
+    // Register file: variables, then constants, then temporaries
+    for (Line &l : lines) {
+        if (!l.stmt) continue;
+        std::map<std::string, int> uses;
+        switch (l.stmt->type()) {
+        case StatementType::LET:
+            variable(l.stmt->getVariableName());
+            collect(l.stmt->getExpression());
+            countUses(l.stmt->getExpression(), uses);
+            break;
+        case StatementType::INPUT:
+            variable(l.stmt->getVariableName());
+            break;
+        case StatementType::PRINT:
+            collect(l.stmt->getExpression());
+            countUses(l.stmt->getExpression(), uses);
+            break;
+        case StatementType::IF:
+            collect(l.stmt->getLHS());
+            collect(l.stmt->getRHS());
+            countUses(l.stmt->getLHS(), uses);
+            countUses(l.stmt->getRHS(), uses);
+            break;
+        default:
+            break;
+        }
+        l.uses.assign(uses.begin(), uses.end());
+    }
+    initialRegs.assign(names.size(), 0);
+    for (auto &c : constantRegs) {
+        c.second = (int)initialRegs.size();
+        initialRegs.push_back(c.first);
+    }
+    tempBase = (int)initialRegs.size();
+
+    // Variables definitely assigned on every path into each line (forward
+    // must-analysis; unreached lines keep "everything defined")
+    int n = (int)lines.size();
+    std::vector<std::vector<uint8_t>> in(n, std::vector<uint8_t>(names.size(), 1));
+    std::vector<uint8_t> pending(n, 0);
+    std::vector<int> work;
+    if (n > 0) {
+        std::fill(in[0].begin(), in[0].end(), 0);
+        pending[0] = 1;
+        work.push_back(0);
+    }
+    while (!work.empty()) {
+        int i = work.back();
+        work.pop_back();
+        pending[i] = 0;
+
+        std::vector<uint8_t> out = in[i];
+        Statement *stmt = lines[i].stmt;
+        if (stmt && (stmt->type() == StatementType::LET || stmt->type() == StatementType::INPUT))
+            out[variableRegs.at(stmt->getVariableName())] = 1;
+
+        for (int s : successors(i)) {
+            bool changed = false;
+            for (size_t v = 0; v < out.size(); ++v) {
+                if (in[s][v] && !out[v]) {
+                    in[s][v] = 0;
+                    changed = true;
+                }
+            }
+            if (changed && !pending[s]) {
+                pending[s] = 1;
+                work.push_back(s);
+            }
+        }
+    }
+
+    int temps = 0;
+    for (int i = 0; i < n; ++i) temps = std::max(temps, statement(i, in[i]));
+    initialRegs.resize(tempBase + temps, 0);
+
+    layout(profile);
+}
+
+// Compile one expression; returns the register holding its value
+int RegisterVM::expression(Expression *exp, Line &line, std::vector<uint8_t> &known, int &temps) {
+    switch (exp->type()) {
+    case CONSTANT:
+        return constantRegs.at(exp->getConstantValue());
+    case IDENTIFIER: {
+        int reg = variableRegs.at(exp->getIdentifierName());
+        if (!known[reg]) {
+            line.body.push_back({VmOp::CHKDEF, reg, 0, 0});
+            line.handsBack = true;
+            known[reg] = 1;
+        }
+        return reg;
+    }
+    case COMPOUND:
+        break;
+    }
+
+    int l = expression(exp->getLHS(), line, known, temps);
+    int r = expression(exp->getRHS(), line, known, temps);
+    std::string op = exp->getOperator();
+    VmOp vop = op == "+" ? VmOp::ADD
+             : op == "-" ? VmOp::SUB
+             : op == "*" ? VmOp::MUL
+             : op == "/" ? VmOp::DIV
+             : op == "MOD" ? VmOp::MOD
+             : VmOp::POW;
+    if (vop == VmOp::DIV || vop == VmOp::MOD) line.handsBack = true;
+
+    int dst = tempBase + temps++;
+    line.body.push_back({vop, dst, l, r});
+    return dst;
+}
+
+// Compile line i given the variables known to be defined on entry
+// Returns the number of temporaries used
+int RegisterVM::statement(int i, std::vector<uint8_t> known) {
+    Line &line = lines[i];
+    Statement *stmt = line.stmt;
+    if (!stmt) return 0;
+
+    auto handBack = [&]() {
+        line.body.assign(1, VmInstr{VmOp::STMT, 0, 0, 0});
+        line.handsBack = true;
+    };
+
+    int temps = 0;
+    switch (stmt->type()) {
+    case StatementType::REM:
+        break;
+    case StatementType::LET: {
+        if (!compilableExp(stmt->getExpression())) {
+            handBack();
+            break;
+        }
+        int var = variableRegs.at(stmt->getVariableName());
+        int value = expression(stmt->getExpression(), line, known, temps);
+        // The top operator writes straight into the variable: every check of
+        // the expression has already passed when it executes
+        if (!line.body.empty() && isArithmetic(line.body.back().op) && line.body.back().a == value)
+            line.body.back().a = var;
+        else
+            line.body.push_back({VmOp::MOVE, var, value, 0});
+        if (!known[var]) line.body.push_back({VmOp::DEFINE, var, 0, 0});
+        break;
+    }
+    case StatementType::PRINT: {
+        if (!compilableExp(stmt->getExpression())) {
+            handBack();
+            break;
+        }
+        int value = expression(stmt->getExpression(), line, known, temps);
+        line.body.push_back({VmOp::PRINT, value, 0, 0});
+        break;
+    }
+    case StatementType::INPUT:
+        handBack();
+        break;
+    case StatementType::GOTO: {
+        int target = jumpTarget(i);
+        if (target == -1) handBack();
+        else line.body.push_back({VmOp::JMP, 0, 0, target});
+        break;
+    }
+    case StatementType::IF: {
+        int target = jumpTarget(i);
+        if (target == -1 || !compilableExp(stmt->getLHS()) || !compilableExp(stmt->getRHS())) {
+            handBack();
+            break;
+        }
+        int l = expression(stmt->getLHS(), line, known, temps);
+        int r = expression(stmt->getRHS(), line, known, temps);
+        // Other relational operators are never true in IfStmt::execute
+        std::string op = stmt->getOperator();
+        if (op == "=") line.body.push_back({VmOp::JEQ, l, r, target});
+        else if (op == "<") line.body.push_back({VmOp::JLT, l, r, target});
+        else if (op == ">") line.body.push_back({VmOp::JGT, l, r, target});
+        break;
+    }
+    case StatementType::END:
+        line.body.push_back({VmOp::END, 0, 0, 0});
+        break;
+    }
+    return temps;
+}
+
+// Block order for a profile: from the first block, follow each block's hot
+// successor (the likelier side of its IF, the target of its GOTO, else the
+// next line) while that one ran in training and is not placed yet; then go
+// on with the hottest block left. Blocks that never ran keep line order
+std::vector<int> RegisterVM::hotOrder(const BranchProfile &profile, const std::vector<int> &starts) const {
+    int blocks = (int)starts.size();
+    int n = (int)lines.size();
+    std::vector<uint64_t> weight(blocks, 0);
+    for (int i = 0; i < n; ++i)
+        weight[lines[i].block] = std::max(weight[lines[i].block], profile.line(lines[i].number).executed);
+
+    auto hotSuccessor = [&](int b) -> int {
+        int last = (b + 1 < blocks ? starts[b + 1] : n) - 1;
+        const Line &l = lines[last];
+        int follow = last + 1 < n ? lines[last + 1].block : -1;
+        if (l.body.empty()) return follow;
+        const VmInstr &end = l.body.back();
+        if (end.op == VmOp::JMP) return lines[end.c].block;
+        if (isBranch(end.op)) {
+            LineProfile counts = profile.line(l.number);
+            return counts.taken * 2 > counts.executed ? lines[end.c].block : follow;
+        }
+        if (end.op == VmOp::END) return -1;
+        if (end.op == VmOp::STMT && l.stmt->type() != StatementType::INPUT
+            && l.stmt->type() != StatementType::LET && l.stmt->type() != StatementType::PRINT)
+            return -1;      // a GOTO or IF handed back: no known successor
+        return follow;
+    };
+
+    std::vector<int> order;
+    std::vector<uint8_t> placed(blocks, 0);
+    int b = 0;
+    while (b != -1) {
+        order.push_back(b);
+        placed[b] = 1;
+        int next = hotSuccessor(b);
+        if (next != -1 && !placed[next] && weight[next] > 0) {
+            b = next;
+            continue;
+        }
+        b = -1;
+        for (int c = 0; c < blocks; ++c) {
+            if (!placed[c] && (b == -1 || weight[c] > weight[b])) b = c;
+        }
+    }
+    return order;
+}
+
+// Split lines into basic blocks and lay out the final code
+void RegisterVM::layout(const BranchProfile *profile) {
+    int n = (int)lines.size();
+    if (n > 0) lines[0].leader = true;
+    for (int i = 0; i < n; ++i) {
+        Statement *stmt = lines[i].stmt;
+        bool ends = lines[i].handsBack;
+        if (stmt) {
+            StatementType t = stmt->type();
+            if (t == StatementType::GOTO || t == StatementType::IF) {
+                int target = jumpTarget(i);
+                if (target != -1) lines[target].leader = true;
+                ends = true;
+            }
+            if (t == StatementType::END) ends = true;
+        }
+        if (ends && i + 1 < n) lines[i + 1].leader = true;
+    }
+
+    std::vector<int> starts;            // block -> first line
+    for (int i = 0; i < n; ++i) {
+        if (lines[i].leader) starts.push_back(i);
+        lines[i].block = (int)starts.size() - 1;
+        lines[i].size = (int)lines[i].body.size();
+    }
+    blockCount = (int)starts.size();
+    blockStatements.assign(blockCount, 0);
+    for (const Line &l : lines) {
+        if (l.stmt && l.stmt->type() != StatementType::END) ++blockStatements[l.block];
+    }
+
+    std::vector<int> order;
+    if (profile) order = hotOrder(*profile, starts);
+    else for (int b = 0; b < blockCount; ++b) order.push_back(b);
+
+    // Jump targets are line indices until every block has its pc; n stands
+    // for the FAIL instruction after the last block
+    entryPc.assign(n, -1);
+    for (size_t k = 0; k < order.size(); ++k) {
+        int b = order[k];
+        int first = starts[b];
+        int last = (b + 1 < blockCount ? starts[b + 1] : n) - 1;
+        int placedNext = k + 1 < order.size() ? starts[order[k + 1]] : n;
+
+        entryPc[first] = (int)code.size();
+        code.push_back({VmOp::COUNT, b, 0, 0});
+        lineOfPc.push_back(first);
+        for (int i = first; i <= last; ++i) {
+            Statement *stmt = lines[i].stmt;
+            if (trace && stmt) {
+                code.push_back({VmOp::LINE, lines[i].number, 0, 0});
+                lineOfPc.push_back(i);
+                ++lines[i].size;
+            }
+            for (const VmInstr &in : lines[i].body) {
+                if (isBranch(in.op)) lines[i].branchPc = (int)code.size();
+                code.push_back(in);
+                lineOfPc.push_back(i);
+            }
+            // A LET handed back is recorded by the hand-back
+            if (trace && stmt && stmt->type() == StatementType::LET && code.back().op != VmOp::STMT) {
+                code.push_back({VmOp::WRITE, variableRegs.at(stmt->getVariableName()), 0, 0});
+                lineOfPc.push_back(i);
+                ++lines[i].size;
+            }
+            lines[i].body.clear();
+        }
+        if (!profile) continue;
+
+        // Without a profile blocks are in line order and fall through as is
+        VmInstr &end = code.back();
+        int follow = last + 1;          // line reached by falling through
+        if (end.op == VmOp::JMP && end.c == placedNext) {
+            code.pop_back();            // GOTO the block placed next
+            lineOfPc.pop_back();
+            --lines[last].size;
+            follow = placedNext;
+        } else if (isBranch(end.op) && end.c == placedNext && follow != placedNext) {
+            end.op = inverse(end.op);   // the usual target falls through
+            end.c = follow;
+            follow = placedNext;
+            lines[last].inverted = true;
+        }
+        VmOp op = code.back().op;
+        bool fallsThrough = op != VmOp::JMP && op != VmOp::END && op != VmOp::STMT;
+        if (fallsThrough && follow != placedNext) {
+            code.push_back({VmOp::JMP, 0, 0, follow});      // not counted in the line's size
+            lineOfPc.push_back(last);
+        }
+    }
+    int failPc = (int)code.size();
+    code.push_back({VmOp::FAIL, 0, 0, 0});
+    lineOfPc.push_back(n - 1);
+
+    for (VmInstr &in : code) {
+        if (isJump(in.op)) in.c = in.c == n ? failPc : entryPc[in.c];
+    }
+
+    // Superinstructions where the training runs went: an ADD right before
+    // the conditional jump of its block (nothing jumps between the two, as
+    // every jump target is a COUNT)
+    if (profile) {
+        for (size_t pc = 0; pc + 1 < code.size(); ++pc) {
+            if (code[pc].op == VmOp::ADD && isBranch(code[pc + 1].op)
+                && profile->line(lines[lineOfPc[pc]].number).executed > 0)
+                code[pc].op = fusedAdd(code[pc + 1].op);
+        }
+    }
+}
+
+// ============ Execution ============
+
+void RegisterVM::loadState(EvalState &state) {
+    for (size_t v = 0; v < names.size(); ++v) {
+        defined[v] = state.isDefined(names[v]);
+        if (defined[v]) regs[v] = state.getValue(names[v]);
+    }
+}
+
+void RegisterVM::storeState(EvalState &state) {
+    for (size_t v = 0; v < names.size(); ++v) {
+        if (defined[v]) state.setValue(names[v], regs[v]);
+    }
+}
+
+// Credit everything executed in compiled code to the statements
+void RegisterVM::flushCounters(EvalState &state) {
+    RuntimeStats *rs = state.getRuntimeStats();
+    for (uint64_t hits : blockHits) executed += hits;     // COUNT instructions
+    for (size_t i = 0; i < lines.size(); ++i) {
+        const Line &l = lines[i];
+        if (!l.stmt || l.stmt->type() == StatementType::END) continue;
+        uint64_t count = blockHits[l.block] - handBacks[i];
+        if (count == 0) continue;
+        executed += count * l.size;
+        if (!rs) continue;
+
+        LineCounters &counters = rs->lineCounters[l.number];
+        counters.execCount += (int)count;
+        if (l.stmt->type() == StatementType::IF) {
+            uint64_t taken = l.branchPc >= 0 ? takenHits[l.branchPc] : 0;
+            if (l.inverted) taken = count - taken;     // the jump counted IF false
+            counters.thenCount += (int)taken;
+            counters.ifCount += (int)(count - taken);
+        }
+        for (const auto &u : l.uses) rs->identifierUseCount[u.first] += (int)(u.second * count);
+    }
+    std::fill(blockHits.begin(), blockHits.end(), 0);
+    std::fill(takenHits.begin(), takenHits.end(), 0);
+    std::fill(handBacks.begin(), handBacks.end(), 0);
+}
+
+// Entry pc for a line reached after Statement::execute
+int RegisterVM::resume(int line) const {
+    auto it = lineIndex.find(line);
+    if (it == lineIndex.end() || entryPc[it->second] < 0)
+        throw std::logic_error("RegisterVM: no entry for line " + std::to_string(line));
+    return entryPc[it->second];
+}
+
+// Deadline, stop and cycle checks before the block at `pc` runs; when one
+// stops the run, results so far stay visible and the block is the next line
+void RegisterVM::poll(EvalState &state, const Program &program, int pc) {
+    int line = lines[lineOfPc[pc]].number;
+    if (hasDeadline && std::chrono::steady_clock::now() > deadline) {
+        storeState(state);
+        flushCounters(state);
+        state.setNextLine(line);
+        throw TimeLimitError();
+    }
+    if (live) {
+        if (live->stopRequested()) {
+            storeState(state);
+            flushCounters(state);
+            state.setNextLine(line);
+            throw RunStoppedError();
+        }
+        if (live->due()) {
+            flushCounters(state);       // line counts are published from the stats
+            live->begin(line);
+            for (size_t v = 0; v < names.size(); ++v) {
+                if (defined[v]) live->variable(names[v], regs[v]);
+            }
+            if (RuntimeStats *rs = state.getRuntimeStats()) {
+                for (const auto &entry : rs->lineCounters) live->lineCount(entry.first, entry.second.execCount);
+            }
+            live->end();
+        }
+    }
+    pollCountdown = pollInterval();
+    if (detector) {
+        storeState(state);
+        if (detector->sample(line, state)) {
+            flushCounters(state);
+            state.setNextLine(line);
+            throw CycleDetector::error(program, line, state);
+        }
+    }
+}
+
+// Blocks between polls
+int RegisterVM::pollInterval() const {
+    return detector ? CycleDetector::INTERVAL : DEADLINE_POLL;
+}
+
+bool RegisterVM::threadedDispatchSupported() {
+#ifdef QBASIC_VM_THREADED
+    return true;
+#else
+    return false;
+#endif
+}
+
+void RegisterVM::setDispatch(VmDispatch mode) {
+    dispatch = threadedDispatchSupported() ? mode : VmDispatch::Switch;
+}
+
+void RegisterVM::setDeadline(std::chrono::steady_clock::time_point when) {
+    hasDeadline = true;
+    deadline = when;
+}
+
+void RegisterVM::setFuel(long long statements) {
+    fuel = statements > 0 ? statements : 0;
+}
+
+void RegisterVM::run(EvalState &state, const Program &program) {
+    // Same start as Interpreter::run (throws on an empty program)
+    state.setNextLine(program.requireLine(program.getFirstLineNumber()));
+
+    regs = initialRegs;
+    defined.assign(names.size(), 0);
+    blockHits.assign(blockCount, 0);
+    takenHits.assign(code.size(), 0);
+    handBacks.assign(lines.size(), 0);
+    traceIds.assign(names.size(), -1);
+    executed = 0;
+    pollCountdown = pollInterval();
+    fuelLeft = fuel;
+    loadState(state);
+
+#ifdef QBASIC_VM_THREADED
+    if (dispatch == VmDispatch::Threaded) {
+        execute<true>(state, program);
+        return;
+    }
+#endif
+    execute<false>(state, program);
+}
+
+// Both dispatch loops share the instruction bodies below. Threaded mode
+// jumps straight to the handler address stored for the next instruction;
+// switch mode goes back through one central switch (the portable fallback)
+#ifdef QBASIC_VM_THREADED
+#define VM_DISPATCH()                                   \
+    do {                                                \
+        if (Threaded) goto *handlers[pc];               \
+        goto dispatchSwitch;                            \
+    } while (0)
+#else
+#define VM_DISPATCH() goto dispatchSwitch
+#endif
+
+template <bool Threaded>
+void RegisterVM::execute(EvalState &state, const Program &program) {
+#ifdef QBASIC_VM_THREADED
+    // Handler addresses in VmOp order
+    static const void *const labels[] = {
+        &&op_COUNT, &&op_ADD, &&op_SUB, &&op_MUL, &&op_DIV, &&op_MOD, &&op_POW,
+        &&op_MOVE, &&op_CHKDEF, &&op_DEFINE, &&op_PRINT, &&op_JMP, &&op_JEQ,
+        &&op_JLT, &&op_JGT, &&op_JNE, &&op_JGE, &&op_JLE,
+        &&op_ADDJEQ, &&op_ADDJNE, &&op_ADDJLT, &&op_ADDJGE, &&op_ADDJGT, &&op_ADDJLE,
+        &&op_LINE, &&op_WRITE, &&op_STMT, &&op_END, &&op_FAIL
+    };
+    if (Threaded && threaded.size() != code.size()) {
+        threaded.clear();
+        for (const VmInstr &in : code) threaded.push_back(labels[(int)in.op]);
+    }
+    const void *const *handlers = threaded.data();
+#endif
+
+    int32_t *r = regs.data();
+    const VmInstr *pcode = code.data();
+    int pc = 0;
+    const bool polls = hasDeadline || detector || live;    // fixed for the run: one test per block
+    VM_DISPATCH();
+
+dispatchSwitch:
+    switch (pcode[pc].op) {
+    case VmOp::COUNT:  goto op_COUNT;
+    case VmOp::ADD:    goto op_ADD;
+    case VmOp::SUB:    goto op_SUB;
+    case VmOp::MUL:    goto op_MUL;
+    case VmOp::DIV:    goto op_DIV;
+    case VmOp::MOD:    goto op_MOD;
+    case VmOp::POW:    goto op_POW;
+    case VmOp::MOVE:   goto op_MOVE;
+    case VmOp::CHKDEF: goto op_CHKDEF;
+    case VmOp::DEFINE: goto op_DEFINE;
+    case VmOp::PRINT:  goto op_PRINT;
+    case VmOp::JMP:    goto op_JMP;
+    case VmOp::JEQ:    goto op_JEQ;
+    case VmOp::JLT:    goto op_JLT;
+    case VmOp::JGT:    goto op_JGT;
+    case VmOp::JNE:    goto op_JNE;
+    case VmOp::JGE:    goto op_JGE;
+    case VmOp::JLE:    goto op_JLE;
+    case VmOp::ADDJEQ: goto op_ADDJEQ;
+    case VmOp::ADDJNE: goto op_ADDJNE;
+    case VmOp::ADDJLT: goto op_ADDJLT;
+    case VmOp::ADDJGE: goto op_ADDJGE;
+    case VmOp::ADDJGT: goto op_ADDJGT;
+    case VmOp::ADDJLE: goto op_ADDJLE;
+    case VmOp::LINE:   goto op_LINE;
+    case VmOp::WRITE:  goto op_WRITE;
+    case VmOp::STMT:   goto op_STMT;
+    case VmOp::END:    goto op_END;
+    case VmOp::FAIL:   goto op_FAIL;
+    }
+    throw std::logic_error("RegisterVM: bad opcode");
+
+op_COUNT:
+    if (polls && --pollCountdown == 0) poll(state, program, pc);
+    if (fuel > 0 && (fuelLeft -= blockStatements[pcode[pc].a]) < 0) {
+        // The whole block no longer fits: stop before it, like the deadline
+        fuelLeft += blockStatements[pcode[pc].a];
+        storeState(state);
+        flushCounters(state);
+        state.setNextLine(lines[lineOfPc[pc]].number);
+        throw FuelExhaustedError();
+    }
+    ++blockHits[pcode[pc].a];
+    ++pc;
+    VM_DISPATCH();
+
+op_ADD: {
+        const VmInstr &in = pcode[pc];
+        r[in.a] = (int32_t)((uint32_t)r[in.b] + (uint32_t)r[in.c]);
+        ++pc;
+        VM_DISPATCH();
+    }
+
+op_SUB: {
+        const VmInstr &in = pcode[pc];
+        r[in.a] = (int32_t)((uint32_t)r[in.b] - (uint32_t)r[in.c]);
+        ++pc;
+        VM_DISPATCH();
+    }
+
+op_MUL: {
+        const VmInstr &in = pcode[pc];
+        r[in.a] = (int32_t)((uint32_t)r[in.b] * (uint32_t)r[in.c]);
+        ++pc;
+        VM_DISPATCH();
+    }
+
+op_DIV: {
+        // Zero divisor and INT_MIN / -1 are left to CompoundExp::eval
+        const VmInstr &in = pcode[pc];
+        if (r[in.c] == 0 || (r[in.c] == -1 && r[in.b] == INT_MIN)) goto handBack;
+        r[in.a] = r[in.b] / r[in.c];
+        ++pc;
+        VM_DISPATCH();
+    }
+
+op_MOD: {
+        const VmInstr &in = pcode[pc];
+        int32_t left = r[in.b], right = r[in.c];
+        if (right == 0) {
+            r[in.a] = 0;
+        } else {
+            if (right == -1 && left == INT_MIN) goto handBack;
+            int32_t result = left % right;
+            if ((right > 0 && result < 0) || (right < 0 && result > 0)) result += right;
+            r[in.a] = result;
+        }
+        ++pc;
+        VM_DISPATCH();
+    }
+
+op_POW: {
+        const VmInstr &in = pcode[pc];
+        r[in.a] = (int32_t)std::pow(r[in.b], r[in.c]);
+        ++pc;
+        VM_DISPATCH();
+    }
+
+op_MOVE:
+    r[pcode[pc].a] = r[pcode[pc].b];
+    ++pc;
+    VM_DISPATCH();
+
+op_CHKDEF:
+    if (!defined[pcode[pc].a]) goto handBack;
+    ++pc;
+    VM_DISPATCH();
+
+op_DEFINE:
+    defined[pcode[pc].a] = 1;
+    ++pc;
+    VM_DISPATCH();
+
+op_PRINT:
+    try {
+        PrintStmt::print(state, r[pcode[pc].a]);
+    } catch (...) {
+        // The output consumer refused the text (e.g. OutputLimitError)
+        storeState(state);
+        flushCounters(state);
+        state.setNextLine(lines[lineOfPc[pc]].number);
+        throw;
+    }
+    ++pc;
+    VM_DISPATCH();
+
+op_JMP:
+    pc = pcode[pc].c;
+    VM_DISPATCH();
+
+op_JEQ:
+    if (r[pcode[pc].a] == r[pcode[pc].b]) {
+        ++takenHits[pc];
+        pc = pcode[pc].c;
+    } else {
+        ++pc;
+    }
+    VM_DISPATCH();
+
+op_JLT:
+    if (r[pcode[pc].a] < r[pcode[pc].b]) {
+        ++takenHits[pc];
+        pc = pcode[pc].c;
+    } else {
+        ++pc;
+    }
+    VM_DISPATCH();
+
+op_JGT:
+    if (r[pcode[pc].a] > r[pcode[pc].b]) {
+        ++takenHits[pc];
+        pc = pcode[pc].c;
+    } else {
+        ++pc;
+    }
+    VM_DISPATCH();
+
+op_JNE:
+    if (r[pcode[pc].a] != r[pcode[pc].b]) {
+        ++takenHits[pc];
+        pc = pcode[pc].c;
+    } else {
+        ++pc;
+    }
+    VM_DISPATCH();
+
+op_JGE:
+    if (r[pcode[pc].a] >= r[pcode[pc].b]) {
+        ++takenHits[pc];
+        pc = pcode[pc].c;
+    } else {
+        ++pc;
+    }
+    VM_DISPATCH();
+
+op_JLE:
+    if (r[pcode[pc].a] <= r[pcode[pc].b]) {
+        ++takenHits[pc];
+        pc = pcode[pc].c;
+    } else {
+        ++pc;
+    }
+    VM_DISPATCH();
+
+    // ADD, then the jump in the next slot without dispatching it
+#define VM_ADD_BRANCH(name, cmp)                                                    \
+op_##name: {                                                                        \
+        const VmInstr &in = pcode[pc];                                              \
+        r[in.a] = (int32_t)((uint32_t)r[in.b] + (uint32_t)r[in.c]);                 \
+        const VmInstr &br = pcode[pc + 1];                                          \
+        if (r[br.a] cmp r[br.b]) {                                                  \
+            ++takenHits[pc + 1];                                                    \
+            pc = br.c;                                                              \
+        } else {                                                                    \
+            pc += 2;                                                                \
+        }                                                                           \
+        VM_DISPATCH();                                                              \
+    }
+
+    VM_ADD_BRANCH(ADDJEQ, ==)
+    VM_ADD_BRANCH(ADDJNE, !=)
+    VM_ADD_BRANCH(ADDJLT, <)
+    VM_ADD_BRANCH(ADDJGE, >=)
+    VM_ADD_BRANCH(ADDJGT, >)
+    VM_ADD_BRANCH(ADDJLE, <=)
+#undef VM_ADD_BRANCH
+
+op_LINE:
+    trace->step(pcode[pc].a);
+    ++pc;
+    VM_DISPATCH();
+
+op_WRITE: {
+        // Ids are taken on first write, in the order a traced run would
+        int v = pcode[pc].a;
+        if (traceIds[v] < 0) traceIds[v] = trace->variableId(names[v]);
+        trace->write((uint32_t)traceIds[v], r[v]);
+        ++pc;
+        VM_DISPATCH();
+    }
+
+op_STMT:
+    goto handBack;
+
+op_END:
+    storeState(state);
+    flushCounters(state);
+    state.setEnd();
+    return;
+
+op_FAIL:
+    // Falling off the last line fails like Interpreter::run
+    storeState(state);
+    flushCounters(state);
+    state.setNextLine(lines[lineOfPc[pc]].number);
+    program.requireLine(-1);
+    return;
+
+handBack: {
+        // Let the statement itself run this line (and raise its error)
+        int i = lineOfPc[pc];
+        ++handBacks[i];
+        storeState(state);
+
+        int current = lines[i].number;
+        try {
+            state.setCurrentLine(current);
+            state.setNextLine(current);
+            lines[i].stmt->execute(state, program);
+            if (trace) {
+                // The LINE instruction has already recorded the step
+                StatementType type = lines[i].stmt->type();
+                if (type == StatementType::LET || type == StatementType::INPUT) {
+                    const std::string name = lines[i].stmt->getVariableName();
+                    trace->write(name, state.getValue(name));
+                }
+            }
+            if (state.getNextLine() == current)
+                state.setNextLine(program.requireLine(program.getNextLineNumber(current)));
+        } catch (...) {
+            flushCounters(state);
+            throw;
+        }
+        if (state.isEnded()) {
+            flushCounters(state);
+            return;
+        }
+        loadState(state);
+        pc = resume(state.getNextLine());
+        VM_DISPATCH();
+    }
+}
+
+#undef VM_DISPATCH
+
+// ============ Listing ============
+
+std::string RegisterVM::disassemble() const {
+    std::ostringstream out;
+    auto reg = [&](int r) {
+        if (r < (int)names.size()) return names[r];
+        if (r < tempBase) return std::to_string(initialRegs[r]);
+        return "t" + std::to_string(r - tempBase);
+    };
+
+    for (size_t pc = 0; pc < code.size(); ++pc) {
+        const VmInstr &in = code[pc];
+        int i = lineOfPc[pc];
+        if (in.op == VmOp::COUNT || (pc > 0 && lineOfPc[pc - 1] != i))
+            out << (i >= 0 ? std::to_string(lines[i].number) : std::string("?")) << ":\n";
+        out << "  " << pc << " " << opName(in.op);
+        switch (in.op) {
+        case VmOp::COUNT:
+            out << " b" << in.a;
+            break;
+        case VmOp::ADD: case VmOp::SUB: case VmOp::MUL:
+        case VmOp::DIV: case VmOp::MOD: case VmOp::POW:
+        case VmOp::ADDJEQ: case VmOp::ADDJNE: case VmOp::ADDJLT:
+        case VmOp::ADDJGE: case VmOp::ADDJGT: case VmOp::ADDJLE:
+            out << " " << reg(in.a) << ", " << reg(in.b) << ", " << reg(in.c);
+            break;
+        case VmOp::MOVE:
+            out << " " << reg(in.a) << ", " << reg(in.b);
+            break;
+        case VmOp::CHKDEF: case VmOp::DEFINE: case VmOp::PRINT: case VmOp::WRITE:
+            out << " " << reg(in.a);
+            break;
+        case VmOp::LINE:
+            out << " " << in.a;
+            break;
+        case VmOp::JMP:
+            out << " @" << in.c;
+            break;
+        case VmOp::JEQ: case VmOp::JLT: case VmOp::JGT:
+        case VmOp::JNE: case VmOp::JGE: case VmOp::JLE:
+            out << " " << reg(in.a) << ", " << reg(in.b) << ", @" << in.c;
+            break;
+        default:
+            break;
+        }
+        out << "\n";
+    }
+    return out.str();
+}
@@ -0,0 +1,229 @@
+/**
+ * @file    vm.h
+ * @brief   Register machine execution engine
+ *
+ *          The whole program is compiled once into three-address
+ *          instructions ("r[a] = r[b] op r[c]") over a single register file
+ *          holding, in this order, every variable of the program, every
+ *          constant and the expression temporaries. Expression trees need no
+ *          operand stack: leaves are register numbers and each operator node
+ *          writes one temporary (or, for the top node of a LET, the variable
+ *          itself).
+ *
+ *          Lines are grouped into basic blocks; one counter per block entry
+ *          plus one per taken IF gives every statement's execution count.
+ *          Definedness of variables is tracked by a forward data-flow pass so
+ *          the VARIABLE NOT DEFINED check is only emitted where a variable may
+ *          still be undefined.
+ *
+ *          Given a BranchProfile of training runs, blocks are laid out along
+ *          their hot successors instead of in line order: a GOTO to the
+ *          block placed next disappears, an IF whose jump is usually taken
+ *          is compiled with the opposite condition so the common case falls
+ *          through, and an ADD followed by a conditional jump in a block the
+ *          training ran is fused into one superinstruction (the loop counter
+ *          idiom "LET I = I + 1" then "IF I < N"). Counters and results are
+ *          the same as without a profile.
+ *
+ *          Anything that would raise an error (undefined variable, DIVIDE BY
+ *          ZERO, unknown operator, jump to a missing line) and every INPUT is
+ *          handed back to Statement::execute for that one line, so error
+ *          messages, input handling and counters match Interpreter::run.
+ *
+ *          Given a TraceBuffer, every line starts with a LINE instruction and
+ *          every compiled LET ends with a WRITE, so the trace gets the same
+ *          steps and writes as a traced Interpreter::run.
+ *
+ * @author  simple_wind
+ * @version 1.0
+ * @date    2025-12-11
+ * */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../core/program.h"
+#include "../runtime/evalstate.h"
+
+class Statement;
+class Expression;
+class CycleDetector;
+class LiveState;
+class TraceBuffer;
+struct BranchProfile;
+
+enum class VmOp : uint8_t {
+    COUNT,      // blockCount[a]++
+    ADD,        // r[a] = r[b] + r[c] (wrapping)
+    SUB,        // r[a] = r[b] - r[c]
+    MUL,        // r[a] = r[b] * r[c]
+    DIV,        // r[a] = r[b] / r[c], hands the line back on zero divisor
+    MOD,        // r[a] = r[b] MOD r[c]
+    POW,        // r[a] = r[b] ** r[c]
+    MOVE,       // r[a] = r[b]
+    CHKDEF,     // hands the line back if variable register a is undefined
+    DEFINE,     // mark variable register a as defined
+    PRINT,      // PRINT r[a]
+    JMP,        // pc = c
+    JEQ,        // if r[a] == r[b]: count taken, pc = c
+    JLT,        // if r[a] <  r[b]: count taken, pc = c
+    JGT,        // if r[a] >  r[b]: count taken, pc = c
+    JNE,        // if r[a] != r[b]: count taken, pc = c (inverted JEQ)
+    JGE,        // if r[a] >= r[b]: count taken, pc = c (inverted JLT)
+    JLE,        // if r[a] <= r[b]: count taken, pc = c (inverted JGT)
+    ADDJEQ,     // ADD, then the conditional jump in the next slot (profile only)
+    ADDJNE,
+    ADDJLT,
+    ADDJGE,
+    ADDJGT,
+    ADDJLE,
+    LINE,       // trace step of line a (traced code only)
+    WRITE,      // trace write of variable register a (traced code only)
+    STMT,       // run the line through Statement::execute
+    END,        // END statement
+    FAIL        // fell off the last line
+};
+
+struct VmInstr {
+    VmOp op;
+    int32_t a, b, c;
+};
+
+// How the run loop finds the next instruction handler
+enum class VmDispatch {
+    Switch,     // one central switch per instruction (portable)
+    Threaded    // jump straight to the handler address stored per instruction
+};
+
+class RegisterVM {
+public:
+    // Compile the program (the program must outlive the VM and stay unchanged)
+    // A VM holds the registers of one run: use one VM per concurrent run
+    // With a profile the code is laid out for its hot paths; throws
+    // std::runtime_error("PROFILE OF A DIFFERENT PROGRAM") if it was trained
+    // on another program. With a trace (not owned) every run records its
+    // steps and writes into it
+    explicit RegisterVM(const Program &program, const BranchProfile *profile = nullptr,
+                        TraceBuffer *trace = nullptr);
+
+    // Run from the first line like Interpreter::run; variables already in
+    // `state` are visible to the program and results are written back
+    // Throws the same runtime errors as the tree-walking interpreter
+    void run(EvalState &state, const Program &program);
+
+    // Select the dispatch loop; Threaded needs GCC/Clang labels-as-values and
+    // falls back to Switch elsewhere (the default is Threaded when available)
+    void setDispatch(VmDispatch mode);
+    VmDispatch getDispatch() const { return dispatch; }
+    static bool threadedDispatchSupported();
+
+    // Stop later runs with TimeLimitError once the clock passes `deadline`
+    // (polled every DEADLINE_POLL basic blocks)
+    void setDeadline(std::chrono::steady_clock::time_point deadline);
+    void clearDeadline() { hasDeadline = false; }
+    static const int DEADLINE_POLL = 4096;
+
+    // Stop later runs with FuelExhaustedError before the first basic block
+    // whose statements would take the run past `statements` (0 = unlimited).
+    // Fuel is charged per block on entry, so the run may stop with a few
+    // statements of fuel left (see fuelUsed); the state is stored and the
+    // next line is the first line of that block, so a caller can finish the
+    // remaining fuel one statement at a time
+    void setFuel(long long statements);
+
+    // Statements charged against the fuel limit by the last run
+    long long fuelUsed() const { return fuel - fuelLeft; }
+
+    // Sample the state every CycleDetector::INTERVAL block entries and stop
+    // with InfiniteLoopError when it repeats (nullptr = off). The detector
+    // must outlive the runs; the caller tells it about INPUT (see
+    // CycleDetector::inputRead)
+    void setCycleDetector(CycleDetector *cycleDetector) { detector = cycleDetector; }
+
+    // Publish the line, variables and line counts to `liveState` every DEADLINE_POLL block
+    // entries, at most once per its interval, and stop with RunStoppedError
+    // when it asks to (nullptr = off)
+    void setLiveState(LiveState *liveState) { live = liveState; }
+
+    // Compiled code size
+    int instructionCount() const { return (int)code.size(); }
+    int registerCount() const { return (int)initialRegs.size(); }
+
+    // Instructions executed by the last run (lines handed back to
+    // Statement::execute are not included)
+    uint64_t executedInstructions() const { return executed; }
+
+    // Human-readable listing of the compiled code (for tests and debugging)
+    std::string disassemble() const;
+
+private:
+    struct Line {
+        int number;                 // BASIC line number
+        Statement *stmt;            // nullptr for unparsed lines
+        int block = -1;             // basic block the line belongs to
+        bool leader = false;        // starts a basic block
+        bool handsBack = false;     // may leave compiled code (see STMT)
+        int branchPc = -1;          // pc of the IF jump, counts taken branches
+        bool inverted = false;      // the jump has the opposite condition: counts IF false
+        int size = 0;               // number of instructions of the line
+        std::vector<VmInstr> body;  // instructions, jump targets as line indices
+        std::vector<std::pair<std::string, int>> uses;  // identifier evaluations per execution
+    };
+
+    std::vector<Line> lines;
+    std::map<int, int> lineIndex;               // line number -> index in lines
+    std::vector<std::string> names;             // variable register -> name
+    std::map<std::string, int> variableRegs;    // name -> variable register
+    std::map<int, int> constantRegs;            // value -> constant register
+    int tempBase = 0;                           // first temporary register
+    std::vector<int32_t> initialRegs;           // constants preloaded, rest 0
+    std::vector<VmInstr> code;
+    std::vector<int> lineOfPc;                  // pc -> index in lines
+    std::vector<int> entryPc;                   // line index -> pc (-1 if not a block start)
+    int blockCount = 0;
+    VmDispatch dispatch;
+    std::vector<const void *> threaded;         // pc -> handler address (Threaded mode)
+    bool hasDeadline = false;
+    std::chrono::steady_clock::time_point deadline;
+    long long fuel = 0;                         // statements per run, 0 = unlimited
+    CycleDetector *detector = nullptr;
+    LiveState *live = nullptr;
+    TraceBuffer *trace = nullptr;
+    std::vector<int> blockStatements;           // block -> counted statements (END excluded)
+
+    // Per-run state
+    std::vector<int32_t> regs;
+    std::vector<uint8_t> defined;               // one flag per variable register
+    std::vector<uint64_t> blockHits;
+    std::vector<uint64_t> takenHits;            // indexed by pc of the jump
+    std::vector<int> handBacks;                 // line index -> lines re-run by Statement::execute
+    std::vector<int64_t> traceIds;              // variable register -> trace id, -1 until written
+    uint64_t executed = 0;
+    int pollCountdown = DEADLINE_POLL;          // blocks until the next poll (see pollInterval)
+    long long fuelLeft = 0;                     // fuel not yet charged
+
+    void compile(const Program &program, const BranchProfile *profile);
+    void collect(Expression *exp);
+    int variable(const std::string &name);
+    int jumpTarget(int i) const;
+    std::vector<int> successors(int i) const;
+    int statement(int i, std::vector<uint8_t> known);
+    int expression(Expression *exp, Line &line, std::vector<uint8_t> &known, int &temps);
+    void layout(const BranchProfile *profile);
+    std::vector<int> hotOrder(const BranchProfile &profile, const std::vector<int> &starts) const;
+
+    template <bool Threaded>
+    void execute(EvalState &state, const Program &program);
+
+    void loadState(EvalState &state);
+    void storeState(EvalState &state);
+    void flushCounters(EvalState &state);
+    void poll(EvalState &state, const Program &program, int pc);
+    int pollInterval() const;
+    int resume(int line) const;
+};
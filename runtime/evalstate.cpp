@@ -1,6 +1,7 @@
 // evalstate.cpp
 // Implementation of runtime state management
 #include "evalstate.h"
+#include <stdexcept>
 
 // Constructor: initialize runtime state with empty symbol table
 EvalState::EvalState() {
@@ -12,6 +13,28 @@ EvalState::~EvalState() {
     delete runtimeStats;
 }
 
+// Copy: own a copy of the statistics
+EvalState::EvalState(const EvalState &other)
+    : inputProvider(other.inputProvider), outputConsumer(other.outputConsumer),
+    symbolTable(other.symbolTable),
+    runtimeStats(other.runtimeStats ? new RuntimeStats(*other.runtimeStats) : nullptr),
+    currentLine(other.currentLine), nextLine(other.nextLine), ended(other.ended) {
+}
+
+EvalState &EvalState::operator=(const EvalState &other) {
+    if (this == &other) return *this;
+    RuntimeStats *stats = other.runtimeStats ? new RuntimeStats(*other.runtimeStats) : nullptr;
+    delete runtimeStats;
+    runtimeStats = stats;
+    inputProvider = other.inputProvider;
+    outputConsumer = other.outputConsumer;
+    symbolTable = other.symbolTable;
+    currentLine = other.currentLine;
+    nextLine = other.nextLine;
+    ended = other.ended;
+    return *this;
+}
+
 // Set variable value in symbol table
 // Creates variable if not exists, updates if exists
 void EvalState::setValue(const std::string &var, int value) {
@@ -3,6 +3,11 @@
  * @brief   Runtime evaluation state for variable storage and runtime statistics
  *          Manages variable bindings and tracks runtime information
  *
+ *          EvalState is the execution context of one run: program counter,
+ *          end flag, variables and every counter live here, so the parsed
+ *          Program is never modified and several runs (one EvalState each)
+ *          can share it, also from different threads.
+ *
  * @author  simple_wind
  * @version 1.0
  * @date    2025-11-27
@@ -10,12 +15,31 @@
 
 #pragma once
 
-#include<QObject>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+
+// Execution counters of one program line
+struct LineCounters {
+    int execCount = 0;      // times the statement was executed
+    int ifCount = 0;        // IF: condition false
+    int thenCount = 0;      // IF: condition true (jump taken)
+};
 
 // Runtime statistics: tracks variable usage during execution
 struct RuntimeStats {
     // Maps variable name to count of identifier uses
     std::map<std::string, int> identifierUseCount;
+
+    // Maps line number to its execution counters
+    std::map<int, LineCounters> lineCounters;
+
+    // Counters of a line (all zero if it never ran)
+    LineCounters getLineCounters(int line) const {
+        auto it = lineCounters.find(line);
+        return it == lineCounters.end() ? LineCounters() : it->second;
+    }
 };
 
 // EvalState: Stores runtime state and execution context
@@ -26,6 +50,10 @@ public:
     EvalState();
     ~EvalState();
 
+    // Copies are independent contexts (statistics are copied, not shared)
+    EvalState(const EvalState &other);
+    EvalState &operator=(const EvalState &other);
+
     // Variable binding operations
     
     // Set the value of a variable (creates if not exists)
@@ -40,6 +68,9 @@ public:
     // Clear all variables
     void clear();
 
+    // Read-only view of all variable bindings (sorted by name)
+    const std::map<std::string, int> &getVariables() const { return symbolTable; }
+
     // Runtime statistics management
     
     // Set runtime statistics object
@@ -48,18 +79,42 @@ public:
     // Get runtime statistics object
     RuntimeStats* getRuntimeStats() const { return runtimeStats; }
 
+    // Counters of the line being executed (see setCurrentLine)
+    LineCounters &lineCounters() { return runtimeStats->lineCounters[currentLine]; }
 
-    // I/O callback functions for UI integration
+    // Execution control
+
+    // Line being executed (counters are credited to it)
+    void setCurrentLine(int line) { currentLine = line; }
+    int getCurrentLine() const { return currentLine; }
+
+    // Next line to execute (set by GOTO/IF, validated by the caller)
+    void setNextLine(int line) { nextLine = line; }
+    int getNextLine() const { return nextLine; }
+
+    // END reached: stop the run
+    void setEnd() { ended = true; nextLine = -1; }
+    bool isEnded() const { return ended; }
+    void recoverEnd() { ended = false; }
+
+
+    // I/O callback functions for UI integration (plain strings: front ends
+    // such as the Qt GUI convert at their side)
     // inputProvider: called by INPUT statements to get user input
-    std::function<QString()> inputProvider;
+    std::function<std::string()> inputProvider;
     
     // outputConsumer: called by PRINT statements to send output to UI
-    std::function<void(const QString&)> outputConsumer;
+    // The text is only valid during the call
+    std::function<void(std::string_view)> outputConsumer;
 
 private:
     std::map<std::string, int> symbolTable;   // Variable binding table: name -> integer value
 
     RuntimeStats* runtimeStats = nullptr;     // Pointer to runtime statistics object
+
+    int currentLine = -1;                     // Line being executed
+    int nextLine = -1;                        // Next line to execute
+    bool ended = false;                       // END statement reached
 };
 
 
@@ -0,0 +1,57 @@
+// programloader.cpp
+// Implementation of whole-text program loading
+#include "programloader.h"
+#include "parser.h"
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+// Parse each "<line number> <statement>" line and store it in the program
+std::vector<std::string> loadProgramText(const std::string &text, Program &program) {
+    std::vector<std::string> errors;
+    Parser parser;
+    std::istringstream in(text);
+    std::string raw;
+
+    while (std::getline(in, raw)) {
+        // trim surrounding whitespace (also drops '\r' of CRLF files)
+        size_t begin = raw.find_first_not_of(" \t\r\n");
+        if (begin == std::string::npos) continue;
+        size_t end = raw.find_last_not_of(" \t\r\n");
+        std::string line = raw.substr(begin, end - begin + 1);
+
+        // line number followed by at least one space
+        size_t digits = 0;
+        while (digits < line.size() && std::isdigit((unsigned char)line[digits])) ++digits;
+        if (digits == 0 || digits == line.size() || !std::isspace((unsigned char)line[digits])) {
+            errors.push_back("cannot parse line: " + line);
+            continue;
+        }
+
+        int lineNumber;
+        try {
+            lineNumber = std::stoi(line.substr(0, digits));
+        } catch (...) {
+            errors.push_back("invalid line number: " + line);
+            continue;
+        }
+        std::string code = line.substr(line.find_first_not_of(" \t", digits));
+
+        program.addSourceLine(lineNumber, code);
+        try {
+            program.setParsedStatement(lineNumber, parser.parseLine(lineNumber, code));
+        } catch (const std::exception &e) {
+            errors.push_back("line " + std::to_string(lineNumber) + ": " + e.what());
+        }
+    }
+    return errors;
+}
+
+// Read whole file, then load it
+std::vector<std::string> loadProgramFile(const std::string &path, Program &program) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("cannot open " + path);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return loadProgramText(buffer.str(), program);
+}
@@ -0,0 +1,25 @@
+/**
+ * @file    programloader.h
+ * @brief   Loads whole BASIC source texts ("<line number> <statement>" per
+ *          line) into a Program, for tools that run without the GUI
+ *
+ * @author  simple_wind
+ * @version 1.0
+ * @date    2025-12-10
+ * */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "program.h"
+
+// Parse every non-empty line of text into the program
+// Lines keep their source text even if they fail to parse (like the GUI)
+// Returns: one message per line that could not be loaded, empty on success
+std::vector<std::string> loadProgramText(const std::string &text, Program &program);
+
+// Read a file and load it with loadProgramText
+// Throws std::runtime_error if the file cannot be opened
+std::vector<std::string> loadProgramFile(const std::string &path, Program &program);
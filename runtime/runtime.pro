@@ -1,6 +1,6 @@
-QT -= gui
 TEMPLATE = lib
 CONFIG += staticlib c++17
+CONFIG -= qt
 
 INCLUDEPATH += $$PWD \
                $$PWD/../core
@@ -10,9 +10,11 @@ LIBS += \
 
 SOURCES += evalstate.cpp \
            parser.cpp \
+           programloader.cpp \
            tokenizer.cpp
 
 HEADERS += evalstate.h \
            parser.h \
+           programloader.h \
            tokenizer.h \
            token.h
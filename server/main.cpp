@@ -0,0 +1,283 @@
+#include "replsession.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Multi-session BASIC server on a Unix domain socket
+// Usage: qbasic-server <socket path> [--slice <statements>] [--quota <statements>]
+//   --slice   statements a running session may execute per event loop round
+//             (default 10000); sessions take turns so none can starve another
+//   --quota   statements one RUN may execute before it is stopped
+//             (default 100000000, 0 = unlimited)
+// Every connection is one ReplSession; one thread serves all of them from an
+// epoll loop. Try it with: socat - UNIX-CONNECT:<socket path>
+
+namespace {
+
+const size_t MAX_PENDING_OUTPUT = 1 << 20;   // stop running a session whose client does not read
+const size_t MAX_LINE = 1 << 16;
+
+struct Connection {
+    int fd;
+    ReplSession session;
+    std::string in;             // received bytes not yet forming a line
+    std::string out;            // bytes not yet accepted by the socket
+    uint32_t events = EPOLLIN | EPOLLRDHUP;    // registered with epoll
+    bool eof = false;           // the client will send nothing more
+};
+
+void usage() {
+    std::cerr << "usage: qbasic-server <socket path> [--slice <statements>] [--quota <statements>]\n";
+}
+
+bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+class Server {
+public:
+    Server(long long slice, long long quota) : slice(slice), quota(quota) {}
+
+    bool listen(const std::string &path);
+    void loop();
+
+private:
+    int listener = -1;
+    int epoll = -1;
+    long long slice;
+    long long quota;
+    std::map<int, std::unique_ptr<Connection>> connections;
+
+    void accept();
+    void receive(Connection &c);
+    bool flush(Connection &c);
+    void close(int fd);
+    void watch(Connection &c, bool writing);
+    void closeIfDone(Connection &c);
+    static bool scheduled(const Connection &c);
+};
+
+bool Server::listen(const std::string &path) {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof addr);
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof addr.sun_path) {
+        std::cerr << "qbasic-server: socket path too long\n";
+        return false;
+    }
+    std::strcpy(addr.sun_path, path.c_str());
+
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener == -1 || !setNonBlocking(listener)) {
+        std::perror("qbasic-server: socket");
+        return false;
+    }
+    ::unlink(path.c_str());
+    if (bind(listener, (sockaddr *)&addr, sizeof addr) == -1 || ::listen(listener, 128) == -1) {
+        std::perror("qbasic-server: bind");
+        return false;
+    }
+
+    epoll = epoll_create1(0);
+    epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = listener;
+    if (epoll == -1 || epoll_ctl(epoll, EPOLL_CTL_ADD, listener, &ev) == -1) {
+        std::perror("qbasic-server: epoll");
+        return false;
+    }
+    return true;
+}
+
+void Server::watch(Connection &c, bool writing) {
+    uint32_t events = (c.eof ? 0u : (uint32_t)(EPOLLIN | EPOLLRDHUP)) | (writing ? (uint32_t)EPOLLOUT : 0u);
+    if (c.events == events) return;
+    epoll_event ev;
+    ev.events = events;
+    ev.data.fd = c.fd;
+    epoll_ctl(epoll, EPOLL_CTL_MOD, c.fd, &ev);
+    c.events = events;
+}
+
+// Gets a slice this round: has work and its client keeps up with the output
+// (a throttled session waits for EPOLLOUT, which flush keeps watched)
+bool Server::scheduled(const Connection &c) {
+    return c.session.runnable() && c.out.size() <= MAX_PENDING_OUTPUT;
+}
+
+// After the client half-closed: close once the session can do nothing more
+// (finished, or waiting for input that will not come) and its output is sent
+void Server::closeIfDone(Connection &c) {
+    if (c.eof && !c.session.runnable() && c.out.empty()) close(c.fd);
+}
+
+void Server::accept() {
+    for (;;) {
+        int fd = ::accept(listener, nullptr, nullptr);
+        if (fd == -1) return;   // EAGAIN: no more pending connections
+        if (!setNonBlocking(fd)) {
+            ::close(fd);
+            continue;
+        }
+
+        std::unique_ptr<Connection> c(new Connection());
+        c->fd = fd;
+        c->session.setStatementQuota(quota);
+        epoll_event ev;
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = fd;
+        if (epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &ev) == -1) {
+            ::close(fd);
+            continue;
+        }
+        c->out = "MiniBasic server, type HELP for commands\n";
+        flush(*c);
+        connections[fd] = std::move(c);
+    }
+}
+
+// Read everything available and hand complete lines to the session
+// At end of stream the lines already received still run (a piped client
+// sends its commands and half-closes); the connection stays open until
+// they are done and their output is sent
+void Server::receive(Connection &c) {
+    char buf[4096];
+    while (!c.eof) {
+        ssize_t n = ::read(c.fd, buf, sizeof buf);
+        if (n > 0) {
+            c.in.append(buf, n);
+            continue;
+        }
+        if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n == -1) {
+            close(c.fd);        // error
+            return;
+        }
+        c.eof = true;
+        if (!c.in.empty() && c.in.back() != '\n') c.in += '\n';     // last line without newline
+    }
+
+    size_t start = 0, nl;
+    while ((nl = c.in.find('\n', start)) != std::string::npos && !c.session.closed()) {
+        c.session.handleLine(c.in.substr(start, nl - start));
+        start = nl + 1;
+    }
+    c.in.erase(0, start);
+    if (c.in.size() > MAX_LINE) c.in.clear();
+
+    c.out += c.session.takeOutput();
+    if (!flush(c) || c.session.closed()) close(c.fd);
+    else closeIfDone(c);
+}
+
+// Write as much pending output as the socket accepts; false on error
+bool Server::flush(Connection &c) {
+    while (!c.out.empty()) {
+        ssize_t n = ::send(c.fd, c.out.data(), c.out.size(), MSG_NOSIGNAL);
+        if (n == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return false;
+        }
+        c.out.erase(0, n);
+    }
+    watch(c, !c.out.empty());
+    return true;
+}
+
+void Server::close(int fd) {
+    epoll_ctl(epoll, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    connections.erase(fd);
+}
+
+void Server::loop() {
+    epoll_event events[64];
+    for (;;) {
+        // Poll without blocking while some program gets a slice
+        bool busy = false;
+        for (auto &entry : connections) {
+            if (scheduled(*entry.second)) busy = true;
+        }
+
+        int n = epoll_wait(epoll, events, 64, busy ? 0 : -1);
+        if (n == -1 && errno != EINTR) {
+            std::perror("qbasic-server: epoll_wait");
+            return;
+        }
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == listener) {
+                accept();
+                continue;
+            }
+            auto it = connections.find(fd);
+            if (it == connections.end()) continue;
+            Connection &c = *it->second;
+            if (events[i].events & EPOLLOUT) {
+                if (!flush(c)) {
+                    close(fd);
+                    continue;
+                }
+                if (c.eof) {
+                    closeIfDone(c);
+                    continue;
+                }
+            }
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) receive(c);
+        }
+
+        // One slice for every running session whose client keeps up
+        std::vector<int> done;      // write failed, or half-closed and finished
+        for (auto &entry : connections) {
+            Connection &c = *entry.second;
+            if (!scheduled(c)) continue;
+            c.session.runSlice(slice);
+            c.out += c.session.takeOutput();
+            if (!flush(c) || (c.eof && !c.session.runnable() && c.out.empty())) done.push_back(entry.first);
+        }
+        for (int fd : done) close(fd);
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string path;
+    long long slice = 10000, quota = 100000000;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--slice" && hasValue) slice = std::atoll(argv[++i]);
+        else if (arg == "--quota" && hasValue) quota = std::atoll(argv[++i]);
+        else if (path.empty() && !arg.empty() && arg[0] != '-') path = arg;
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (path.empty() || slice <= 0) {
+        usage();
+        return 2;
+    }
+
+    std::signal(SIGPIPE, SIG_IGN);
+    Server server(slice, quota);
+    if (!server.listen(path)) return 1;
+    std::cerr << "qbasic-server: listening on " << path << "\n";
+    server.loop();
+    return 1;
+}
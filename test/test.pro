@@ -21,8 +21,24 @@ SOURCES += \
 HEADERS +=\
     test_expression.h \
     test_interpreter.h \
+    test_loopanalyzer.h \
+    test_jit.h \
+    test_aot.h \
+    test_vm.h \
+    test_branchprofile.h \
+    test_linked.h \
+    test_engine.h \
+    test_trace.h \
+    test_replay.h \
+    test_snapshot.h \
+    test_debugger.h \
+    test_livestate.h \
+    test_batch.h \
+    test_spmd.h \
+    test_session.h \
     test_parser.h \
     test_statement.h \
     test_program.h \
+    test_lineindex.h \
     test_tokenizer.h
 
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <string>
+
+#include "../interpreter/batchrunner.h"
+#include "../interpreter/threadpool.h"
+#include "../runtime/programloader.h"
+
+using namespace std;
+
+void testThreadPool() {
+    WorkStealingPool pool(4);
+    assert(pool.size() == 4);
+
+    // Many small tasks, some of which spawn more work
+    std::atomic<int> done(0);
+    for (int i = 0; i < 200; ++i) {
+        pool.submit([&pool, &done, i]() {
+            if (i % 10 == 0) {
+                for (int k = 0; k < 5; ++k) pool.submit([&done]() { ++done; });
+            }
+            ++done;
+        });
+    }
+    pool.wait();
+    assert(done == 200 + 20 * 5);
+
+    // The first task exception comes out of wait(), the pool stays usable
+    pool.submit([]() { throw std::runtime_error("task failed"); });
+    bool thrown = false;
+    try {
+        pool.wait();
+    } catch (const std::runtime_error &e) {
+        thrown = std::string(e.what()) == "task failed";
+    }
+    assert(thrown);
+
+    pool.submit([&done]() { ++done; });
+    pool.wait();
+    assert(done == 301);
+
+    cout << "[PASS] work-stealing pool" << endl;
+}
+
+void testBatchSource() {
+    for (BatchEngine engine : {BatchEngine::Tree, BatchEngine::Vm, BatchEngine::Spmd}) {
+        BatchOptions options;
+        options.engine = engine;
+
+        BatchResult ok = runBatchSource(
+            "10 INPUT N\n20 LET S = 0\n30 LET S = S + N\n40 LET N = N - 1\n"
+            "50 IF N > 0 THEN 30\n60 PRINT S\n70 END\n", "abc\n4\n", options);
+        assert(ok.status == "ok");
+        assert(ok.output == "INVALID NUMBER\n10\n");
+        // INPUT, LET, 4 * (LET, LET, IF), PRINT (END is not counted)
+        assert(ok.statements == 15);
+
+        BatchResult error = runBatchSource("10 LET A = 1 / 0\n20 END\n", "", options);
+        assert(error.status == "error");
+        assert(error.message == "DIVIDE BY ZERO");
+
+        BatchResult noInput = runBatchSource("10 INPUT A\n20 END\n", "", options);
+        assert(noInput.status == "error");
+        assert(noInput.message == "END OF INPUT");
+
+        BatchResult bad = runBatchSource("10 LET = 5\n", "", options);
+        assert(bad.status == "load_error");
+
+        options.timeLimit = 0.05;
+        BatchResult forever = runBatchSource("10 LET A = 1\n20 GOTO 10\n", "", options);
+        assert(forever.status == "timeout");
+        assert(forever.message == "TIME LIMIT EXCEEDED");
+        assert(forever.statements > 0);
+    }
+    cout << "[PASS] batch runs: ok / error / input / timeout" << endl;
+}
+
+void testBatchJson() {
+    BatchResult result;
+    result.name = "dir/a \"b\".bas";
+    result.status = "error";
+    result.message = "line\n\ttab";
+    result.statements = 42;
+    result.output = "1\n";
+
+    std::string json = batchResultJson(result, true);
+    assert(json.find("\"name\":\"dir/a \\\"b\\\".bas\"") != std::string::npos);
+    assert(json.find("\"message\":\"line\\n\\ttab\"") != std::string::npos);
+    assert(json.find("\"statements\":42") != std::string::npos);
+    assert(json.find("\"output\":\"1\\n\"") != std::string::npos);
+    assert(json.find('\n') == std::string::npos);
+
+    result.message.clear();
+    assert(batchResultJson(result).find("message") == std::string::npos);
+    assert(batchResultJson(result).find("output") == std::string::npos);
+
+    cout << "[PASS] batch JSON lines" << endl;
+}
+
+void testBatchMissingFile() {
+    BatchJob job;
+    job.name = "missing.bas";
+    job.programPath = "/nonexistent/missing.bas";
+    std::vector<BatchResult> results = runBatch({job, job}, BatchOptions());
+    assert(results.size() == 2);
+    assert(results[0].status == "load_error");
+    assert(results[1].name == "missing.bas");
+    cout << "[PASS] batch reports unreadable programs" << endl;
+}
+
+void testSweep() {
+    auto vectors = parseSweepVectors("1 2\n# comment\n\n3,4\n5 x 6\n7\n");
+    assert(vectors.size() == 4);
+    assert(vectors[1] == std::vector<std::string>({"3", "4"}));
+    assert(vectors[2].size() == 3);
+
+    Program program;
+    assert(loadProgramText("10 INPUT A\n20 INPUT B\n30 PRINT A * B\n40 END\n", program).empty());
+
+    std::vector<std::vector<std::string>> many;
+    for (int i = 0; i < 500; ++i) many.push_back({std::to_string(i), std::to_string(i + 1)});
+
+    for (BatchEngine engine : {BatchEngine::Tree, BatchEngine::Vm, BatchEngine::Spmd}) {
+        BatchOptions options;
+        options.threads = 4;
+        options.engine = engine;
+
+        std::vector<std::string> reported;
+        std::vector<BatchResult> results = runSweep(program, many, options, [&](const BatchResult &r) {
+            reported.push_back(r.name);
+        });
+        assert(results.size() == many.size());
+        assert(reported.size() == many.size());
+        for (int i = 0; i < 500; ++i) {
+            assert(results[i].status == "ok");
+            assert(results[i].output == std::to_string(i * (i + 1)) + "\n");
+            assert(reported[i] == std::to_string(i) + " " + std::to_string(i + 1));
+            assert(results[i].statements == 3);
+        }
+
+        // Bad values are retried like in the GUI, short vectors run out of input
+        results = runSweep(program, vectors, options);
+        assert(results[2].output == "INVALID NUMBER\n30\n");
+        assert(results[3].status == "error" && results[3].message == "END OF INPUT");
+    }
+    cout << "[PASS] parameter sweep in input order" << endl;
+}
+
+void testBatchLoopDetection() {
+    for (BatchEngine engine : {BatchEngine::Tree, BatchEngine::Vm}) {
+        BatchOptions options;
+        options.engine = engine;
+        options.detectLoops = true;
+        options.timeLimit = 10;
+
+        BatchResult forever = runBatchSource("10 LET A = 1\n20 GOTO 10\n", "", options);
+        assert(forever.status == "loop");
+        assert(forever.message == "INFINITE LOOP: LINES 10, 20 REPEAT WITH THE SAME VARIABLES");
+
+        // Coming back to the same INPUT with the same values is not a proof
+        std::string input;
+        for (int i = 0; i < 100; ++i) input += "0\n";
+        BatchResult polling = runBatchSource("10 INPUT A\n20 IF A = 0 THEN 10\n30 PRINT A\n40 END\n",
+                                             input + "7\n", options);
+        assert(polling.status == "ok");
+        assert(polling.output == "7\n");
+    }
+    cout << "[PASS] batch loop detection" << endl;
+}
+
+void testSweepProfile() {
+    Program program;
+    loadProgramText("10 INPUT N\n20 LET I = 0\n30 IF I MOD 4 > 0 THEN 50\n40 LET N = N + 1\n"
+                    "50 LET I = I + 1\n60 IF I < 1000 THEN 30\n70 PRINT N\n80 END\n", program);
+    std::vector<std::vector<std::string>> vectors = {{"1"}, {"2"}, {"3"}, {"4"}};
+
+    // Training runs on several threads add up to one profile
+    BranchProfile trained;
+    BatchOptions options;
+    options.threads = 4;
+    options.training = &trained;
+    std::vector<BatchResult> plain = runSweep(program, vectors, options);
+    assert(trained.runs == 4);
+    assert(trained.line(30).executed == 4000 && trained.line(30).taken == 3000);
+
+    options.training = nullptr;
+    options.profile = &trained;
+    std::vector<BatchResult> guided = runSweep(program, vectors, options);
+    for (size_t i = 0; i < vectors.size(); ++i) {
+        assert(guided[i].status == "ok" && guided[i].output == plain[i].output);
+        assert(guided[i].statements == plain[i].statements);
+    }
+
+    // Runs of another program are not merged
+    options.training = &trained;
+    options.profile = nullptr;
+    BatchResult mixed = runBatchSource("10 PRINT 1\n20 END\n", "", options);
+    assert(mixed.status == "error" && mixed.message == "PROFILE OF A DIFFERENT PROGRAM");
+    cout << "[PASS] sweep profile" << endl;
+}
+
+void runBatchTests() {
+    testThreadPool();
+    testBatchSource();
+    testBatchJson();
+    testBatchMissingFile();
+    testSweep();
+    testBatchLoopDetection();
+    testSweepProfile();
+}
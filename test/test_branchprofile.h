@@ -0,0 +1,192 @@
+#pragma once
+
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../interpreter/branchprofile.h"
+#include "../interpreter/interpreter.h"
+#include "../interpreter/vm.h"
+#include "test_loopanalyzer.h"
+#include "test_vm.h"
+
+using namespace std;
+
+// The register machine, laid out with `profile` if there is one
+EngineRun profiledVm(const Program &p, const BranchProfile *profile = nullptr) {
+    return [&p, profile](Interpreter &itp) {
+        itp.setVmEnabled(true);
+        itp.setBranchProfile(profile);
+        itp.run(p);
+    };
+}
+
+// Train on `training` inputs, then check a run on `inputs` against the tree walker
+void checkProfiledMatches(const std::string &name, const std::vector<std::string> &lines,
+                          const std::vector<int> &training = {}, const std::vector<int> &inputs = {}) {
+    Program p;
+    loadLoopProgram(p, lines);
+    BranchProfile profile;
+    profile.add(p, recordRun(p, training, profiledVm(p)).stats);
+    checkRunMatches(name, p, profiledVm(p, &profile), inputs);
+}
+
+void testBranchProfileFile() {
+    Program p;
+    loadLoopProgram(p, {
+        "10 LET I = 0",
+        "20 LET I = I + 1",
+        "30 IF I < 10 THEN 20",
+        "40 END"
+    });
+    BranchProfile profile;
+    profile.add(p, recordRun(p, {}).stats);
+    profile.add(p, recordRun(p, {}, profiledVm(p)).stats);
+    assert(profile.runs == 2);
+    assert(profile.line(30).executed == 20 && profile.line(30).taken == 18);
+    assert(profile.line(40).executed == 0);     // END is not counted
+
+    std::stringstream file;
+    profile.save(file);
+    BranchProfile loaded = BranchProfile::load(file);
+    assert(loaded.programHash == profile.programHash && loaded.runs == 2);
+    assert(loaded.line(20).executed == 20 && loaded.line(30).taken == 18);
+
+    // Tied to its program
+    Program other;
+    loadLoopProgram(other, {"10 LET I = 1", "20 END"});
+    assert(!loaded.matches(other) && BranchProfile().matches(other));
+    bool refused = false;
+    try {
+        RegisterVM vm(other, &loaded);
+    } catch (const std::runtime_error &e) {
+        refused = std::string(e.what()) == "PROFILE OF A DIFFERENT PROGRAM";
+    }
+    assert(refused);
+
+    std::stringstream bad("QBPROFILE 1\nprogram 1\n");
+    refused = false;
+    try {
+        BranchProfile::load(bad);
+    } catch (const std::runtime_error &e) {
+        refused = std::string(e.what()) == "truncated profile file";
+    }
+    assert(refused);
+
+    cout << "[PASS] testBranchProfileFile" << endl;
+}
+
+void testBranchProfileLayout() {
+    // The forward jump is taken 9 times out of 10
+    std::vector<std::string> skewed = {
+        "10 LET A = 0",
+        "20 LET I = 0",
+        "30 IF I MOD 10 > 0 THEN 60",
+        "40 LET A = A + 1",
+        "50 GOTO 70",
+        "60 LET A = A + 2",
+        "70 LET I = I + 1",
+        "80 IF I < 1000 THEN 30",
+        "90 PRINT A",
+        "100 END"
+    };
+    Program p;
+    loadLoopProgram(p, skewed);
+    BranchProfile profile;
+    profile.add(p, recordRun(p, {}, profiledVm(p)).stats);
+
+    // Line 60 is placed after 30, which now jumps when its IF is false; the
+    // loop counter and the back edge are one instruction
+    RegisterVM plain(p), guided(p, &profile);
+    std::string listing = guided.disassemble();
+    assert(plain.disassemble().find("JLE") == std::string::npos);
+    assert(listing.find("JLE") != std::string::npos);
+    assert(listing.find("ADDJLT I, I, 1") != std::string::npos);
+    assert(listing.find("30:\n  5 COUNT b1\n") != std::string::npos);
+    assert(listing.find("JLE t0, 0, @") != std::string::npos);
+    assert(listing.find("\n60:\n", listing.find("\n30:\n")) < listing.find("\n40:\n"));
+
+    // Same counters, so a profile of a guided run equals the training profile
+    EvalState state;
+    guided.run(state, p);
+    BranchProfile again;
+    again.add(p, *state.getRuntimeStats());
+    std::stringstream first, second;
+    profile.save(first);
+    again.save(second);
+    assert(first.str() == second.str());
+
+    checkProfiledMatches("skewed", skewed);
+
+    // A GOTO to the block placed next is dropped: here all of them
+    std::vector<std::string> jumps = {
+        "10 LET I = 0",
+        "20 GOTO 50",
+        "30 LET I = I + 3",
+        "40 GOTO 70",
+        "50 LET I = I + 1",
+        "60 GOTO 30",
+        "70 IF I < 100 THEN 50",
+        "80 END"
+    };
+    Program q;
+    loadLoopProgram(q, jumps);
+    BranchProfile trained;
+    trained.add(q, recordRun(q, {}, profiledVm(q)).stats);
+    assert(RegisterVM(q, &trained).disassemble().find("JMP") == std::string::npos);
+    checkProfiledMatches("goto", jumps);
+    cout << "[PASS] testBranchProfileLayout" << endl;
+}
+
+void testBranchProfileMatchesInterpreter() {
+    checkProfiledMatches("input", {
+        "10 INPUT N",
+        "20 LET I = 0",
+        "30 LET I = I + 1",
+        "40 PRINT I * N",
+        "50 IF I < N THEN 30",
+        "60 IF I = N THEN 80",
+        "70 GOTO 90",
+        "80 REM jumped",
+        "90 END"
+    }, {7}, {3});
+    checkProfiledMatches("fall off", {
+        "10 LET I = 0",
+        "20 LET I = I + 1",
+        "30 IF I < 50 THEN 20",
+        "40 IF I = 50 THEN 20"
+    });
+    checkProfiledMatches("divide", {
+        "10 LET I = 3",
+        "20 LET Q = 100 / I",
+        "30 LET I = I - 1",
+        "40 IF I > 0 - 1 THEN 20",
+        "50 END"
+    });
+    checkProfiledMatches("undefined", {
+        "10 LET I = 0",
+        "20 LET I = I + 1",
+        "30 IF I < 5 THEN 20",
+        "40 PRINT I + Y",
+        "50 END"
+    });
+    // Trained on inputs that take the other branches
+    checkProfiledMatches("other inputs", {
+        "10 INPUT N",
+        "20 IF N > 5 THEN 50",
+        "30 PRINT N",
+        "40 GOTO 10",
+        "50 PRINT 0 - N",
+        "60 IF N < 100 THEN 10",
+        "70 END"
+    }, {6, 7, 8, 9, 200}, {1, 2, 9, 3, 300});
+    cout << "[PASS] testBranchProfileMatchesInterpreter" << endl;
+}
+
+void runBranchProfileTests() {
+    testBranchProfileFile();
+    testBranchProfileLayout();
+    testBranchProfileMatchesInterpreter();
+}
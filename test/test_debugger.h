@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../interpreter/debugger.h"
+#include "../interpreter/interpreter.h"
+#include "../runtime/programloader.h"
+
+using namespace std;
+
+const char *DEBUG_PROGRAM =
+    "10 LET S = 0\n"
+    "20 LET I = 0\n"
+    "30 LET S = S + I\n"
+    "40 LET I = I + 1\n"
+    "50 IF I < 10 THEN 30\n"
+    "55 REM done\n"
+    "60 PRINT S\n"
+    "70 END\n";
+
+void testInterpreterStep() {
+    Program p;
+    loadProgramText(DEBUG_PROGRAM, p);
+
+    // Stepping the whole run matches run(), counters included
+    Interpreter reference;
+    string expected;
+    reference.setOutputConsumer([&](std::string_view s) { expected += s; });
+    reference.run(p);
+
+    Interpreter itp;
+    string output;
+    itp.setOutputConsumer([&](std::string_view s) { output += s; });
+    int steps = 0;
+    while (itp.step(p)) ++steps;
+    assert(steps == 2 + 3 * 10 + 2 + 1 - 1);
+    assert(!itp.isSuspended());
+    assert(output == expected && itp.getState().getVariables() == reference.getState().getVariables());
+    assert(itp.toSyntaxTree(p) == reference.toSyntaxTree(p));
+
+    // A new call starts a new run; an error ends it
+    assert(itp.step(p) && itp.getState().getNextLine() == 20);
+    p.removeSourceLine(70);
+    while (itp.getState().getNextLine() != 60) itp.step(p);
+    bool thrown = false;
+    try {
+        itp.step(p);
+    } catch (const std::runtime_error &e) {
+        thrown = string(e.what()) == "Goto none-exsiting line";
+    }
+    assert(thrown && !itp.isSuspended());
+
+    cout << "[PASS] testInterpreterStep" << endl;
+}
+
+void testDebuggerStops() {
+    Program p;
+    loadProgramText(DEBUG_PROGRAM, p);
+    Debugger debugger(p);
+    Interpreter itp;
+    itp.setOutputConsumer([](std::string_view) {});
+
+    // Stepping into a new run stops before the first line
+    DebugStop stop = debugger.stepInto(itp);
+    assert(stop.event == DebugEvent::Step && stop.line == 10);
+    stop = debugger.stepInto(itp);
+    assert(stop.event == DebugEvent::Step && stop.line == 20);
+
+    // Conditional breakpoint: only when I reaches 4
+    debugger.setBreakpoint(40, "I = 4");
+    stop = debugger.continueRun(itp);
+    assert(stop.event == DebugEvent::Breakpoint && stop.line == 40);
+    assert(itp.getState().getValue("I") == 4 && itp.getState().getValue("S") == 0 + 1 + 2 + 3 + 4);
+
+    // Evaluating the condition did not count as a use of I
+    Interpreter plain;
+    plain.setOutputConsumer([](std::string_view) {});
+    while (plain.getState().getNextLine() != 40 || !plain.isSuspended() || plain.getState().getValue("I") != 4)
+        plain.step(p);
+    assert(plain.toSyntaxTree(p) == itp.toSyntaxTree(p));
+
+    // Watchpoint: S changes on line 30 (I = 5 adds 5)
+    debugger.clearBreakpoint(40);
+    debugger.watch("S");
+    stop = debugger.continueRun(itp);
+    assert(stop.event == DebugEvent::Watchpoint && stop.variable == "S");
+    assert(stop.wasDefined && stop.oldValue == 10 && stop.newValue == 15 && stop.line == 40);
+
+    // Step over the loop back edge: control comes back below line 50
+    debugger.unwatch("S");
+    stop = debugger.stepOver(itp);
+    assert(stop.event == DebugEvent::Step && stop.line == 50);
+    stop = debugger.stepOver(itp);
+    assert(stop.event == DebugEvent::Step && stop.line == 55);
+    assert(itp.getState().getValue("I") == 10);
+
+    // A breakpoint on a line without effect still stops; then run to the end
+    debugger.setBreakpoint(60);
+    stop = debugger.continueRun(itp);
+    assert(stop.event == DebugEvent::Breakpoint && stop.line == 60);
+    stop = debugger.continueRun(itp);
+    assert(stop.event == DebugEvent::Finished && !itp.isSuspended());
+    assert(itp.getState().getValue("S") == 45);
+
+    // A breakpoint on the first line stops a new run before it executes;
+    // a condition on an undefined variable never holds
+    debugger.clearAll();
+    debugger.setBreakpoint(10);
+    debugger.setBreakpoint(30, "Q > 0");
+    Interpreter fresh;
+    fresh.setOutputConsumer([](std::string_view) {});
+    stop = debugger.continueRun(fresh);
+    assert(stop.event == DebugEvent::Breakpoint && stop.line == 10 && !fresh.getState().isDefined("S"));
+    stop = debugger.continueRun(fresh);
+    assert(stop.event == DebugEvent::Finished);
+
+    bool thrown = false;
+    try {
+        debugger.setBreakpoint(30, "I <");
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    cout << "[PASS] testDebuggerStops" << endl;
+}
+
+void testDebuggerFullSpeed() {
+    // Without stops the run goes through the normal engines
+    Program p;
+    loadProgramText(
+        "10 LET I = 0\n"
+        "20 LET I = I + 1\n"
+        "30 IF I < 50000000 THEN 20\n"
+        "40 END\n", p);
+    Debugger debugger(p);
+    Interpreter itp;
+    DebugStop stop = debugger.continueRun(itp);
+    assert(stop.event == DebugEvent::Finished);
+    assert(itp.getState().getValue("I") == 50000000);
+    assert(itp.getState().getRuntimeStats()->getLineCounters(20).execCount == 50000000);
+
+    // Stops outside the loop leave it to the engines as well
+    Program q;
+    loadProgramText(
+        "10 LET I = 0\n"
+        "20 LET I = I + 1\n"
+        "30 IF I < 50000000 THEN 20\n"
+        "40 LET J = I\n"
+        "50 END\n", q);
+    Debugger stops(q);
+    stops.setBreakpoint(40);
+    stops.watch("J");
+    Interpreter run;
+    stop = stops.continueRun(run);
+    assert(stop.event == DebugEvent::Breakpoint && stop.line == 40);
+    assert(run.getState().getValue("I") == 50000000);
+    stop = stops.continueRun(run);
+    assert(stop.event == DebugEvent::Watchpoint && stop.variable == "J");
+    assert(stop.newValue == 50000000 && stop.line == 50);
+    assert(stops.continueRun(run).event == DebugEvent::Finished);
+    assert(run.getState().getRuntimeStats()->getLineCounters(30).execCount == 50000000);
+
+    cout << "[PASS] testDebuggerFullSpeed" << endl;
+}
+
+void runDebuggerTests() {
+    testInterpreterStep();
+    testDebuggerStops();
+    testDebuggerFullSpeed();
+}
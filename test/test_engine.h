@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../interpreter/engine.h"
+#include "../interpreter/interpreter.h"
+#include "../runtime/programloader.h"
+
+using namespace std;
+
+const char *ENGINE_RULE =
+    "10 LET T = 0\n"
+    "20 LET I = 0\n"
+    "30 IF I > N THEN 70\n"
+    "40 LET T = T + I * K MOD 13\n"
+    "50 LET I = I + 1\n"
+    "60 GOTO 30\n"
+    "70 LET SCORE = T / (N + 1)\n"
+    "80 END\n";
+
+// Value of SCORE computed by the tree-walking interpreter
+int engineReference(int n, int k) {
+    Program p;
+    loadProgramText(ENGINE_RULE, p);
+    Interpreter itp;
+    itp.setJitEnabled(false);
+    itp.getState().setValue("N", n);
+    itp.getState().setValue("K", k);
+    itp.run(p);
+    return itp.getState().getValue("SCORE");
+}
+
+void testEngineEvaluate() {
+    CompiledProgram rule(ENGINE_RULE);
+    Evaluation eval(rule);
+    int n = eval.slot("N"), k = eval.slot("K"), score = eval.slot("SCORE");
+    assert(n >= 0 && k >= 0 && score >= 0);
+    assert(eval.slot("Q") == -1);
+    assert(rule.variableName(score) == "SCORE");
+
+    for (int i = 0; i < 200; ++i) {
+        eval.set(n, i % 37);
+        eval.set(k, i - 100);
+        eval.run();
+        assert(eval.get(score) == engineReference(i % 37, i - 100));
+    }
+
+    // By name, and results stay until reset
+    eval.set("N", 5);
+    eval.set("K", 3);
+    eval.run();
+    assert(eval.get("SCORE") == engineReference(5, 3));
+    eval.reset();
+    assert(!eval.isDefined(score));
+
+    bool thrown = false;
+    try {
+        eval.set("Q", 1);
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    cout << "[PASS] testEngineEvaluate" << endl;
+}
+
+void testEngineErrors() {
+    bool thrown = false;
+    try {
+        CompiledProgram broken("10 LET X = \n20 PRINT X\n");
+    } catch (const std::runtime_error &e) {
+        thrown = string(e.what()).find("SYNTAX ERROR") == 0;
+    }
+    assert(thrown);
+
+    CompiledProgram rule("10 LET Y = 100 / X\n20 PRINT Y\n30 END\n");
+    Evaluation eval(rule);
+    string out;
+    eval.setOutputConsumer([&](std::string_view s) { out += s; });
+
+    // Unbound input and runtime errors read like Interpreter::run
+    string message;
+    try {
+        eval.run();
+    } catch (const std::runtime_error &e) {
+        message = e.what();
+    }
+    assert(message == "VARIABLE NOT DEFINED: X");
+
+    eval.set("X", 0);
+    try {
+        eval.run();
+    } catch (const std::runtime_error &e) {
+        message = e.what();
+    }
+    assert(message == "DIVIDE BY ZERO");
+    assert(!eval.isDefined(eval.slot("Y")));
+
+    // The next evaluation is not affected by the failed one
+    eval.set("X", 7);
+    eval.run();
+    assert(eval.get("Y") == 14 && out == "14\n");
+
+    cout << "[PASS] testEngineErrors" << endl;
+}
+
+void testEngineInput() {
+    CompiledProgram rule("10 INPUT A\n20 LET B = A * A\n30 PRINT B + C\n");
+    Evaluation eval(rule);
+    vector<string> lines = {"6", "x", "-3"};
+    size_t next = 0;
+    string out;
+    eval.setInputProvider([&]() { return lines[next++]; });
+    eval.setOutputConsumer([&](std::string_view s) { out += s; });
+
+    eval.set("C", 1);
+    bool fellOff = false;
+    try {
+        eval.run();
+    } catch (const std::runtime_error &e) {
+        fellOff = string(e.what()) == "Goto none-exsiting line";
+    }
+    assert(fellOff);
+    assert(eval.get("A") == 6 && eval.get("B") == 36 && out == "37\n");
+
+    // Invalid input is asked again, as with the interpreter
+    out.clear();
+    try {
+        eval.run();
+    } catch (const std::runtime_error &) {
+    }
+    assert(eval.get("A") == -3 && out == "INVALID NUMBER\n10\n");
+
+    // An INPUT on the last line keeps what it read
+    CompiledProgram last("10 LET A = 1\n20 INPUT A\n");
+    Evaluation tail(last);
+    tail.setInputProvider([]() { return string("4"); });
+    try {
+        tail.run();
+    } catch (const std::runtime_error &) {
+    }
+    assert(tail.get("A") == 4);
+
+    cout << "[PASS] testEngineInput" << endl;
+}
+
+void testEngineSharedAcrossThreads() {
+    CompiledProgram rule(ENGINE_RULE);
+    vector<int> expected(8);
+    for (int t = 0; t < 8; ++t) expected[t] = engineReference(20 + t, t);
+
+    vector<int> bad(4, 0);
+    vector<thread> threads;
+    for (int w = 0; w < 4; ++w) {
+        threads.emplace_back([&rule, &expected, &bad, w]() {
+            Evaluation eval(rule);
+            for (int i = 0; i < 2000; ++i) {
+                int t = (i + w) % 8;
+                eval.set("N", 20 + t);
+                eval.set("K", t);
+                eval.run();
+                if (eval.get("SCORE") != expected[t]) ++bad[w];
+            }
+        });
+    }
+    for (thread &t : threads) t.join();
+    for (int b : bad) assert(b == 0);
+
+    cout << "[PASS] testEngineSharedAcrossThreads" << endl;
+}
+
+void runEngineTests() {
+    testEngineEvaluate();
+    testEngineErrors();
+    testEngineInput();
+    testEngineSharedAcrossThreads();
+}
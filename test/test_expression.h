@@ -2,6 +2,7 @@
 
 #include <cassert>
 #include <iostream>
+#include <sstream>
 #include "exp.h"
 #include "evalstate.h"
 
@@ -50,11 +51,42 @@ void testCompoundExp() {
     delete exp;
 }
 
+// 测试 syntax tree 流式输出
+void testExpressionSyntaxTree() {
+    Expression* exp =
+        new CompoundExp("*", new IdentifierExp("A"),
+                        new CompoundExp("-", new ConstantExp(3), new IdentifierExp("B")));
+
+    assert(exp->toSyntaxTree(1) == "  *\n    A\n    -\n      3\n      B");
+    ostringstream out;
+    exp->writeSyntaxTree(out, 1);
+    assert(out.str() == exp->toSyntaxTree(1));
+    delete exp;
+
+    // A deep chain is written in one pass: level k is indented 2k spaces
+    const int depth = 3000;
+    Expression* deep = new ConstantExp(0);
+    for (int i = 1; i <= depth; ++i) deep = new CompoundExp("+", deep, new ConstantExp(i));
+    ostringstream deepOut;
+    deep->writeSyntaxTree(deepOut);
+    size_t expected = 0;
+    for (int k = 0; k < depth; ++k) {
+        expected += 2 * k + 2;                                       // "+\n" at level k
+        expected += 2 * (k + 1) + to_string(depth - k).size() + 1;   // right operand line
+    }
+    expected += 2 * depth + 1;                                       // innermost "0", no newline
+    assert(deepOut.str().size() == expected);
+    delete deep;
+
+    cout << "[PASS] testExpressionSyntaxTree" << endl;
+}
+
 // 暴露给 main 调用
 void runExpressionTests() {
     testConstantExp();
     testIdentifierExp();
     testCompoundExp();
+    testExpressionSyntaxTree();
     cout << "All Expression tests passed!" << endl;
 }
 
@@ -3,14 +3,19 @@
 #include"../interpreter/interpreter.h"
 #include"../core/program.h"
 #include"../runtime/parser.h"
+#include"../runtime/programloader.h"
+#include"../interpreter/cycledetector.h"
+#include<cassert>
 #include<iostream>
+#include<thread>
+#include<vector>
 
 void testInterpreter(){
     Interpreter itp;
 
     // 设置回调
-    // itp.setOutputConsumer([](const QString &s) {
-    //     std::cout << s.toStdString() << std::endl;
+    // itp.setOutputConsumer([](std::string_view s) {
+    //     std::cout << s << std::endl;
     // });
 
     std::cout<<"program loading"<<std::endl;
@@ -84,3 +89,314 @@ void testInterpreter(){
 
 
 }
+
+// Several runs share one read-only Program; each has its own EvalState
+void testConcurrentRuns(){
+    Program p;
+    std::vector<std::string> errors = loadProgramText(
+        "10 LET S = 0\n"
+        "20 LET I = 0\n"
+        "30 LET S = S + I * I MOD 11\n"
+        "40 LET I = I + 1\n"
+        "50 IF I < 20000 THEN 30\n"
+        "60 IF S > 0 THEN 80\n"
+        "70 LET S = 0 - 1\n"
+        "80 END\n", p);
+    assert(errors.empty());
+
+    Interpreter reference;
+    reference.setLoopAcceleration(false);
+    reference.setJitEnabled(false);
+    reference.run(p);
+    std::string expectedTree = reference.toSyntaxTree(p);
+    int expectedSum = reference.getState().getValue("S");
+
+    const int threads = 4;
+    std::vector<std::string> trees(threads);
+    std::vector<int> sums(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            Interpreter itp;
+            itp.setLoopAcceleration(t % 2 == 0);
+            itp.setVmEnabled(t == 3);
+            for (int round = 0; round < 3; ++round) {
+                itp.reset();
+                itp.run(p);
+            }
+            trees[t] = itp.toSyntaxTree(p);
+            sums[t] = itp.getState().getValue("S");
+        });
+    }
+    for (std::thread &w : workers) w.join();
+
+    for (int t = 0; t < threads; ++t) {
+        assert(trees[t] == expectedTree);
+        assert(sums[t] == expectedSum);
+    }
+    std::cout << "[PASS] testConcurrentRuns" << std::endl;
+}
+
+// INPUT suspends a resumable run instead of blocking
+void testResumableRun(){
+    Program p;
+    assert(loadProgramText(
+        "10 INPUT A\n"
+        "20 INPUT B\n"
+        "30 PRINT A * B\n"
+        "40 END\n", p).empty());
+
+    Interpreter itp;
+    std::string out;
+    itp.setOutputConsumer([&](std::string_view s) { out += s; });
+
+    assert(itp.runUntilBlocked(p) == RunStatus::NeedsInput);
+    assert(itp.isSuspended());
+    assert(itp.getState().getNextLine() == 10);
+
+    itp.supplyInput("abc");
+    assert(itp.runUntilBlocked(p) == RunStatus::NeedsInput);
+    assert(out == "INVALID NUMBER\n");
+
+    itp.supplyInput("6");
+    assert(itp.runUntilBlocked(p) == RunStatus::NeedsInput);
+    assert(itp.getState().getNextLine() == 20);
+
+    itp.supplyInput("7");
+    assert(itp.runUntilBlocked(p) == RunStatus::Finished);
+    assert(!itp.isSuspended());
+    assert(out == "INVALID NUMBER\n42\n");
+
+    // Counters match a blocking run with the same input
+    Interpreter blocking;
+    std::vector<std::string> lines = {"abc", "6", "7"};
+    size_t next = 0;
+    blocking.setInputProvider([&]() { return lines[next++]; });
+    blocking.setOutputConsumer([](std::string_view) {});
+    blocking.run(p);
+    assert(blocking.toSyntaxTree(p) == itp.toSyntaxTree(p));
+
+    std::cout << "[PASS] testResumableRun" << std::endl;
+}
+
+// One thread drives many suspended sessions in time slices
+void testInterleavedSessions(){
+    Program p;
+    assert(loadProgramText(
+        "10 INPUT N\n"
+        "20 LET S = 0\n"
+        "30 LET S = S + N\n"
+        "40 LET N = N - 1\n"
+        "50 IF N > 0 THEN 30\n"
+        "60 PRINT S\n"
+        "70 END\n", p).empty());
+
+    const int sessions = 1000;
+    std::vector<Interpreter> itps(sessions);
+    std::vector<std::string> outs(sessions);
+    for (int i = 0; i < sessions; ++i)
+        itps[i].setOutputConsumer([&outs, i](std::string_view s) { outs[i] += s; });
+
+    int finished = 0;
+    std::vector<bool> done(sessions, false);
+    while (finished < sessions) {
+        for (int i = 0; i < sessions; ++i) {
+            if (done[i]) continue;
+            RunStatus status = itps[i].runUntilBlocked(p, 16);
+            if (status == RunStatus::NeedsInput) itps[i].supplyInput(std::to_string(i % 50));
+            if (status == RunStatus::Finished) {
+                done[i] = true;
+                ++finished;
+            }
+        }
+    }
+    for (int i = 0; i < sessions; ++i) {
+        int n = i % 50;
+        // N = 0 still runs the loop body once
+        int expected = n == 0 ? 0 : n * (n + 1) / 2;
+        assert(outs[i] == std::to_string(expected) + "\n");
+    }
+    std::cout << "[PASS] testInterleavedSessions" << std::endl;
+}
+
+void testRunLimits(){
+    Program p;
+    assert(loadProgramText(
+        "10 LET I = 0\n"
+        "20 LET I = I + 1\n"
+        "30 LET J = I * 2\n"
+        "40 IF I < 100 THEN 20\n"
+        "50 PRINT I\n"
+        "60 END\n", p).empty());
+    const long long total = 1 + 100 * 3 + 1;   // END is free
+
+    for (int vm = 0; vm < 2; ++vm) {
+        // Unlimited runs report the fuel they used
+        Interpreter free;
+        free.setVmEnabled(vm);
+        free.setOutputConsumer([](std::string_view) {});
+        free.run(p);
+        assert(free.lastFuelUsed() == total);
+
+        // Exactly enough fuel finishes the program
+        Interpreter exact;
+        exact.setVmEnabled(vm);
+        exact.setOutputConsumer([](std::string_view) {});
+        RunLimits enough;
+        enough.fuel = total;
+        exact.setRunLimits(enough);
+        exact.run(p);
+        assert(exact.lastFuelUsed() == total);
+
+        // One statement less stops before PRINT, with every counter so far kept
+        for (long long fuel : {total - 1, 150LL, 1LL}) {
+            Interpreter itp;
+            itp.setVmEnabled(vm);
+            std::string out;
+            itp.setOutputConsumer([&](std::string_view s) { out += s; });
+            RunLimits limits;
+            limits.fuel = fuel;
+            itp.setRunLimits(limits);
+            bool stopped = false;
+            try {
+                itp.run(p);
+            } catch (const FuelExhaustedError &e) {
+                stopped = std::string(e.what()) == "FUEL EXHAUSTED";
+            }
+            assert(stopped);
+            assert(itp.lastFuelUsed() == fuel);
+            assert(out.empty());
+        }
+    }
+
+    // An endless loop no longer pins a core
+    Program spin;
+    assert(loadProgramText("10 LET X = 1\n20 GOTO 10\n", spin).empty());
+    for (int vm = 0; vm < 2; ++vm) {
+        Interpreter itp;
+        itp.setVmEnabled(vm);
+        RunLimits limits;
+        limits.fuel = 5000;
+        itp.setRunLimits(limits);
+        try {
+            itp.run(spin);
+            assert(false);
+        } catch (const ResourceLimitError &) {}
+        assert(itp.lastFuelUsed() == 5000);
+
+        Interpreter timed;
+        timed.setVmEnabled(vm);
+        limits = RunLimits();
+        limits.seconds = 0.05;
+        timed.setRunLimits(limits);
+        try {
+            timed.run(spin);
+            assert(false);
+        } catch (const TimeLimitError &) {}
+        assert(timed.lastFuelUsed() > 0);
+    }
+
+    // Output beyond the limit is refused; what fits is written
+    Program chatty;
+    assert(loadProgramText(
+        "10 LET I = 0\n"
+        "20 LET I = I + 1\n"
+        "30 PRINT I\n"
+        "40 GOTO 20\n", chatty).empty());
+    for (int vm = 0; vm < 2; ++vm) {
+        Interpreter itp;
+        itp.setVmEnabled(vm);
+        std::string out;
+        itp.setOutputConsumer([&](std::string_view s) { out += s; });
+        RunLimits limits;
+        limits.maxOutput = 20;
+        itp.setRunLimits(limits);
+        try {
+            itp.run(chatty);
+            assert(false);
+        } catch (const OutputLimitError &) {}
+        assert(out == "1\n2\n3\n4\n5\n6\n7\n8\n9\n");     // "10\n" would make 21 bytes
+        assert(itp.getState().getValue("I") == 10);
+
+        // The limit applies per run and the consumer is restored afterwards
+        Program shortRun;
+        assert(loadProgramText("10 PRINT 12345\n20 PRINT 67890\n", shortRun).empty());
+        out.clear();
+        try {
+            itp.run(shortRun);
+        } catch (const std::runtime_error &) {}    // falls off the last line
+        assert(out == "12345\n67890\n");
+        assert(bool(itp.getState().outputConsumer));
+    }
+
+    std::cout << "[PASS] testRunLimits" << std::endl;
+}
+
+void testCycleDetection(){
+    struct Case {
+        const char *source;
+        const char *message;
+        int printLine;          // line with PRINT, 0 if none
+    };
+    const Case endless[] = {
+        // Same state at every back edge
+        {"10 LET X = 1\n20 GOTO 10\n",
+         "INFINITE LOOP: LINES 10, 20 REPEAT WITH THE SAME VARIABLES", 0},
+        // Period of two back edges
+        {"10 LET A = 0\n20 LET A = 1 - A\n30 IF A < 5 THEN 20\n40 END\n",
+         "INFINITE LOOP: LINES 20, 30 REPEAT WITH THE SAME VARIABLES", 0},
+        // Period longer than the recent history (found by the checkpoint)
+        {"10 LET I = 0\n20 LET I = (I + 1) MOD 1000\n30 PRINT I\n40 IF I > 5000 THEN 60\n50 GOTO 20\n60 END\n",
+         "INFINITE LOOP: LINES 20, 30, 40, 50 REPEAT WITH THE SAME VARIABLES", 30},
+    };
+
+    for (const Case &c : endless) {
+        Program p;
+        assert(loadProgramText(c.source, p).empty());
+        for (int vm = 0; vm < 2; ++vm) {
+            Interpreter itp;
+            itp.setVmEnabled(vm);
+            itp.setCycleDetection(true);
+            itp.setTimeLimit(10);
+            long long printed = 0;
+            itp.setOutputConsumer([&](std::string_view) { ++printed; });
+            std::string message;
+            try {
+                itp.run(p);
+            } catch (const InfiniteLoopError &e) {
+                message = e.what();
+            }
+            assert(message == c.message);
+            // Naming the lines replays the cycle without printing or counting
+            int prints = itp.getState().getRuntimeStats()->getLineCounters(c.printLine).execCount;
+            assert(printed == prints);
+        }
+    }
+
+    // Loops that end are left alone and count as usual
+    Program counting;
+    assert(loadProgramText(
+        "10 LET I = 0\n"
+        "20 LET I = I + 1\n"
+        "30 LET S = S + I\n"
+        "40 IF I < 5000 THEN 20\n"
+        "50 PRINT S\n"
+        "60 END\n", counting).empty());
+    for (int vm = 0; vm < 2; ++vm) {
+        Interpreter plain, detecting;
+        std::string a, b;
+        plain.setVmEnabled(vm);
+        detecting.setVmEnabled(vm);
+        detecting.setCycleDetection(true);
+        plain.getState().setValue("S", 0);
+        detecting.getState().setValue("S", 0);
+        plain.setOutputConsumer([&](std::string_view s) { a += s; });
+        detecting.setOutputConsumer([&](std::string_view s) { b += s; });
+        plain.run(counting);
+        detecting.run(counting);
+        assert(a == "12502500\n" && a == b);
+        assert(plain.toSyntaxTree(counting) == detecting.toSyntaxTree(counting));
+    }
+
+    std::cout << "[PASS] testCycleDetection" << std::endl;
+}
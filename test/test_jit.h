@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../interpreter/jit.h"
+#include "test_loopanalyzer.h"
+
+using namespace std;
+
+// Compare a JIT run against the plain interpreter and report the difference
+void checkJitMatches(const std::string &name, const std::vector<std::string> &lines,
+                     const std::vector<int> &inputs = {}) {
+    Program p;
+    loadLoopProgram(p, lines);
+    JitComparison cmp = compareJitWithInterpreter(p, inputs);
+    if (!cmp.identical) cout << "[FAIL] " << name << ": " << cmp.details << endl;
+    assert(cmp.identical);
+}
+
+void testJitArithmeticLoop() {
+    checkJitMatches("arithmetic", {
+        "10 LET S = 0",
+        "20 LET I = 0 - 50",
+        "30 LET S = S + I * I - S / 7 + I MOD 7 + (0 - I) MOD 3",
+        "40 LET I = I + 1",
+        "50 IF I < 2000 THEN 30",
+        "60 PRINT S",
+        "70 END"
+    });
+    cout << "[PASS] testJitArithmeticLoop" << endl;
+}
+
+void testJitPrintInsideLoop() {
+    // PRINT leaves native code every iteration and re-enters afterwards
+    checkJitMatches("print", {
+        "10 INPUT N",
+        "20 LET I = 0",
+        "30 LET I = I + 1",
+        "40 PRINT I * N",
+        "50 IF I < 100 THEN 30",
+        "60 END"
+    }, {3});
+    cout << "[PASS] testJitPrintInsideLoop" << endl;
+}
+
+void testJitManyVariables() {
+    // More variables than registers: the rest spill to memory
+    checkJitMatches("spill", {
+        "10 LET A = 1", "11 LET B = 2", "12 LET C = 3", "13 LET D = 4",
+        "14 LET E = 5", "15 LET F = 6", "16 LET G = 7", "17 LET H = 8",
+        "18 LET J = 9", "19 LET K = 10", "20 LET L = 11", "21 LET M = 12",
+        "30 LET A = B + C", "31 LET B = C + D", "32 LET C = D + E", "33 LET D = E + F",
+        "34 LET E = F + G", "35 LET F = G + H", "36 LET G = H + J", "37 LET H = J + K",
+        "38 LET J = K + L", "39 LET K = L + M", "40 LET L = M + A", "41 LET M = A - 1",
+        "50 IF M < 100000 THEN 30",
+        "60 END"
+    });
+    cout << "[PASS] testJitManyVariables" << endl;
+}
+
+void testJitErrorsAndExits() {
+    // Division by zero inside a hot loop must report the interpreter's error
+    checkJitMatches("divide", {
+        "10 LET I = 300",
+        "20 LET Q = 1000 / (I - 3)",
+        "30 LET I = I - 1",
+        "40 IF 0 < I THEN 20",
+        "50 END"
+    });
+
+    // END and GOTO out of the compiled region
+    checkJitMatches("exit", {
+        "10 LET I = 0",
+        "20 LET I = I + 1",
+        "30 IF I = 500 THEN 60",
+        "40 GOTO 20",
+        "60 PRINT I",
+        "70 IF I > 0 THEN 90",
+        "80 LET I = 0 - 1",
+        "90 END"
+    });
+    cout << "[PASS] testJitErrorsAndExits" << endl;
+}
+
+void runJitTests() {
+    if (!JitEngine::isSupported()) {
+        cout << "JIT not supported on this platform, skipped" << endl;
+        return;
+    }
+    testJitArithmeticLoop();
+    testJitPrintInsideLoop();
+    testJitManyVariables();
+    testJitErrorsAndExits();
+    cout << "All JIT tests passed!" << endl;
+}
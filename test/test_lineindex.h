@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cassert>
+#include <iostream>
+#include <iterator>
+#include <set>
+
+#include "lineindex.h"
+
+using namespace std;
+
+void testLineIndexBasics() {
+    LineIndex index;
+    assert(index.size() == 0);
+    assert(index.rank(10) == -1);
+
+    assert(index.insert(30) == 0);
+    assert(index.insert(10) == 0);
+    assert(index.insert(20) == 1);
+    assert(index.insert(20) == 1);     // already present
+    assert(index.size() == 3);
+    assert(index.at(0) == 10 && index.at(1) == 20 && index.at(2) == 30);
+    assert(index.rank(30) == 2);
+    assert(index.countBelow(25) == 2);
+    assert(index.countBelow(10) == 0);
+
+    assert(index.erase(25) == -1);
+    assert(index.erase(10) == 0);
+    assert(index.rank(30) == 1);
+    assert(!index.contains(10));
+
+    index.clear();
+    assert(index.size() == 0);
+    assert(index.insert(5) == 0);
+
+    cout << "[PASS] testLineIndexBasics" << endl;
+}
+
+void testLineIndexMatchesSet() {
+    // Random edits, compared with a std::set after every step
+    LineIndex index;
+    set<int> reference;
+    unsigned int seed = 12345;
+    for (int step = 0; step < 20000; ++step) {
+        seed = seed * 1103515245u + 12345u;
+        int line = (int)((seed >> 8) % 2000) * 10;
+        int expected = (int)distance(reference.begin(), reference.lower_bound(line));
+        if ((seed >> 4) % 3 == 0) {
+            bool present = reference.erase(line) > 0;
+            assert(index.erase(line) == (present ? expected : -1));
+        } else {
+            reference.insert(line);
+            assert(index.insert(line) == expected);
+        }
+        assert(index.size() == (int)reference.size());
+        assert(index.countBelow(line + 5) == (int)distance(reference.begin(), reference.lower_bound(line + 5)));
+    }
+
+    int k = 0;
+    for (int line : reference) {
+        assert(index.at(k) == line);
+        assert(index.rank(line) == k);
+        ++k;
+    }
+
+    cout << "[PASS] testLineIndexMatchesSet" << endl;
+}
+
+void runLineIndexTests() {
+    testLineIndexBasics();
+    testLineIndexMatchesSet();
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../interpreter/interpreter.h"
+#include "../interpreter/linkedprogram.h"
+#include "../runtime/parser.h"
+#include "test_loopanalyzer.h"
+#include "test_vm.h"
+
+using namespace std;
+
+// Add or replace one line the way the GUI does (source, then statement)
+void setLinkedLine(Program &p, int lineNumber, const std::string &code) {
+    Parser parser;
+    p.addSourceLine(lineNumber, code);
+    p.setParsedStatement(lineNumber, parser.parseLine(lineNumber, code));
+}
+
+// The incrementally maintained links must equal a link from scratch
+void checkLinksFresh(const Program &p, const LinkedProgram &linked) {
+    LinkedProgram fresh(p);
+    if (linked.describe() != fresh.describe())
+        cout << "[FAIL] links:\n" << linked.describe() << "fresh:\n" << fresh.describe();
+    assert(linked.describe() == fresh.describe());
+    assert(linked.variableCount() == fresh.variableCount());
+}
+
+void testLinkedEdits() {
+    Program p;
+    LinkedProgram linked(p);
+
+    setLinkedLine(p, 30, "PRINT X + Y");
+    setLinkedLine(p, 10, "LET X = 1");
+    checkLinksFresh(p, linked);
+
+    // Jump to a line that does not exist yet, then add it
+    setLinkedLine(p, 20, "GOTO 25");
+    assert(linked.describe().find("jump 25 (missing)") != string::npos);
+    setLinkedLine(p, 25, "LET Y = X * 2");
+    assert(linked.describe().find("20: next 25, jump 25\n") != string::npos);
+    checkLinksFresh(p, linked);
+
+    // Replace a line: new target and variables
+    setLinkedLine(p, 20, "IF X > 0 THEN 30");
+    checkLinksFresh(p, linked);
+
+    // Remove the jump target and the first line
+    p.removeSourceLine(30);
+    assert(linked.describe().find("jump 30 (missing)") != string::npos);
+    p.removeSourceLine(10);
+    checkLinksFresh(p, linked);
+
+    // A line with a syntax error is a jump target without a statement
+    p.addSourceLine(30, "PRINT +");
+    checkLinksFresh(p, linked);
+    assert(linked.describe().find("30: next -, no statement") != string::npos);
+
+    // Variable slots are released with the last line using them
+    assert(linked.variableCount() == 2);
+    p.removeSourceLine(25);
+    p.removeSourceLine(20);
+    assert(linked.variableCount() == 0);
+    checkLinksFresh(p, linked);
+
+    p.clear();
+    assert(linked.describe().empty());
+    setLinkedLine(p, 10, "END");
+    checkLinksFresh(p, linked);
+
+    cout << "[PASS] testLinkedEdits" << endl;
+}
+
+void testLinkedEditCost() {
+    // A long program where many lines jump to the same few targets
+    Program p;
+    for (int line = 10; line <= 200000; line += 10) {
+        if (line % 1000 == 0) setLinkedLine(p, line, "IF X > " + std::to_string(line) + " THEN 10");
+        else setLinkedLine(p, line, "LET X = X + " + std::to_string(line % 7));
+    }
+    LinkedProgram linked(p);
+
+    // Each edit writes the edited line, its predecessor and the lines
+    // jumping to it, whatever the size of the program
+    long long before = linked.linkWork();
+    setLinkedLine(p, 99995, "PRINT X");
+    assert(linked.linkWork() - before <= 4);
+
+    before = linked.linkWork();
+    setLinkedLine(p, 50000, "GOTO 20");
+    p.removeSourceLine(150000);
+    assert(linked.linkWork() - before <= 8);
+
+    // Removing the common jump target touches the 198 lines still jumping
+    // to it, not more
+    before = linked.linkWork();
+    p.removeSourceLine(10);
+    assert(linked.linkWork() - before == 198);
+
+    cout << "[PASS] testLinkedEditCost" << endl;
+}
+
+// Run through the linked form, checked against the tree walker on `p`
+void checkLinkedMatches(const std::string &name, const Program &p, const LinkedProgram &linked,
+                        const std::vector<int> &inputs = {}) {
+    checkRunMatches(name, p, [&](Interpreter &itp) { itp.run(linked); }, inputs);
+}
+
+void testLinkedRun() {
+    Program p;
+    LinkedProgram linked(p);
+    loadLoopProgram(p, {
+        "10 LET S = 0",
+        "20 LET I = 0 - 50",
+        "30 LET S = S + I * I - S / 7 + I MOD 7 + (0 - I) MOD 3",
+        "40 LET I = I + 1",
+        "50 IF I < 2000 THEN 30",
+        "60 PRINT S",
+        "70 END"
+    });
+    checkLinkedMatches("arithmetic", p, linked);
+
+    // Edit and run again without relinking anything else
+    setLinkedLine(p, 55, "IF S = S THEN 55");
+    setLinkedLine(p, 65, "REM after print");
+    setLinkedLine(p, 30, "LET S = S + I MOD 3");
+    checkLinkedMatches("edited", p, linked);
+
+    p.clear();
+    loadLoopProgram(p, {
+        "10 INPUT N",
+        "20 LET I = 0",
+        "30 LET I = I + 1",
+        "40 PRINT I * N",
+        "50 IF I < N THEN 30",
+        "60 GOTO 10"
+    });
+    checkLinkedMatches("input", p, linked, {3, 2});
+
+    setLinkedLine(p, 40, "PRINT I / (N - 2)");
+    checkLinkedMatches("divide", p, linked, {3, 2});
+    setLinkedLine(p, 40, "PRINT I + Y");
+    checkLinkedMatches("undefined", p, linked, {3});
+    setLinkedLine(p, 40, "PRINT I ^ 2");
+    checkLinkedMatches("unknown operator", p, linked, {3});
+    setLinkedLine(p, 60, "GOTO 100");
+    setLinkedLine(p, 40, "PRINT I");
+    checkLinkedMatches("missing line", p, linked, {3});
+    p.removeSourceLine(60);
+    checkLinkedMatches("fall off", p, linked, {3});
+
+    // The last line is handed back: its assignment survives falling off
+    p.clear();
+    loadLoopProgram(p, {
+        "10 PRINT 100",
+        "20 PRINT 3",
+        "30 LET B = (0 - 2147483647)",
+        "40 INPUT B"
+    });
+    checkLinkedMatches("input last", p, linked, {4});
+    setLinkedLine(p, 40, "LET B = B / 0 + Y");
+    setLinkedLine(p, 50, "LET B = B + Y");
+    checkLinkedMatches("undefined last", p, linked);
+
+    p.clear();
+    bool thrown = false;
+    try {
+        Interpreter itp;
+        itp.run(linked);
+    } catch (const std::runtime_error &e) {
+        thrown = std::string(e.what()) == "Goto none-exsiting line";
+    }
+    assert(thrown);
+
+    cout << "[PASS] testLinkedRun" << endl;
+}
+
+void runLinkedTests() {
+    testLinkedEdits();
+    testLinkedEditCost();
+    testLinkedRun();
+}
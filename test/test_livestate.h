@@ -0,0 +1,152 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../interpreter/interpreter.h"
+#include "../interpreter/livestate.h"
+#include "../runtime/programloader.h"
+
+using namespace std;
+
+void testLiveStatePublish() {
+    LiveState live(0);
+    LiveSnapshot s;
+    assert(live.read(s) && s.version == 0 && s.variables.empty());
+
+    live.begin(30);
+    live.variable("B", 2);
+    live.variable("A", 1);
+    live.end();
+    live.begin(40);
+    live.variable("A", 5);
+    live.end();
+    assert(live.read(s) && s.version == 2 && s.line == 40);
+    assert((s.variables == vector<pair<string, int>>{{"B", 2}, {"A", 5}}));
+
+    // Variables past the limit are dropped, the rest still publish
+    live.begin(50);
+    for (int i = 0; i < LiveState::MAX_VARIABLES + 10; ++i) live.variable("V" + to_string(i), i);
+    live.end();
+    assert(live.read(s) && (int)s.variables.size() == LiveState::MAX_VARIABLES);
+
+    // Line counts keep the slot of their first publication
+    live.begin(60);
+    live.lineCount(30, 4);
+    live.lineCount(10, 1);
+    live.end();
+    live.begin(60);
+    live.lineCount(30, 9);
+    live.end();
+    assert(live.read(s) && (s.lines == vector<pair<int, uint64_t>>{{30, 9}, {10, 1}}));
+
+    live.reset();
+    assert(live.read(s) && s.version == 0 && s.variables.empty() && s.lines.empty() && !live.stopRequested());
+
+    cout << "[PASS] testLiveStatePublish" << endl;
+}
+
+// Read publications from another thread while the program runs; every copy
+// must be one publication, never a mix of two
+void testLiveStateConcurrent() {
+    Program p;
+    loadProgramText(
+        "10 LET A = 0\n"
+        "20 LET B = 0\n"
+        "30 LET A = A + 1\n"
+        "40 LET B = A * 2\n"
+        "50 IF A < 3000000 THEN 30\n"
+        "60 END\n", p);
+
+    for (bool vm : {false, true}) {
+        LiveState live(0);
+        Interpreter itp;
+        itp.setVmEnabled(vm);
+        itp.setLoopAcceleration(false);
+        itp.setLiveState(&live);
+
+        atomic<bool> done{false};
+        long long reads = 0, torn = 0;
+        uint64_t lastVersion = 0, lastCount = 0;
+        thread reader([&]() {
+            LiveSnapshot s;
+            while (!done) {
+                if (!live.read(s)) continue;
+                assert(s.version >= lastVersion);
+                lastVersion = s.version;
+                if (s.variables.size() == 2 && s.variables[1].second != 2 * s.variables[0].second) ++torn;
+                for (const auto &entry : s.lines) {
+                    if (entry.first != 40) continue;
+                    assert(entry.second >= lastCount);      // counts only grow
+                    lastCount = entry.second;
+                }
+                ++reads;
+            }
+        });
+        itp.run(p);
+        done = true;
+        reader.join();
+        assert(torn == 0 && reads > 0);
+
+        // The last publication is the final state
+        LiveSnapshot s;
+        assert(live.read(s) && s.version > 1);
+        assert((s.variables == vector<pair<string, int>>{{"A", 3000000}, {"B", 6000000}}));
+        const RuntimeStats &stats = *itp.getState().getRuntimeStats();
+        assert(s.lines.size() == stats.lineCounters.size());
+        for (const auto &entry : s.lines)
+            assert(entry.second == (uint64_t)stats.getLineCounters(entry.first).execCount);
+        assert(lastCount <= 3000000);
+    }
+
+    cout << "[PASS] testLiveStateConcurrent" << endl;
+}
+
+void testLiveStateStop() {
+    Program p;
+    loadProgramText("10 LET I = 0\n20 LET I = I + 1\n30 GOTO 20\n", p);
+
+    for (bool vm : {false, true}) {
+        LiveState live;
+        Interpreter itp;
+        itp.setVmEnabled(vm);
+        itp.setLiveState(&live);
+        thread stopper([&]() {
+            this_thread::sleep_for(chrono::milliseconds(20));
+            live.requestStop();
+        });
+        bool stopped = false;
+        try {
+            itp.run(p);
+        } catch (const RunStoppedError &) {
+            stopped = true;
+        }
+        stopper.join();
+        assert(stopped && itp.getState().getValue("I") > 0);
+    }
+
+    // INPUT publishes before it waits
+    LiveState live(3600);
+    Interpreter itp;
+    itp.setLiveState(&live);
+    itp.setInputProvider([&]() {
+        LiveSnapshot s;
+        assert(live.read(s) && s.line == 20 && s.variables.size() == 1 && s.variables[0].second == 7);
+        return string("1");
+    });
+    Program q;
+    loadProgramText("10 LET X = 7\n20 INPUT Y\n30 END\n", q);
+    itp.run(q);
+
+    cout << "[PASS] testLiveStateStop" << endl;
+}
+
+void runLiveStateTests() {
+    testLiveStatePublish();
+    testLiveStateConcurrent();
+    testLiveStateStop();
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../interpreter/interpreter.h"
+#include "../interpreter/loopanalyzer.h"
+#include "../core/program.h"
+#include "../runtime/parser.h"
+
+using namespace std;
+
+// Load "<line> <code>" strings into a program
+void loadLoopProgram(Program &p, const std::vector<std::string> &lines) {
+    Parser parser;
+    for (const std::string &l : lines) {
+        size_t space = l.find(' ');
+        int lineNumber = std::stoi(l.substr(0, space));
+        std::string code = l.substr(space + 1);
+        p.addSourceLine(lineNumber, code);
+        p.setParsedStatement(lineNumber, parser.parseLine(lineNumber, code));
+    }
+}
+
+// Run the program with and without loop acceleration and compare the
+// resulting variables and syntax trees (which carry all execution counters)
+void checkSameAsInterpreter(const std::vector<std::string> &lines,
+                            const std::vector<std::string> &vars) {
+    Program slow, fast;
+    loadLoopProgram(slow, lines);
+    loadLoopProgram(fast, lines);
+
+    Interpreter reference;
+    reference.setLoopAcceleration(false);
+    reference.run(slow);
+
+    Interpreter accelerated;
+    accelerated.run(fast);
+
+    for (const std::string &v : vars) {
+        assert(reference.getState().getValue(v) == accelerated.getState().getValue(v));
+    }
+    assert(reference.toSyntaxTree(slow) == accelerated.toSyntaxTree(fast));
+}
+
+void testCountingLoopClosedForm() {
+    std::vector<std::string> lines = {
+        "10 LET S = 0",
+        "15 LET I = 0",
+        "20 LET S = S + I",
+        "30 LET I = I + 1",
+        "40 IF I < 1000 THEN 20",
+        "50 END"
+    };
+
+    Program p;
+    loadLoopProgram(p, lines);
+    LoopAnalyzer analyzer(p);
+    assert(analyzer.loopCount() == 1);
+    assert(analyzer.isClosedForm(20));
+
+    checkSameAsInterpreter(lines, {"S", "I"});
+    cout << "[PASS] testCountingLoopClosedForm" << endl;
+}
+
+void testTopTestedLoop() {
+    checkSameAsInterpreter({
+        "10 LET N = 37",
+        "20 LET I = 0",
+        "25 LET P = 1",
+        "30 IF I > N THEN 80",
+        "40 LET P = P * 3 + I",
+        "50 LET I = I + 2",
+        "60 REM step",
+        "70 GOTO 30",
+        "80 END"
+    }, {"I", "P"});
+    cout << "[PASS] testTopTestedLoop" << endl;
+}
+
+void testBatchLoop() {
+    // Division and variable products are not affine: runs as a batch
+    std::vector<std::string> lines = {
+        "10 LET X = 7",
+        "20 LET I = 1",
+        "30 LET X = X * I MOD 1000 + X / 3",
+        "40 LET I = I + 1",
+        "50 IF I < 500 THEN 30",
+        "60 END"
+    };
+
+    Program p;
+    loadLoopProgram(p, lines);
+    LoopAnalyzer analyzer(p);
+    assert(analyzer.hasLoopAt(30) && !analyzer.isClosedForm(30));
+
+    checkSameAsInterpreter(lines, {"X", "I"});
+    cout << "[PASS] testBatchLoop" << endl;
+}
+
+void testLoopErrorFallsBack() {
+    // The 5th iteration divides by zero: the error must still surface
+    Program p;
+    loadLoopProgram(p, {
+        "10 LET I = 5",
+        "20 LET Q = 100 / I",
+        "30 LET I = I - 1",
+        "40 IF I > 0 - 3 THEN 20",
+        "50 END"
+    });
+
+    Interpreter itp;
+    bool thrown = false;
+    try {
+        itp.run(p);
+    } catch (const std::runtime_error &e) {
+        thrown = std::string(e.what()) == "DIVIDE BY ZERO";
+    }
+    assert(thrown);
+    assert(itp.getState().getValue("I") == 0);
+    assert(itp.getState().getValue("Q") == 100);
+    cout << "[PASS] testLoopErrorFallsBack" << endl;
+}
+
+void runLoopAnalyzerTests() {
+    testCountingLoopClosedForm();
+    testTopTestedLoop();
+    testBatchLoop();
+    testLoopErrorFallsBack();
+    cout << "All LoopAnalyzer tests passed!" << endl;
+}
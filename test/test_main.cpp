@@ -3,11 +3,27 @@
 #include "test_statement.h"
 #include "test_expression.h"
 #include "test_program.h"
+#include "test_lineindex.h"
 
 #include "test_tokenizer.h"
 #include "test_parser.h"
 
 #include "test_interpreter.h"
+#include "test_loopanalyzer.h"
+#include "test_jit.h"
+#include "test_aot.h"
+#include "test_vm.h"
+#include "test_branchprofile.h"
+#include "test_batch.h"
+#include "test_spmd.h"
+#include "test_session.h"
+#include "test_linked.h"
+#include "test_engine.h"
+#include "test_trace.h"
+#include "test_replay.h"
+#include "test_snapshot.h"
+#include "test_debugger.h"
+#include "test_livestate.h"
 
 int main() {
     std::cout << "Running Expression tests..." << std::endl;
@@ -15,6 +31,7 @@ int main() {
 
     std::cout << "\nRunning Program tests..." << std::endl;
     //runProgramTests();
+    runLineIndexTests();
 
     std::cout << "\nRunning Statement tests..." << std::endl;
     runStatementTests();
@@ -29,6 +46,46 @@ int main() {
 
     std::cout<< "\nRunning interpreter test" <<std::endl;
     testInterpreter();
+    testConcurrentRuns();
+    testResumableRun();
+    testInterleavedSessions();
+    testRunLimits();
+    testCycleDetection();
+
+    std::cout << "\nRunning loop analyzer tests..." << std::endl;
+    runLoopAnalyzerTests();
+
+    std::cout << "\nRunning JIT tests..." << std::endl;
+    runJitTests();
+
+    std::cout << "\nRunning AOT compiler tests..." << std::endl;
+    runAotTests();
+
+    std::cout << "\nRunning register VM tests..." << std::endl;
+    runVmTests();
+    runBranchProfileTests();
+
+    std::cout << "\nRunning linked program tests..." << std::endl;
+    runLinkedTests();
+
+    std::cout << "\nRunning embedding API tests..." << std::endl;
+    runEngineTests();
+
+    std::cout << "\nRunning trace tests..." << std::endl;
+    runTraceTests();
+    runReplayTests();
+    runSnapshotTests();
+    runDebuggerTests();
+    runLiveStateTests();
+
+    std::cout << "\nRunning batch runner tests..." << std::endl;
+    runBatchTests();
+
+    std::cout << "\nRunning SPMD lane tests..." << std::endl;
+    runSpmdTests();
+
+    std::cout << "\nRunning REPL session tests..." << std::endl;
+    runSessionTests();
 
     std::cout << "\nAll tests completed successfully!" << std::endl;
     return 0;
@@ -62,13 +62,24 @@ void testLineNavigation() {
 
 void testExecutionControl() {
 
+    // Program counter and end flag belong to the run (EvalState)
     Program prog;
+    prog.addSourceLine(10, "LET X = 5");
+    EvalState state;
     cout<<"000";
-    prog.setNextLine(10);
-    assert(prog.getNextLine() == 10);
-
-    prog.setEnd();
-    assert(prog.isEnded());
+    state.setNextLine(prog.requireLine(10));
+    assert(state.getNextLine() == 10);
+
+    bool threw = false;
+    try {
+        prog.requireLine(20);
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    assert(threw);
+
+    state.setEnd();
+    assert(state.isEnded());
 
     cout << "[PASS] testExecutionControl" << endl;
 }
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../interpreter/batchrunner.h"
+#include "../interpreter/interpreter.h"
+#include "../interpreter/sessionrecording.h"
+#include "../runtime/programloader.h"
+
+using namespace std;
+
+// Run like the GUI does: answers come from a list, everything is recorded
+SessionRecording recordSession(const Program &p, const vector<string> &answers, string &printed) {
+    SessionRecording recording;
+    recording.begin(p);
+
+    size_t next = 0;
+    Interpreter itp;
+    itp.setOutputConsumer(recording.recordOutput([&printed](std::string_view s) { printed += s; }));
+    itp.setInputProvider(recording.recordInput([&]() { return next < answers.size() ? answers[next++] : string(); }));
+    try {
+        itp.run(p);
+    } catch (const std::runtime_error &e) {
+        recording.error = e.what();
+    }
+    return recording;
+}
+
+void testReplayRoundTrip() {
+    Program p;
+    p.addSourceLine(5, "LET = broken");     // kept without a statement, as in the GUI
+    loadProgramText(
+        "10 INPUT N\n"
+        "20 LET S = 0\n"
+        "30 LET S = S + N * N\n"
+        "40 LET N = N - 1\n"
+        "50 IF N > 0 THEN 30\n"
+        "60 PRINT S\n"
+        "70 INPUT D\n"
+        "80 PRINT S / D\n", p);
+
+    // A cancelled dialog (empty line) and a typo are read again by INPUT
+    string printed;
+    SessionRecording recording = recordSession(p, {"", "x\\y", "300", "0"}, printed);
+    assert(recording.inputs.size() == 4);
+    assert(recording.error == "DIVIDE BY ZERO");
+    assert(recording.outputBytes == printed.size());
+    assert(printed.find("INVALID NUMBER\n") == 0);
+
+    stringstream file;
+    recording.save(file);
+    SessionRecording loaded = SessionRecording::load(file);
+    assert(loaded.inputs == recording.inputs && loaded.source == recording.source);
+    assert(loaded.outputBytes == recording.outputBytes && loaded.outputHash == recording.outputHash);
+    assert(loaded.error == recording.error);
+
+    // Replayed headlessly on every engine, the run is reproduced
+    for (BatchEngine engine : {BatchEngine::Tree, BatchEngine::Vm}) {
+        BatchOptions options;
+        options.engine = engine;
+        BatchResult replayed = runReplay(loaded, options);
+        assert(replayed.status == "error" && replayed.message == "DIVIDE BY ZERO");
+        assert(replayed.output == printed);
+    }
+
+    // A different last answer changes the outcome
+    loaded.inputs.back() = "3";
+    BatchResult diverged = runReplay(loaded, BatchOptions());
+    assert(diverged.status == "diverged");
+
+    cout << "[PASS] testReplayRoundTrip" << endl;
+}
+
+void testReplayFiles() {
+    Program p;
+    loadProgramText("10 INPUT A\n20 PRINT A * 2\n30 END\n", p);
+    string printed;
+    SessionRecording ok = recordSession(p, {"21"}, printed);
+    assert(ok.error.empty() && printed == "42\n");
+    assert(runReplay(ok, BatchOptions()).status == "ok");
+
+    // Missing inputs end the replay with an error the recording did not have
+    ok.inputs.clear();
+    BatchResult starved = runReplay(ok, BatchOptions());
+    assert(starved.status == "diverged");
+
+    for (string text : {"", "QBREPLAY 1\ninputs 2\n1\n", "QBREPLAY 1\ninputs x\n", "QBTRACE1"}) {
+        stringstream in(text);
+        bool thrown = false;
+        try {
+            SessionRecording::load(in);
+        } catch (const std::runtime_error &) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    cout << "[PASS] testReplayFiles" << endl;
+}
+
+void runReplayTests() {
+    testReplayRoundTrip();
+    testReplayFiles();
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cassert>
+#include <iostream>
+#include <string>
+
+#include "../interpreter/replsession.h"
+
+using namespace std;
+
+// Run until the program finishes or waits for INPUT
+void runSession(ReplSession &session) {
+    while (session.runnable()) session.runSlice(1000);
+}
+
+void testSessionEditing() {
+    ReplSession session;
+    session.handleLine("20 PRINT X");
+    session.handleLine("10 LET X = 4");
+    session.handleLine("30 END");
+    session.handleLine("list");
+    string listing = session.takeOutput();
+    assert(listing.find("10 LET X = 4") < listing.find("20 PRINT X"));
+    assert(listing.find("30 END") != string::npos);
+
+    // A line number alone deletes the line
+    session.handleLine("30");
+    session.handleLine("LIST");
+    assert(session.takeOutput().find("30 END") == string::npos);
+
+    // Syntax errors are reported, the source line is kept
+    session.handleLine("40 LET = 5");
+    assert(session.takeOutput().find("Syntax Error") == 0);
+
+    session.handleLine("CLEAR");
+    session.handleLine("LIST");
+    assert(session.takeOutput().empty());
+
+    session.handleLine("FROB");
+    assert(session.takeOutput() == "Unknown command: FROB\n");
+    assert(!session.closed());
+    session.handleLine("quit");
+    assert(session.closed());
+
+    cout << "[PASS] Session editing" << endl;
+}
+
+void testSessionRun() {
+    ReplSession session;
+    session.handleLine("10 INPUT N");
+    session.handleLine("20 PRINT N * 2");
+    session.handleLine("30 IF N > 0 THEN 10");
+    session.handleLine("40 END");
+    session.handleLine("RUN");
+    runSession(session);
+    assert(session.needsInput());
+    assert(session.takeOutput() == "? ");
+
+    // Lines typed while the program runs are INPUT, not commands
+    session.handleLine("21");
+    runSession(session);
+    assert(session.takeOutput() == "42\n? ");
+    session.handleLine("abc");
+    runSession(session);
+    assert(session.takeOutput() == "INVALID NUMBER\n? ");
+    session.handleLine("0");
+    runSession(session);
+    assert(!session.runnable() && !session.needsInput());
+    assert(session.takeOutput() == "0\n");
+
+    // Runtime errors end the run and the session accepts commands again
+    session.handleLine("20 PRINT N / 0");
+    session.handleLine("RUN");
+    session.handleLine("5");
+    runSession(session);
+    // Input typed ahead is queued, so no prompt is shown
+    assert(session.takeOutput() == "Runtime Error: DIVIDE BY ZERO\n");
+    session.handleLine("LIST");
+    assert(session.takeOutput().find("20 PRINT N / 0") != string::npos);
+
+    cout << "[PASS] Session run" << endl;
+}
+
+void testSessionQuota() {
+    ReplSession session;
+    session.setStatementQuota(5000);
+    session.handleLine("10 LET I = 0");
+    session.handleLine("20 LET I = I + 1");
+    session.handleLine("30 GOTO 20");
+    session.handleLine("RUN");
+    int slices = 0;
+    while (session.runnable()) {
+        session.runSlice(1000);
+        ++slices;
+    }
+    assert(slices == 5);
+    assert(session.takeOutput() == "Runtime Error: CPU QUOTA EXCEEDED\n");
+
+    // The quota applies to each RUN separately
+    session.handleLine("30 END");
+    session.handleLine("15 PRINT 7");
+    session.handleLine("RUN");
+    runSession(session);
+    assert(session.takeOutput() == "7\n");
+
+    cout << "[PASS] Session quota" << endl;
+}
+
+void runSessionTests() {
+    testSessionEditing();
+    testSessionRun();
+    testSessionQuota();
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../interpreter/interpreter.h"
+#include "../interpreter/snapshot.h"
+#include "../runtime/programloader.h"
+
+using namespace std;
+
+// A long warm-up, then a loop over INPUT
+const char *SNAPSHOT_PROGRAM =
+    "10 LET S = 0\n"
+    "20 LET I = 0\n"
+    "30 LET S = S + I * I MOD 1000\n"
+    "40 LET I = I + 1\n"
+    "50 IF I < 200000 THEN 30\n"
+    "60 INPUT N\n"
+    "70 IF N = 0 THEN 110\n"
+    "80 LET S = S + N\n"
+    "90 PRINT S\n"
+    "100 GOTO 60\n"
+    "110 PRINT S * 2\n"
+    "120 END\n";
+
+struct SnapshotRun {
+    map<string, int> variables;
+    string output;
+    string tree;
+};
+
+SnapshotRun finishRun(Interpreter &itp, const Program &p, string &output) {
+    SnapshotRun r;
+    r.output = output;
+    r.variables = itp.getState().getVariables();
+    r.tree = itp.toSyntaxTree(p);
+    return r;
+}
+
+bool sameRun(const SnapshotRun &a, const SnapshotRun &b) {
+    return a.variables == b.variables && a.output == b.output && a.tree == b.tree;
+}
+
+SnapshotRun fullRun(const Program &p, const vector<string> &inputs) {
+    Interpreter itp;
+    string output;
+    size_t next = 0;
+    itp.setInputProvider([&]() { return inputs[next++]; });
+    itp.setOutputConsumer([&](std::string_view s) { output += s; });
+    itp.run(p);
+    return finishRun(itp, p, output);
+}
+
+void testSnapshotFork() {
+    Program p;
+    loadProgramText(SNAPSHOT_PROGRAM, p);
+
+    // Pause at the first INPUT after the warm-up, with one line queued
+    Interpreter warm;
+    warm.setOutputConsumer([](std::string_view) {});
+    while (warm.runUntilBlocked(p, 50000) == RunStatus::Yielded) {}
+    warm.supplyInput("oops");
+    assert(warm.runUntilBlocked(p) == RunStatus::NeedsInput);
+    warm.supplyInput("5");
+
+    stringstream file;
+    warm.snapshot(p).save(file);
+    ExecutionSnapshot saved = ExecutionSnapshot::load(file);
+    assert(saved.nextLine == 60 && saved.suspended && saved.pendingInput == vector<string>{"5"});
+
+    // Every fork continues from the snapshot with its own input
+    vector<vector<string>> forks = {{"0"}, {"3", "0"}, {"1", "2", "x", "4", "0"}};
+    for (const vector<string> &inputs : forks) {
+        Interpreter itp;
+        string output;
+        size_t next = 0;
+        itp.setInputProvider([&]() { return inputs[next++]; });
+        itp.setOutputConsumer([&](std::string_view s) { output += s; });
+        itp.restore(saved, p);
+        itp.resume(p);
+        assert(!itp.isSuspended());
+
+        vector<string> all = {"oops", "5"};
+        all.insert(all.end(), inputs.begin(), inputs.end());
+        string prefix = "INVALID NUMBER\n";
+        SnapshotRun reference = fullRun(p, all);
+        SnapshotRun forked = finishRun(itp, p, output);
+        forked.output = prefix + forked.output;
+        assert(sameRun(reference, forked));
+    }
+
+    // The resumable path picks up the snapshot too
+    Interpreter again;
+    again.setOutputConsumer([](std::string_view) {});
+    again.restore(saved, p);
+    again.supplyInput("0");
+    assert(again.runUntilBlocked(p) == RunStatus::Finished);
+    assert(again.getState().getValue("N") == 0);
+
+    cout << "[PASS] testSnapshotFork" << endl;
+}
+
+void testSnapshotRunPaths() {
+    Program p;
+    loadProgramText(
+        "10 LET A = 1\n"
+        "20 LET B = 0\n"
+        "30 LET A = A * 3 + B\n"
+        "40 LET B = B + 1\n"
+        "50 IF B < 5000 THEN 30\n"
+        "60 PRINT A\n"
+        "70 END\n", p);
+    SnapshotRun reference = fullRun(p, {});
+
+    // run() stopped by its fuel limit, on the tree walker and the VM
+    for (bool vm : {false, true}) {
+        Interpreter limited;
+        limited.setVmEnabled(vm);
+        RunLimits limits;
+        limits.fuel = 7777;
+        limited.setRunLimits(limits);
+        limited.setOutputConsumer([](std::string_view) {});
+        bool stopped = false;
+        try {
+            limited.run(p);
+        } catch (const FuelExhaustedError &) {
+            stopped = true;
+        }
+        assert(stopped);
+
+        Interpreter itp;
+        string output;
+        itp.setOutputConsumer([&](std::string_view s) { output += s; });
+        itp.restore(limited.snapshot(p), p);
+        itp.resume(p);
+        assert(sameRun(reference, finishRun(itp, p, output)));
+    }
+
+    // step(): a snapshot between two steps continues on another interpreter
+    Interpreter stepper;
+    stepper.setOutputConsumer([](std::string_view) {});
+    for (int i = 0; i < 1000; ++i) stepper.step(p);
+    ExecutionSnapshot middle = stepper.snapshot(p);
+    Interpreter other;
+    string output;
+    other.setOutputConsumer([&](std::string_view s) { output += s; });
+    other.restore(middle, p);
+    while (other.step(p)) {}
+    assert(sameRun(reference, finishRun(other, p, output)));
+
+    // Snapshots only restore onto their own program
+    Program edited;
+    loadProgramText("10 LET A = 2\n", edited);
+    bool thrown = false;
+    try {
+        other.restore(middle, edited);
+    } catch (const std::runtime_error &e) {
+        thrown = string(e.what()) == "SNAPSHOT OF A DIFFERENT PROGRAM";
+    }
+    assert(thrown);
+
+    for (string text : {string(""), string("QBSNAP1"), string("QBSNAP1\0\x05", 9), string("QBTRACE1")}) {
+        stringstream in(text);
+        thrown = false;
+        try {
+            ExecutionSnapshot::load(in);
+        } catch (const std::runtime_error &) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    cout << "[PASS] testSnapshotRunPaths" << endl;
+}
+
+void runSnapshotTests() {
+    testSnapshotFork();
+    testSnapshotRunPaths();
+}
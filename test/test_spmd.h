@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../interpreter/batchrunner.h"
+#include "../interpreter/spmd.h"
+#include "../runtime/programloader.h"
+
+using namespace std;
+
+// Every lane of an SPMD run must match a separate interpreter run
+void checkSpmdMatchesInterpreter(const std::string &source, const std::vector<std::vector<std::string>> &inputs) {
+    Program program;
+    assert(loadProgramText(source, program).empty());
+
+    for (bool vector : {false, true}) {
+        SpmdEngine engine(program);
+        engine.setVectorEnabled(vector);
+        std::vector<SpmdLaneResult> lanes = engine.run(inputs);
+        assert(lanes.size() == inputs.size());
+
+        for (size_t l = 0; l < inputs.size(); ++l) {
+            std::string input;
+            for (const std::string &value : inputs[l]) input += value + "\n";
+            BatchOptions options;
+            options.engine = BatchEngine::Tree;
+            BatchResult expected = runBatchSource(source, input, options);
+
+            assert(lanes[l].output == expected.output);
+            assert((lanes[l].status == SpmdLaneResult::Ok) == (expected.status == "ok"));
+            assert(lanes[l].message == expected.message);
+            assert(lanes[l].statements == expected.statements);
+        }
+    }
+}
+
+void testSpmdUniform() {
+    Program program;
+    assert(loadProgramText("10 INPUT N\n20 LET S = 0\n30 LET S = S + N * N\n40 LET N = N - 1\n"
+                           "50 IF N > 0 THEN 30\n60 PRINT S\n70 END\n", program).empty());
+
+    // Same trip count in every lane: every step runs the full width
+    std::vector<std::vector<std::string>> inputs(SpmdEngine::LANES, std::vector<std::string>{"100"});
+    SpmdEngine engine(program);
+    std::vector<SpmdLaneResult> lanes = engine.run(inputs);
+    for (const SpmdLaneResult &lane : lanes) {
+        assert(lane.status == SpmdLaneResult::Ok);
+        assert(lane.output == "338350\n");
+    }
+    assert(engine.occupancy() == 1.0);
+
+    cout << "[PASS] SPMD lanes on a shared path (AVX2 kernels "
+         << (engine.vectorActive() ? "active" : "not available") << ")" << endl;
+}
+
+void testSpmdDivergence() {
+    // Loops with different trip counts and branches taken per lane
+    std::vector<std::vector<std::string>> counts;
+    for (int i = 0; i < SpmdEngine::LANES; ++i) counts.push_back({std::to_string(i * 7 % 11)});
+    checkSpmdMatchesInterpreter(
+        "10 INPUT N\n20 LET S = 0\n30 IF N < 1 THEN 90\n40 LET T = N MOD 3\n"
+        "50 IF T = 0 THEN 70\n60 LET S = S + N\n70 LET N = N - 1\n80 GOTO 30\n"
+        "90 PRINT S\n100 PRINT (0 - 7) MOD (N - 2)\n110 END\n", counts);
+
+    // Fewer vectors than lanes, wrapping arithmetic
+    checkSpmdMatchesInterpreter("10 INPUT A\n20 PRINT A * A * A\n30 END\n", {{"2147483647"}, {"-3"}});
+
+    cout << "[PASS] SPMD lanes diverge and merge like separate runs" << endl;
+}
+
+void testSpmdErrors() {
+    // Each lane stops with its own error, the others continue
+    checkSpmdMatchesInterpreter(
+        "10 INPUT A\n20 IF A = 1 THEN 60\n30 IF A = 2 THEN 80\n40 PRINT 10 / (A - 3)\n50 END\n"
+        "60 PRINT B\n70 END\n80 GOTO 99\n",
+        {{"1"}, {"2"}, {"3"}, {"4"}, {"x", "5"}, {}});
+
+    // Falling off the last line
+    checkSpmdMatchesInterpreter("10 INPUT A\n20 PRINT A\n", {{"1"}, {"2"}});
+
+    Program program;
+    assert(loadProgramText("10 LET A = 1\n20 GOTO 10\n", program).empty());
+    SpmdEngine engine(program);
+    engine.setDeadline(std::chrono::steady_clock::now() + std::chrono::milliseconds(20));
+    std::vector<SpmdLaneResult> lanes = engine.run({{}, {}});
+    assert(lanes[0].status == SpmdLaneResult::Timeout);
+    assert(lanes[1].message == "TIME LIMIT EXCEEDED");
+
+    cout << "[PASS] SPMD lane errors and time limit" << endl;
+}
+
+void runSpmdTests() {
+    testSpmdUniform();
+    testSpmdDivergence();
+    testSpmdErrors();
+}
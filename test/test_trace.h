@@ -0,0 +1,218 @@
+#pragma once
+
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../interpreter/branchprofile.h"
+#include "../interpreter/interpreter.h"
+#include "../interpreter/runlimits.h"
+#include "../interpreter/tracebuffer.h"
+#include "../runtime/programloader.h"
+
+using namespace std;
+
+struct DecodedTrace {
+    vector<uint64_t> indexes;
+    vector<int> lines;
+    map<string, int> lastWrite;
+};
+
+DecodedTrace decodeTrace(const TraceReader &reader, uint64_t from = 0) {
+    DecodedTrace d;
+    reader.forEach([&](const TraceStep &s) {
+        d.indexes.push_back(s.index);
+        d.lines.push_back(s.line);
+        for (const auto &w : s.writes) d.lastWrite[reader.variableNames()[w.first]] = w.second;
+    }, from);
+    return d;
+}
+
+void testTraceSteps() {
+    Program p;
+    loadProgramText(
+        "10 LET I = 0\n"
+        "20 LET I = I + 1\n"
+        "30 IF I < 3 THEN 20\n"
+        "40 INPUT N\n"
+        "50 LET X = N * (0 - 1000)\n"
+        "60 PRINT X\n"
+        "70 END\n", p);
+
+    TraceBuffer trace;
+    Interpreter itp;
+    itp.setTrace(&trace);
+    itp.setInputProvider([]() { return string("123456"); });
+    itp.setOutputConsumer([](std::string_view) {});
+    itp.run(p);
+
+    DecodedTrace d = decodeTrace(TraceReader(trace));
+    vector<int> expected = {10, 20, 30, 20, 30, 20, 30, 40, 50, 60, 70};
+    assert(d.lines == expected);
+    assert(trace.steps() == expected.size() && trace.oldestStep() == 0);
+    for (size_t i = 0; i < d.indexes.size(); ++i) assert(d.indexes[i] == i);
+    assert(d.lastWrite["I"] == 3 && d.lastWrite["N"] == 123456 && d.lastWrite["X"] == -123456000);
+
+    // Saved and loaded again, the trace decodes the same
+    stringstream file;
+    trace.save(file);
+    TraceReader loaded(file);
+    DecodedTrace again = decodeTrace(loaded);
+    assert(again.lines == d.lines && again.lastWrite == d.lastWrite);
+
+    stringstream junk("not a trace");
+    bool thrown = false;
+    try {
+        TraceReader bad(junk);
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // A corrupt name length is refused before it is allocated, whether or
+    // not the stream can tell how many bytes are left
+    string corrupt = file.str();
+    for (int i = 0; i < 4; ++i) corrupt[20 + i] = (char)0xFF;
+    struct ForwardOnly : std::streambuf {
+        explicit ForwardOnly(string &s) { setg(&s[0], &s[0], &s[0] + s.size()); }
+    };
+    for (int seekable = 0; seekable < 2; ++seekable) {
+        stringstream seekIn(corrupt);
+        ForwardOnly buf(corrupt);
+        istream forwardIn(&buf);
+        string message;
+        try {
+            TraceReader bad(seekable ? (istream &)seekIn : forwardIn);
+        } catch (const std::runtime_error &e) {
+            message = e.what();
+        }
+        assert(message == "truncated trace file");
+    }
+
+    cout << "[PASS] testTraceSteps" << endl;
+}
+
+void testTraceRing() {
+    // Two small blocks: only the latest steps are kept
+    Program p;
+    loadProgramText(
+        "10 LET I = 0\n"
+        "20 LET X = 1\n"
+        "30 LET X = X * 7 + I\n"
+        "40 LET I = I + 1\n"
+        "50 IF I < 5000 THEN 30\n"
+        "60 END\n", p);
+
+    TraceBuffer trace(512, 256);
+    Interpreter itp;
+    itp.setTrace(&trace);
+    itp.run(p);
+
+    uint64_t total = 2 + 3 * 5000 + 1;
+    assert(trace.steps() == total);
+    assert(trace.oldestStep() > 0 && trace.oldestStep() < total);
+    assert(trace.droppedWrites() == 0);
+
+    // Kept steps are contiguous up to the last one, and each block decodes
+    // on its own: the final values are exact
+    TraceReader reader(trace);
+    DecodedTrace d = decodeTrace(reader);
+    assert(!d.indexes.empty() && d.indexes.front() == trace.oldestStep() && d.indexes.back() == total - 1);
+    for (size_t i = 1; i < d.indexes.size(); ++i) assert(d.indexes[i] == d.indexes[i - 1] + 1);
+    assert(d.lines.back() == 60);
+    assert(d.lastWrite["X"] == itp.getState().getValue("X"));
+    assert(d.lastWrite["I"] == 5000);
+
+    // Decoding can start at any kept step
+    DecodedTrace tail = decodeTrace(reader, total - 4);
+    assert((tail.lines == vector<int>{30, 40, 50, 60}));
+
+    // Writes beyond the per-step limit are counted, not recorded
+    TraceBuffer small;
+    small.step(10);
+    for (int i = 0; i <= TraceBuffer::MAX_WRITES_PER_STEP; ++i) small.write("V", i);
+    assert(small.droppedWrites() == 1);
+
+    cout << "[PASS] testTraceRing" << endl;
+}
+
+// Saved trace of a run (and the error it stopped with)
+string tracedRun(const Program &p, const vector<int> &inputs, const function<void(Interpreter &)> &setup) {
+    TraceBuffer trace(4096, 256);
+    Interpreter itp;
+    size_t next = 0;
+    itp.setInputProvider([&]() { return to_string(next < inputs.size() ? inputs[next++] : 0); });
+    itp.setOutputConsumer([](string_view) {});
+    itp.setTrace(&trace);
+    setup(itp);
+    string error;
+    try {
+        itp.run(p);
+    } catch (const std::exception &e) {
+        error = e.what();
+    }
+    stringstream file;
+    trace.save(file);
+    return file.str() + "|" + error;
+}
+
+void testTraceEngines() {
+    // Traces recorded from register machine code are the same bytes as the
+    // statement-by-statement ones, hand-backs and errors included
+    struct Case {
+        const char *text;
+        vector<int> inputs;
+    };
+    const vector<Case> cases = {
+        {"10 LET X = 1\n20 LET X = X + 1\n25 REM twice in a block\n30 LET X = X * 2\n"
+         "40 IF X < 1000 THEN 20\n50 PRINT X\n60 END\n", {}},
+        {"10 INPUT A\n20 LET B = 100 / A\n30 LET A = A - 1\n40 IF A > (0 - 2) THEN 20\n", {2}},
+        {"10 LET A = 1\n20 LET C = A + B\n", {}},
+        {"10 LET I = 0\n20 LET I = I + 1\n30 IF I < 50 THEN 20\n40 GOTO 99\n", {}},
+        {"10 LET A = 7\n20 INPUT A\n", {4}},
+    };
+    set<int> noStops;
+    for (const Case &c : cases) {
+        Program p;
+        loadProgramText(c.text, p);
+        string walked = tracedRun(p, c.inputs, [&](Interpreter &itp) { itp.setStopLines(&noStops); });
+        assert(tracedRun(p, c.inputs, [](Interpreter &) {}) == walked);
+
+        // Laid out for a profile
+        BranchProfile profile;
+        Interpreter training;
+        training.setInputProvider([&]() { return to_string(c.inputs.empty() ? 0 : c.inputs[0]); });
+        training.setOutputConsumer([](string_view) {});
+        try {
+            training.run(p);
+        } catch (const std::exception &) {
+        }
+        profile.add(p, *training.getState().getRuntimeStats());
+        assert(tracedRun(p, c.inputs, [&](Interpreter &itp) {
+            itp.setVmEnabled(true);
+            itp.setBranchProfile(&profile);
+        }) == walked);
+
+        // Out of fuel within a block: the walker finishes the trace
+        RunLimits limits;
+        limits.fuel = 37;
+        string walkedFuel = tracedRun(p, c.inputs, [&](Interpreter &itp) {
+            itp.setStopLines(&noStops);
+            itp.setRunLimits(limits);
+        });
+        assert(tracedRun(p, c.inputs, [&](Interpreter &itp) { itp.setRunLimits(limits); }) == walkedFuel);
+    }
+
+    cout << "[PASS] testTraceEngines" << endl;
+}
+
+void runTraceTests() {
+    testTraceSteps();
+    testTraceRing();
+    testTraceEngines();
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cassert>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../interpreter/interpreter.h"
+#include "../interpreter/vm.h"
+#include "test_loopanalyzer.h"
+
+using namespace std;
+
+struct RunRecord {
+    std::string output;
+    std::string error;
+    std::map<std::string, int> variables;
+    std::string tree;
+    RuntimeStats stats;
+};
+
+// Engine under test: configures the interpreter and runs the program on it
+using EngineRun = std::function<void(Interpreter &)>;
+
+// Run `p` on a fresh interpreter with every engine off; `run` picks one and
+// starts it (the tree walker if empty)
+RunRecord recordRun(const Program &p, const std::vector<int> &inputs, const EngineRun &run = nullptr) {
+    Interpreter itp;
+    itp.setLoopAcceleration(false);
+    itp.setJitEnabled(false);
+    itp.setVmEnabled(false);
+    size_t next = 0;
+    itp.setInputProvider([&]() -> std::string {
+        if (next >= inputs.size()) throw std::runtime_error("OUT OF INPUT");
+        return std::to_string(inputs[next++]);
+    });
+
+    RunRecord record;
+    itp.setOutputConsumer([&](std::string_view s) { record.output += s; });
+    try {
+        if (run) run(itp);
+        else itp.run(p);
+    } catch (const std::exception &e) {
+        record.error = e.what();
+    }
+    record.variables = itp.getState().getVariables();
+    record.tree = itp.toSyntaxTree(p);
+    record.stats = *itp.getState().getRuntimeStats();
+    return record;
+}
+
+// Output, error, variables and counters must match the tree-walking interpreter
+void checkRunMatches(const std::string &name, const Program &p, const EngineRun &run,
+                     const std::vector<int> &inputs = {}) {
+    RunRecord reference = recordRun(p, inputs);
+    RunRecord tested = recordRun(p, inputs, run);
+    bool same = reference.output == tested.output && reference.error == tested.error
+                && reference.variables == tested.variables && reference.tree == tested.tree;
+    if (!same) cout << "[FAIL] " << name << ": '" << reference.error << "' vs '" << tested.error << "'" << endl;
+    assert(same);
+}
+
+void checkVmMatches(const std::string &name, const std::vector<std::string> &lines,
+                    const std::vector<int> &inputs = {}) {
+    Program p;
+    loadLoopProgram(p, lines);
+    checkRunMatches(name, p, [&](Interpreter &itp) {
+        itp.setVmEnabled(true);
+        itp.run(p);
+    }, inputs);
+}
+
+void testVmThreeAddressCode() {
+    Program p;
+    loadLoopProgram(p, {
+        "10 LET A = 1", "20 LET B = 2", "30 LET C = 3", "40 LET D = 4",
+        "50 LET X = (A + B) * (C - D)",
+        "60 END"
+    });
+    RegisterVM vm(p);
+    std::string listing = vm.disassemble();
+
+    // Every variable is known to be defined: no checks, no moves, and the
+    // top operator writes X directly
+    assert(listing.find("ADD t0, A, B") != std::string::npos);
+    assert(listing.find("SUB t1, C, D") != std::string::npos);
+    assert(listing.find("MUL X, t0, t1") != std::string::npos);
+    assert(listing.find("CHKDEF") == std::string::npos);
+    assert(listing.find("MOVE X") == std::string::npos);
+
+    EvalState state;
+    vm.run(state, p);
+    assert(state.getValue("X") == -3);
+    cout << "[PASS] testVmThreeAddressCode" << endl;
+}
+
+void testVmMatchesInterpreter() {
+    checkVmMatches("arithmetic", {
+        "10 LET S = 0",
+        "20 LET I = 0 - 50",
+        "30 LET S = S + I * I - S / 7 + I MOD 7 + (0 - I) MOD 3",
+        "40 LET I = I + 1",
+        "50 IF I < 2000 THEN 30",
+        "60 PRINT S",
+        "70 END"
+    });
+    checkVmMatches("input", {
+        "10 INPUT N",
+        "20 LET I = 0",
+        "30 LET I = I + 1",
+        "40 PRINT I * N",
+        "50 IF I < N THEN 30",
+        "60 IF I = N THEN 60",
+        "70 GOTO 90",
+        "80 REM skipped",
+        "90 END"
+    }, {7});
+    checkVmMatches("overflow", {
+        "10 LET X = 2147483647",
+        "20 LET X = X + 1",
+        "30 PRINT X * 3",
+        "40 PRINT X - 1",
+        "50 PRINT X / (0 - 1)",
+        "60 PRINT X MOD (0 - 1)",
+        "70 END"
+    });
+    cout << "[PASS] testVmMatchesInterpreter" << endl;
+}
+
+void testVmErrors() {
+    checkVmMatches("undefined", {
+        "10 LET I = 0",
+        "20 LET I = I + 1",
+        "30 IF I < 5 THEN 20",
+        "40 PRINT I + Y",
+        "50 END"
+    });
+    checkVmMatches("divide", {
+        "10 LET I = 3",
+        "20 LET Q = 100 / I",
+        "30 LET I = I - 1",
+        "40 IF I > 0 - 1 THEN 20",
+        "50 END"
+    });
+    checkVmMatches("unknown operator", {
+        "10 LET A = 2",
+        "20 LET B = A ^ 2",
+        "30 END"
+    });
+    checkVmMatches("missing line", {
+        "10 LET A = 1",
+        "20 GOTO 100"
+    });
+    checkVmMatches("fall off", {
+        "10 LET A = 1",
+        "20 PRINT A"
+    });
+    checkVmMatches("out of input", {
+        "10 INPUT A",
+        "20 PRINT A",
+        "30 GOTO 10"
+    }, {1, 2, 3});
+    cout << "[PASS] testVmErrors" << endl;
+}
+
+void testVmDispatchModes() {
+    Program p;
+    loadLoopProgram(p, {
+        "10 LET S = 0",
+        "20 LET I = 0",
+        "30 LET S = S + I * (I MOD 5)",
+        "40 LET I = I + 1",
+        "50 IF I < 1000 THEN 30",
+        "60 END"
+    });
+    RegisterVM vm(p);
+
+    vm.setDispatch(VmDispatch::Switch);
+    EvalState viaSwitch;
+    vm.run(viaSwitch, p);
+    uint64_t switchInstructions = vm.executedInstructions();
+
+    vm.setDispatch(VmDispatch::Threaded);
+    assert((vm.getDispatch() == VmDispatch::Threaded) == RegisterVM::threadedDispatchSupported());
+    EvalState viaThreaded;
+    vm.run(viaThreaded, p);
+
+    assert(viaSwitch.getVariables() == viaThreaded.getVariables());
+    assert(switchInstructions == vm.executedInstructions());
+    assert(switchInstructions > 1000);
+    cout << "[PASS] testVmDispatchModes" << endl;
+}
+
+void runVmTests() {
+    testVmThreeAddressCode();
+    testVmMatchesInterpreter();
+    testVmErrors();
+    testVmDispatchModes();
+    cout << "All VM tests passed!" << endl;
+}
@@ -0,0 +1,166 @@
+#include "interpreter.h"
+#include "programloader.h"
+#include "tracebuffer.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Records and decodes execution traces (see TraceBuffer)
+// Usage: qbasic-trace record <program.bas> -o <trace.bin> [-i <input.txt>]
+//                            [--buffer <megabytes>]
+//        qbasic-trace show <trace.bin> [--last <steps>] [--line <n>]
+//                          [--var <name>] [--writes]
+//   record    run the program (statement by statement) and save the steps
+//             kept in the ring buffer, also when the run fails
+//   -i        lines for INPUT (default: INPUT fails with END OF INPUT)
+//   --buffer  ring buffer size (default 64 MB; older steps are dropped)
+//   show      print "<step> <line>[ NAME=value ...]", oldest first
+//   --last    only the last <steps> steps of the run
+//   --line    only steps of this line
+//   --var     only steps that write this variable
+//   --writes  only steps that write a variable
+
+namespace {
+
+void usage() {
+    std::cerr << "usage: qbasic-trace record <program.bas> -o <trace.bin> [-i <input.txt>] [--buffer <MB>]\n"
+                 "       qbasic-trace show <trace.bin> [--last <steps>] [--line <n>] [--var <name>] [--writes]\n";
+}
+
+int record(int argc, char *argv[]) {
+    std::string programPath, tracePath, inputPath;
+    double megabytes = 64;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-o" && hasValue) tracePath = argv[++i];
+        else if (arg == "-i" && hasValue) inputPath = argv[++i];
+        else if (arg == "--buffer" && hasValue) megabytes = std::atof(argv[++i]);
+        else if (programPath.empty() && !arg.empty() && arg[0] != '-') programPath = arg;
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (programPath.empty() || tracePath.empty() || megabytes <= 0) {
+        usage();
+        return 2;
+    }
+
+    Program program;
+    std::ifstream input;
+    try {
+        std::vector<std::string> errors = loadProgramFile(programPath, program);
+        if (!errors.empty()) {
+            for (const auto &e : errors) std::cerr << programPath << ": " << e << "\n";
+            return 1;
+        }
+        if (!inputPath.empty()) {
+            input.open(inputPath);
+            if (!input) throw std::runtime_error("cannot open " + inputPath);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "qbasic-trace: " << e.what() << "\n";
+        return 1;
+    }
+
+    TraceBuffer trace((size_t)(megabytes * (1 << 20)));
+    Interpreter interpreter;
+    interpreter.setTrace(&trace);
+    interpreter.setInputProvider([&input]() -> std::string {
+        std::string line;
+        if (!input.is_open() || !std::getline(input, line)) throw std::runtime_error("END OF INPUT");
+        return line;
+    });
+
+    int status = 0;
+    try {
+        interpreter.run(program);
+    } catch (const std::exception &e) {
+        std::cerr << "Runtime Error: " << e.what() << "\n";
+        status = 1;
+    }
+
+    std::ofstream out(tracePath, std::ios::binary);
+    trace.save(out);
+    if (!out) {
+        std::cerr << "qbasic-trace: cannot write " << tracePath << "\n";
+        return 1;
+    }
+    std::cerr << trace.steps() << " steps, " << (trace.steps() - trace.oldestStep()) << " kept\n";
+    return status;
+}
+
+int show(int argc, char *argv[]) {
+    std::string tracePath, variable;
+    long long last = -1;
+    int line = -1;
+    bool writesOnly = false;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--last" && hasValue) last = std::atoll(argv[++i]);
+        else if (arg == "--line" && hasValue) line = std::atoi(argv[++i]);
+        else if (arg == "--var" && hasValue) variable = argv[++i];
+        else if (arg == "--writes") writesOnly = true;
+        else if (tracePath.empty() && !arg.empty() && arg[0] != '-') tracePath = arg;
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (tracePath.empty()) {
+        usage();
+        return 2;
+    }
+
+    std::ifstream file(tracePath, std::ios::binary);
+    if (!file) {
+        std::cerr << "qbasic-trace: cannot open " << tracePath << "\n";
+        return 1;
+    }
+    try {
+        TraceReader reader(file);
+        const std::vector<std::string> &names = reader.variableNames();
+
+        // Variable filter by id; a name the trace never wrote matches nothing
+        long long wanted = variable.empty() ? -1 : -2;
+        for (size_t id = 0; id < names.size(); ++id) {
+            if (names[id] == variable) wanted = (long long)id;
+        }
+
+        uint64_t from = 0;
+        if (last >= 0) from = reader.steps() > (uint64_t)last ? reader.steps() - (uint64_t)last : 0;
+        if (from < reader.oldestStep()) from = reader.oldestStep();
+
+        std::string text;
+        reader.forEach([&](const TraceStep &step) {
+            if (line != -1 && step.line != line) return;
+            if (writesOnly && step.writes.empty()) return;
+            if (wanted != -1) {
+                bool writes = false;
+                for (const auto &w : step.writes) writes = writes || (long long)w.first == wanted;
+                if (!writes) return;
+            }
+            text = std::to_string(step.index) + " " + std::to_string(step.line);
+            for (const auto &w : step.writes) text += " " + names[w.first] + "=" + std::to_string(w.second);
+            std::cout << text << "\n";
+        }, from);
+    } catch (const std::exception &e) {
+        std::cerr << "qbasic-trace: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string command = argc > 1 ? argv[1] : "";
+    if (command == "record") return record(argc, argv);
+    if (command == "show") return show(argc, argv);
+    usage();
+    return 2;
+}
@@ -1,9 +1,13 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include <QDebug>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include <QInputDialog>
+#include <QTextCursor>
+#include <chrono>
+#include <future>
 
 // load file
 #include <QMessageBox>
@@ -15,9 +19,6 @@
 // quit
 #include <QApplication>
 
-// update display
-#include <QTimer>
-
 //load
 #include <QTextStream>
 
@@ -30,17 +31,21 @@ MainWindow::MainWindow(QWidget *parent)
     //coutRedirect = new QTextBrowserStream(ui->textBrowser);
     //coutRedirect ->install();
     resetAll();
-    ui->CodeDisplay->setText("");
+    ui->CodeDisplay->setModel(&codeModel);
+    ui->treeDisplay->setModel(&treeModel);
+    liveTimer.setInterval(16);     // about the display rate
+    connect(&liveTimer, &QTimer::timeout, this, &MainWindow::pollLive);
     ui->textBrowser->setText(
         "welcome to Qbasic.\n"
         "Key in 'help' to see more help"
         );
-
-    ui->treeDisplay->setText("");
 }
 
 MainWindow::~MainWindow()
 {
+    // a running program stops at its next publication point or INPUT
+    liveState.requestStop();
+    if (runner.joinable()) runner.join();
     delete ui;
     //coutRedirect->uninstall();
     //delete coutRedirect;
@@ -64,6 +69,16 @@ void MainWindow::on_cmdLineEdit_editingFinished()
         return;
     }
 
+    if(cmd.toUpper()==QString("STOP")) {
+        liveState.requestStop();
+        return;
+    }
+
+    if(cmd.toUpper()==QString("HEAT")) {
+        codeModel.setHeatVisible(!codeModel.heatVisible());
+        return;
+    }
+
     if(cmd.toUpper()==QString("CLEAR")) {
         on_btnClearCode_clicked();
         return;
@@ -74,11 +89,37 @@ void MainWindow::on_cmdLineEdit_editingFinished()
         return;
     }
 
+    if(cmd.toUpper()==QString("SAVE")) {
+        saveRecording();
+        return;
+    }
+
+    if(cmd.toUpper()==QString("CONT")) {
+        on_btnContinue_clicked();
+        return;
+    }
+
+    if(cmd.toUpper()==QString("STEP")) {
+        on_btnStep_clicked();
+        return;
+    }
+
+    if(cmd.toUpper()==QString("NEXT")) {
+        on_btnStepOver_clicked();
+        return;
+    }
+
+    if(runDebugCommand(cmd)) {
+        ui->cmdLineEdit->setText("");
+        return;
+    }
+
+    // the running program reads the Program
+    if (refuseWhileRunning()) return;
+
     //qDebug()<<cmd;
     ui->cmdLineEdit->setText("");
 
-    ui->CodeDisplay->append(cmd);
-
     try{
         runParser(cmd);
     }
@@ -86,19 +127,13 @@ void MainWindow::on_cmdLineEdit_editingFinished()
         QMessageBox::critical(this, "Syntax Error", QString::fromStdString(e.what()));
         return;
     } // 停止运行，用户修正代码
-
-
-    // deliver "this" for lambda to recognize functiosn
-    QTimer::singleShot(1000, this, [this](){
-        updateCodeDisplay();
-    });
-
-
 }
 
 
 void MainWindow::on_btnLoadCode_clicked()
 {
+    if (refuseWhileRunning()) return;
+
     QString fileName = QFileDialog::getOpenFileName(
         this,
         "选择 BASIC 程序文件",
@@ -122,8 +157,6 @@ void MainWindow::on_btnLoadCode_clicked()
     file.close();
 
     parseTextIntoProgram(text);
-
-    updateCodeDisplay();   // update to ui
 }
 
 
@@ -133,74 +166,151 @@ void MainWindow::on_btnClearCode_clicked()
 {
     qDebug()<<"CLEAR";
 
+    if (refuseWhileRunning()) return;
+
     // reset data structure
     resetAll();
 
-    //reset ui
-    ui->CodeDisplay->setText("");
+    //reset ui (CodeDisplay empties itself with the program)
     ui->textBrowser->setText("");
-    ui->treeDisplay->setText(""); // TODO: should clear the datastructure and update automatically
+    treeModel.clearTree();
+    codeModel.clearHeat();
 
-    //TODO:clear the program structure / sytax tree
+    // breakpoints belonged to the old program
+    debugRun.reset();
+    debugger.clearAll();
 
 }
 
 void MainWindow::on_btnRunCode_clicked(){
+    if (refuseWhileRunning()) return;
     ui->textBrowser->clear();
-    program.resetStateCount();
     run();
 }
 
 
+std::string MainWindow::askInput()
+{
+    bool ok;
+    QString s = QInputDialog::getText(
+        this,
+        "INPUT",
+        "请输入一个整数：",
+        QLineEdit::Normal,
+        "",
+        &ok
+        );
+    return ok ? s.toStdString() : std::string();
+}
+
+
 /*
  * run the code
+ *
+ * The program runs on a worker thread so the window stays live: PRINT is
+ * queued to the text browser, INPUT asks through the UI thread, and the
+ * variables panel polls liveState. The worker never waits for the UI except
+ * for an INPUT answer. The program must not change while it runs
  */
 
 void MainWindow::run(){
 
+    if (refuseWhileRunning()) return;
+
+    runItp.reset(new Interpreter());
+    runItp->setVmEnabled(true);
+    liveState.reset();
+    runItp->setLiveState(&liveState);
+    ui->varDisplay->clear();
+    codeModel.clearHeat();
+
+    // every INPUT line and the printed output are recorded for SAVE
+    lastRun.begin(program);
+    runItp->setOutputConsumer(lastRun.recordOutput([this](std::string_view text) {
+        QString s = QString::fromUtf8(text.data(), (qsizetype)text.size());
+        QMetaObject::invokeMethod(this, [this, s]() {
+            ui->textBrowser->moveCursor(QTextCursor::End);
+            ui->textBrowser->insertPlainText(s);
+        }, Qt::QueuedConnection);
+    }));
+
+    // use lambda; the engine takes plain strings, convert from Qt here
+    runItp->setInputProvider(lastRun.recordInput([this]() { return inputFromWorker(); }));
+
+    liveTimer.start();
+    runner = std::thread([this]() {
+        QString error;
+        bool known = true;
+        try {
+            runItp->run(program);
+        }
+        catch (const std::runtime_error &e) {
+            error = QString::fromStdString(e.what());
+        } catch (...) {
+            known = false;
+        }
+        QMetaObject::invokeMethod(this, [this, error, known]() { runFinished(error, known); },
+                                  Qt::QueuedConnection);
+    });
+}
 
-    Interpreter itp;
-    //interpreter.reset();
-
-    QTextBrowserStream qout(ui->textBrowser);
-    std::streambuf *oldBuf = std::cout.rdbuf(&qout);
 
-    //qDebug()<<"before setting provider";
+// Worker side of INPUT: the dialog runs on the UI thread, the worker waits
+// for the answer unless the run is asked to stop meanwhile
+std::string MainWindow::inputFromWorker()
+{
+    auto answer = std::make_shared<std::promise<std::string>>();
+    std::future<std::string> reply = answer->get_future();
+    QMetaObject::invokeMethod(this, [this, answer]() { answer->set_value(askInput()); },
+                              Qt::QueuedConnection);
+    while (reply.wait_for(std::chrono::milliseconds(50)) != std::future_status::ready)
+        liveState.checkStop();
+    return reply.get();
+}
 
-    // use lambda
-    itp.setInputProvider([this]() -> QString {
-        bool ok;
-        QString s = QInputDialog::getText(
-            this,
-            "INPUT",
-            "请输入一个整数：",
-            QLineEdit::Normal,
-            "",
-            &ok
-            );
-        return ok ? s : "";
-    });
 
+void MainWindow::runFinished(const QString &error, bool known)
+{
+    runner.join();
+    liveTimer.stop();
+    pollLive();
 
     //robust
-    try{
-        itp.run(program);
-    }
-    catch (const std::runtime_error &e) {
-        QMessageBox::critical(this, "Runtime Error", QString::fromStdString(e.what()));
-    } catch (...) {
+    if (!known) {
         QMessageBox::critical(this, "Unknown Error", "An unknown error occurred during execution.");
+    } else if (!error.isEmpty()) {
+        lastRun.error = error.toStdString();
+        QMessageBox::critical(this, "Runtime Error", error);
     }
 
+    // rows of the tree are rendered when the view shows them; the final
+    // stats also cover lines past LiveState::MAX_LINES
+    treeModel.setRuntimeStats(*runItp->getState().getRuntimeStats());
+    codeModel.setHeat(*runItp->getState().getRuntimeStats());
+}
 
-    // 4. restore cout
-    std::cout.rdbuf(oldBuf);
-
-    std::string tree = itp.toSyntaxTree(program);
 
-    ui->treeDisplay->setPlainText(QString::fromStdString(tree));
+// Show the latest publication of the running program
+void MainWindow::pollLive()
+{
+    if (!liveState.read(liveView)) return;     // being written: next tick
+
+    ui->label_5->setText(QString("变量（运行中实时更新） 行 %1").arg(liveView.line));
+    while (ui->varDisplay->count() < (int)liveView.variables.size()) ui->varDisplay->addItem(QString());
+    for (int i = 0; i < (int)liveView.variables.size(); ++i) {
+        const auto &entry = liveView.variables[i];
+        ui->varDisplay->item(i)->setText(QString::fromStdString(entry.first) + " = "
+                                         + QString::number(entry.second));
+    }
+    codeModel.setHeat(liveView.lines);
+}
 
 
+bool MainWindow::refuseWhileRunning()
+{
+    if (!runner.joinable()) return false;
+    ui->textBrowser->append("程序正在运行，可用 STOP 停止");
+    return true;
 }
 
 
@@ -253,6 +363,142 @@ void MainWindow::runParser(QString & qline)
 }
 
 
+void MainWindow::on_btnContinue_clicked(){
+    debug(&Debugger::continueRun);
+}
+
+void MainWindow::on_btnStep_clicked(){
+    debug(&Debugger::stepInto);
+}
+
+void MainWindow::on_btnStepOver_clicked(){
+    debug(&Debugger::stepOver);
+}
+
+
+void MainWindow::debug(DebugStop (Debugger::*action)(Interpreter &))
+{
+    if (refuseWhileRunning()) return;
+
+    // a new debug run: fresh variables, output appended to the text browser
+    if (!debugRun || !debugRun->isSuspended()) {
+        ui->textBrowser->clear();
+        debugRun.reset(new Interpreter());
+        debugRun->setInputProvider([this]() { return askInput(); });
+        debugRun->setOutputConsumer([this](std::string_view text) {
+            ui->textBrowser->moveCursor(QTextCursor::End);
+            ui->textBrowser->insertPlainText(QString::fromUtf8(text.data(), (qsizetype)text.size()));
+        });
+    }
+
+    try {
+        showStop((debugger.*action)(*debugRun));
+    }
+    catch (const std::runtime_error &e) {
+        QMessageBox::critical(this, "Runtime Error", QString::fromStdString(e.what()));
+    }
+
+    treeModel.setRuntimeStats(*debugRun->getState().getRuntimeStats());
+    codeModel.setHeat(*debugRun->getState().getRuntimeStats());
+}
+
+
+void MainWindow::showStop(const DebugStop &stop)
+{
+    QString text;
+    switch (stop.event) {
+    case DebugEvent::Finished:
+        ui->textBrowser->append("[程序结束]");
+        ui->CodeDisplay->clearSelection();
+        return;
+    case DebugEvent::Breakpoint:
+        text = "[断点] ";
+        break;
+    case DebugEvent::Watchpoint:
+        text = QString("[监视] %1: %2 -> %3 ")
+                   .arg(QString::fromStdString(stop.variable))
+                   .arg(stop.wasDefined ? QString::number(stop.oldValue) : QString("未定义"))
+                   .arg(stop.newValue);
+        break;
+    case DebugEvent::Step:
+        text = "[单步] ";
+        break;
+    }
+
+    // the line about to run, and the variables so far
+    text += "下一行 " + QString::number(stop.line) + " |";
+    for (const auto &entry : debugRun->getState().getVariables())
+        text += " " + QString::fromStdString(entry.first) + "=" + QString::number(entry.second);
+    ui->textBrowser->append(text);
+
+    int row = codeModel.rowOfLine(stop.line);
+    if (row >= 0) ui->CodeDisplay->setCurrentIndex(codeModel.index(row));
+}
+
+
+bool MainWindow::runDebugCommand(const QString &cmd)
+{
+    // BREAK 30 IF X > 5: the condition keeps its original spelling
+    static const QRegularExpression re(R"(^\s*(BREAK|UNBREAK|WATCH|UNWATCH)\s+(\S+)(?:\s+IF\s+(.+))?\s*$)",
+                                       QRegularExpression::CaseInsensitiveOption);
+    auto match = re.match(cmd);
+    if (!match.hasMatch()) return false;
+
+    QString keyword = match.captured(1).toUpper();
+    QString target = match.captured(2);
+    bool isLine = false;
+    int line = target.toInt(&isLine);
+
+    if (keyword == "WATCH" || keyword == "UNWATCH") {
+        std::string name = target.toStdString();
+        if (keyword == "WATCH") debugger.watch(name);
+        else debugger.unwatch(name);
+        ui->textBrowser->append(keyword + " " + target);
+        return true;
+    }
+
+    if (!isLine) {
+        ui->textBrowser->append("行号解析失败");
+        return true;
+    }
+
+    try {
+        if (keyword == "BREAK") debugger.setBreakpoint(line, match.captured(3).toStdString());
+        else debugger.clearBreakpoint(line);
+        ui->textBrowser->append(cmd.trimmed());
+    }
+    catch (const std::runtime_error &e) {
+        QMessageBox::critical(this, "Syntax Error", QString::fromStdString(e.what()));
+    }
+    return true;
+}
+
+
+void MainWindow::saveRecording()
+{
+    // the running program is still appending to lastRun
+    if (refuseWhileRunning()) return;
+
+    if (lastRun.source.empty()) {
+        ui->textBrowser->append("还没有运行过程序");
+        return;
+    }
+
+    QString fileName = QFileDialog::getSaveFileName(
+        this,
+        "保存运行记录",
+        "",
+        "Replay Files (*.qbr);;All Files (*)"
+        );
+
+    if (fileName.isEmpty()) return;
+
+    std::ofstream file(fileName.toStdString(), std::ios::binary);
+    lastRun.save(file);
+    if (!file) QMessageBox::warning(this, "错误", "无法写入文件");
+}
+
+
 void MainWindow::showHelp()
 {
     QMessageBox::information(
@@ -267,34 +513,19 @@ void MainWindow::showHelp()
         "  GOTO 行号\n"
         "  END\n\n"
         "你也可以使用 LOAD 从文件加载程序。\n"
+        "调试：BREAK 行号 [IF 条件]、UNBREAK 行号、\n"
+        "WATCH 变量、UNWATCH 变量，\n"
+        "CONT 继续、STEP 单步、NEXT 步过循环。\n"
+        "运行中变量面板实时更新，STOP 停止运行。\n"
+        "代码区按执行次数着色（热点图），HEAT 显示/隐藏。\n"
+        "SAVE 保存上一次运行（程序和全部输入），\n"
+        "可用 qbasic-batch --replay 无界面重放。\n"
         "当你准备好之后，使用 RUN 来运行程序，\n"
         "你也可以使用 CLEAR 来清空当前的程序"
         );
 }
 
 
-void MainWindow::updateCodeDisplay(){
-    int firstline = program.getFirstLineNumber();
-    if (firstline < 0 ) return;
-
-    std::string sortedSourceCode;
-
-    program.setNextLine(firstline);
-
-    int currentline = program.getNextLine();
-
-    while(currentline!= -1 && ! program.isEnded()){
-        sortedSourceCode += std::to_string(currentline)+" "
-                            + program.getSourceLine(currentline)
-                            + "\n";
-
-        currentline = program.getNextLineNumber(currentline);
-    }
-
-    ui->CodeDisplay->setText(QString::fromStdString(sortedSourceCode));
-}
-
-
 void MainWindow::parseTextIntoProgram(const QString &text)
 {
     QStringList lines = text.split('\n');
@@ -2,11 +2,20 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include <QTimer>
+
+#include <memory>
+#include <thread>
 
 #include "qtextbrowserstream.h"
+#include "programlistmodel.h"
+#include "syntaxtreemodel.h"
 
 #include "../core/program.h"
+#include "../interpreter/debugger.h"
 #include "../interpreter/interpreter.h"
+#include "../interpreter/livestate.h"
+#include "../interpreter/sessionrecording.h"
 #include "../runtime/parser.h"
 
 QT_BEGIN_NAMESPACE
@@ -24,7 +33,7 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
-    // Execute loaded program
+    // Execute loaded program (on a worker thread, see mainwindow.cpp)
     void run();
     
     // Parse single line of code
@@ -33,12 +42,21 @@ public:
     // Display help information
     void showHelp();
 
-    // Update code display in UI
-    void updateCodeDisplay();
-
     // Convert user input text into Program object
     void parseTextIntoProgram(const QString &text);
     
+    // Debugger commands: continue, step or step over the paused debug run
+    // (starting one if none is paused) and show where it stopped
+    void debug(DebugStop (Debugger::*action)(Interpreter &));
+
+    // BREAK <line> [IF <condition>], UNBREAK <line>, WATCH <var>, UNWATCH <var>
+    // Returns: false if cmd is not a debugger command
+    bool runDebugCommand(const QString &cmd);
+
+    // Save the last run (program, INPUT lines, outcome) for headless
+    // replay with qbasic-batch --replay
+    void saveRecording();
+
     // Decode text file content
     QString decodeTextFile(const QByteArray &raw);
 
@@ -50,6 +68,9 @@ private slots:
     void on_btnLoadCode_clicked();    // Load code file
     void on_btnRunCode_clicked();      // Run program
     void on_btnClearCode_clicked();    // Clear program
+    void on_btnContinue_clicked();     // Debugger: run to the next stop
+    void on_btnStep_clicked();         // Debugger: one statement
+    void on_btnStepOver_clicked();     // Debugger: one line, loops run through
 
 private:
     Ui::MainWindow *ui;
@@ -60,6 +81,37 @@ private:
     // Core interpreter components
     Program program{};                 // Parsed program structure
     Parser parser{};                   // Parser for converting code to AST
+    ProgramListModel codeModel{program};   // Rows of CodeDisplay, follows program edits
+    SyntaxTreeModel treeModel{program};    // treeDisplay, rendered when rows are shown
+    SessionRecording lastRun;              // Recorded by every run(), written by SAVE
+    Debugger debugger{program};            // Breakpoints and watchpoints
+    std::unique_ptr<Interpreter> debugRun; // Run driven by the debugger buttons
+
+    // Background run: the interpreter, its thread and the live variables
+    std::unique_ptr<Interpreter> runItp;
+    std::thread runner;                    // joinable while a run is in progress
+    LiveState liveState;                   // Published by the running program
+    LiveSnapshot liveView;                 // Last publication shown
+    QTimer liveTimer;                      // Polls liveState during a run
+
+    // Ask for one INPUT line (empty if the dialog is cancelled)
+    std::string askInput();
+
+    // INPUT of the background run: asks on the UI thread and waits
+    std::string inputFromWorker();
+
+    // The background run ended (error empty on success, known false for a
+    // non-standard exception)
+    void runFinished(const QString &error, bool known);
+
+    // Refresh the variables panel from liveState
+    void pollLive();
+
+    // A background run is in progress: say so and return true
+    bool refuseWhileRunning();
+
+    // Report a debugger stop and select the line in CodeDisplay
+    void showStop(const DebugStop &stop);
 
     // Reset all interpreter state before running
     // Call this before each run to clear variables and execution state
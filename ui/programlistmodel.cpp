@@ -0,0 +1,113 @@
+#include "programlistmodel.h"
+
+#include <QColor>
+#include <cmath>
+
+ProgramListModel::ProgramListModel(const Program &program, QObject *parent)
+    : QAbstractListModel(parent), program(program)
+{
+    for (int line = program.getFirstLineNumber(); line != -1; line = program.getNextLineNumber(line))
+        lines.insert(line);
+    program.addObserver(this);
+}
+
+ProgramListModel::~ProgramListModel()
+{
+    program.removeObserver(this);
+}
+
+int ProgramListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : lines.size();
+}
+
+QVariant ProgramListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= lines.size()) return QVariant();
+
+    int lineNumber = lines.at(index.row());
+    if (role == Qt::DisplayRole)
+        return QString::number(lineNumber) + " " + QString::fromStdString(program.getSourceLine(lineNumber));
+    if (role == Qt::UserRole)
+        return lineNumber;
+    if ((role == Qt::BackgroundRole || role == Qt::ToolTipRole) && showHeat && hottest > 0) {
+        auto it = heat.find(lineNumber);
+        uint64_t count = it == heat.end() ? 0 : it->second;
+        if (role == Qt::ToolTipRole)
+            return QString("执行 %1 次").arg((qulonglong)count);
+        if (count == 0) return QVariant();
+        // log scale: a line run 1000 times next to one run 10^6 times still shows
+        double level = std::log1p((double)count) / std::log1p((double)hottest);
+        return QColor(255, 96, 0, 24 + (int)(level * 136));
+    }
+    return QVariant();
+}
+
+void ProgramListModel::setHeat(const std::vector<std::pair<int, uint64_t>> &counts)
+{
+    heat.clear();
+    hottest = 0;
+    for (const auto &entry : counts) {
+        heat[entry.first] = entry.second;
+        if (entry.second > hottest) hottest = entry.second;
+    }
+    heatChanged();
+}
+
+void ProgramListModel::setHeat(const RuntimeStats &stats)
+{
+    std::vector<std::pair<int, uint64_t>> counts;
+    counts.reserve(stats.lineCounters.size());
+    for (const auto &entry : stats.lineCounters) counts.push_back({entry.first, (uint64_t)entry.second.execCount});
+    setHeat(counts);
+}
+
+void ProgramListModel::clearHeat()
+{
+    heat.clear();
+    hottest = 0;
+    heatChanged();
+}
+
+void ProgramListModel::setHeatVisible(bool visible)
+{
+    if (visible == showHeat) return;
+    showHeat = visible;
+    heatChanged();
+}
+
+// Every row may change colour; the view only repaints the rows on screen
+void ProgramListModel::heatChanged()
+{
+    if (lines.size() == 0) return;
+    emit dataChanged(index(0), index(lines.size() - 1), {Qt::BackgroundRole, Qt::ToolTipRole});
+}
+
+void ProgramListModel::lineChanged(int lineNumber)
+{
+    int row = lines.rank(lineNumber);
+    bool present = program.hasLine(lineNumber);
+
+    if (row != -1 && present) {
+        // new source text or statement: repaint the one row
+        QModelIndex changed = index(row);
+        emit dataChanged(changed, changed, {Qt::DisplayRole});
+    } else if (row != -1) {
+        beginRemoveRows(QModelIndex(), row, row);
+        lines.erase(lineNumber);
+        endRemoveRows();
+    } else if (present) {
+        // the row a new line will get is the number of lines before it
+        int position = lines.countBelow(lineNumber);
+        beginInsertRows(QModelIndex(), position, position);
+        lines.insert(lineNumber);
+        endInsertRows();
+    }
+}
+
+void ProgramListModel::programCleared()
+{
+    beginResetModel();
+    lines.clear();
+    endResetModel();
+}
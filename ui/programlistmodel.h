@@ -0,0 +1,75 @@
+/**
+ * @file    programlistmodel.h
+ * @brief   List model showing the source lines of a Program, one row each
+ *
+ *          The model follows the program's edits (ProgramObserver) and
+ *          reports each one as a single row insert, change or removal, so
+ *          a view only lays out and paints the rows on screen. Rows are
+ *          found through a LineIndex, which keeps the cost of an edit
+ *          logarithmic in the number of lines; the text of a row is read
+ *          from the Program when the view asks for it.
+ *
+ *          Execution counts can be laid over the rows as a heat map: the
+ *          background of a line deepens with the log of its count relative
+ *          to the hottest line, so loops stand out in long programs. Counts
+ *          are replaced as a whole (from a live publication or the stats of
+ *          a finished run) and kept by line number, so they survive edits
+ *          until the next run.
+ *
+ * @author  simple_wind
+ * @version 1.0
+ * @date    2025-12-16
+ * */
+
+#pragma once
+
+#include <QAbstractListModel>
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../core/lineindex.h"
+#include "../core/program.h"
+#include "../runtime/evalstate.h"
+
+class ProgramListModel : public QAbstractListModel, public ProgramObserver {
+    Q_OBJECT
+
+public:
+    // Show every line of the program and follow its edits from now on
+    // The program must outlive the model
+    explicit ProgramListModel(const Program &program, QObject *parent = nullptr);
+    ~ProgramListModel() override;
+
+    // DisplayRole: "10 LET X = 1", Qt::UserRole: the line number,
+    // BackgroundRole and ToolTipRole: the heat map (nothing if off)
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    // Row of a line number, -1 if the program has no such line
+    int rowOfLine(int lineNumber) const { return lines.rank(lineNumber); }
+
+    // Replace the execution counts shown (line number -> times executed)
+    void setHeat(const std::vector<std::pair<int, uint64_t>> &counts);
+    void setHeat(const RuntimeStats &stats);
+    void clearHeat();
+
+    // Show or hide the heat map without dropping the counts
+    void setHeatVisible(bool visible);
+    bool heatVisible() const { return showHeat; }
+
+    // ProgramObserver
+    void lineChanged(int lineNumber) override;
+    void programCleared() override;
+
+private:
+    const Program &program;
+    LineIndex lines;
+    std::unordered_map<int, uint64_t> heat;     // line number -> times executed
+    uint64_t hottest = 0;
+    bool showHeat = true;
+
+    void heatChanged();
+};
@@ -0,0 +1,178 @@
+#include "syntaxtreemodel.h"
+#include "../core/statement.h"
+
+#include <algorithm>
+#include <sstream>
+
+SyntaxTreeModel::SyntaxTreeModel(const Program &program, QObject *parent)
+    : QAbstractItemModel(parent), program(program)
+{
+    for (int line = program.getFirstLineNumber(); line != -1; line = program.getNextLineNumber(line)) {
+        if (program.getParsedStatement(line)) lines.insert(line);
+    }
+    program.addObserver(this);
+}
+
+SyntaxTreeModel::~SyntaxTreeModel()
+{
+    program.removeObserver(this);
+}
+
+void SyntaxTreeModel::setRuntimeStats(const RuntimeStats &runStats)
+{
+    beginResetModel();
+    stats = runStats;
+    rendered.clear();
+    shown = true;
+    endResetModel();
+}
+
+void SyntaxTreeModel::clearTree()
+{
+    beginResetModel();
+    stats = RuntimeStats();
+    rendered.clear();
+    shown = false;
+    endResetModel();
+}
+
+// Render one statement and split its text into nodes by indentation
+// (two spaces per level; lines the statement writes without indentation,
+// such as the text of a REM, belong to the statement)
+SyntaxTreeModel::Node *SyntaxTreeModel::statementNode(int lineNumber) const
+{
+    auto found = rendered.find(lineNumber);
+    if (found != rendered.end()) return &found->second->nodes.front();
+
+    std::ostringstream out;
+    Statement *stmt = program.getParsedStatement(lineNumber);
+    if (stmt) stmt->writeSyntaxTree(out, &stats, lineNumber, 0);
+
+    auto rendering = std::make_unique<Rendering>();
+    std::deque<Node> &nodes = rendering->nodes;
+    std::vector<Node*> path;            // path[d]: last node at depth d
+    std::istringstream in(out.str());
+    std::string text;
+    while (std::getline(in, text)) {
+        size_t spaces = text.find_first_not_of(' ');
+        if (spaces == std::string::npos) continue;
+
+        nodes.emplace_back();
+        Node &node = nodes.back();
+        node.line = lineNumber;
+        node.text = QString::fromStdString(text.substr(spaces));
+        if (path.empty()) {
+            node.text = QString::number(lineNumber) + " " + node.text;
+            path.push_back(&node);
+            continue;
+        }
+
+        size_t depth = std::max<size_t>(1, spaces / 2);
+        depth = std::min(depth, path.size());
+        path.resize(depth);
+        node.parent = path.back();
+        node.row = (int)node.parent->children.size();
+        node.parent->children.push_back(&node);
+        path.push_back(&node);
+    }
+    if (nodes.empty()) {
+        nodes.emplace_back();
+        nodes.back().line = lineNumber;
+        nodes.back().text = QString::number(lineNumber);
+    }
+
+    Node *root = &nodes.front();
+    rendered.emplace(lineNumber, std::move(rendering));
+    return root;
+}
+
+// Top-level indexes carry no pointer; deeper ones point to their node
+SyntaxTreeModel::Node *SyntaxTreeModel::nodeOf(const QModelIndex &index) const
+{
+    if (!index.isValid()) return nullptr;
+    if (index.internalPointer()) return static_cast<Node*>(index.internalPointer());
+    return statementNode(lines.at(index.row()));
+}
+
+QModelIndex SyntaxTreeModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (row < 0 || column != 0) return QModelIndex();
+    if (!parent.isValid()) {
+        return row < rowCount() ? createIndex(row, 0, nullptr) : QModelIndex();
+    }
+    Node *node = nodeOf(parent);
+    if (row >= (int)node->children.size()) return QModelIndex();
+    return createIndex(row, 0, node->children[row]);
+}
+
+QModelIndex SyntaxTreeModel::parent(const QModelIndex &child) const
+{
+    Node *node = static_cast<Node*>(child.internalPointer());
+    if (!child.isValid() || !node) return QModelIndex();
+
+    Node *parent = node->parent;
+    if (!parent->parent) return createIndex(lines.rank(parent->line), 0, nullptr);
+    return createIndex(parent->row, 0, parent);
+}
+
+int SyntaxTreeModel::rowCount(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) return shown ? lines.size() : 0;
+    return (int)nodeOf(parent)->children.size();
+}
+
+int SyntaxTreeModel::columnCount(const QModelIndex &) const
+{
+    return 1;
+}
+
+// Every statement has operands or a target except END and a REM without
+// text, so other top-level rows can say so without being rendered; the
+// view renders them on expansion
+bool SyntaxTreeModel::hasChildren(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) return rowCount() > 0;
+    if (!parent.internalPointer()) {
+        Statement *stmt = program.getParsedStatement(lines.at(parent.row()));
+        if (!stmt || stmt->type() == StatementType::END) return false;
+        if (stmt->type() != StatementType::REM) return true;
+    }
+    return !nodeOf(parent)->children.empty();
+}
+
+QVariant SyntaxTreeModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) return QVariant();
+    if (role == Qt::DisplayRole) return nodeOf(index)->text;
+    if (role == Qt::UserRole) return nodeOf(index)->line;
+    return QVariant();
+}
+
+void SyntaxTreeModel::lineChanged(int lineNumber)
+{
+    int row = lines.rank(lineNumber);
+    bool present = program.getParsedStatement(lineNumber) != nullptr;
+
+    // Rows of an edited statement are removed with their nodes and added
+    // back unrendered; the view renders them again when it shows them
+    if (row != -1) {
+        if (shown) beginRemoveRows(QModelIndex(), row, row);
+        lines.erase(lineNumber);
+        rendered.erase(lineNumber);
+        if (shown) endRemoveRows();
+    }
+    if (present) {
+        int position = lines.countBelow(lineNumber);
+        if (shown) beginInsertRows(QModelIndex(), position, position);
+        lines.insert(lineNumber);
+        if (shown) endInsertRows();
+    }
+}
+
+void SyntaxTreeModel::programCleared()
+{
+    beginResetModel();
+    lines.clear();
+    rendered.clear();
+    endResetModel();
+}
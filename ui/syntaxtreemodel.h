@@ -0,0 +1,81 @@
+/**
+ * @file    syntaxtreemodel.h
+ * @brief   Tree model of the syntax tree of a Program, built on demand
+ *
+ *          Shows the same tree as Interpreter::toSyntaxTree, one top-level
+ *          row per statement. Nothing is rendered when a run ends: a row
+ *          writes its statement (Statement::writeSyntaxTree) only when the
+ *          view first asks for its text or children, so the cost follows
+ *          what is on screen and expanded, not the size of the program.
+ *
+ *          The model follows the program's edits like ProgramListModel; an
+ *          edited statement is rendered again the next time it is shown.
+ *          Counters come from the RuntimeStats given after a run.
+ *
+ * @author  simple_wind
+ * @version 1.0
+ * @date    2025-12-16
+ * */
+
+#pragma once
+
+#include <QAbstractItemModel>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "../core/lineindex.h"
+#include "../core/program.h"
+#include "../runtime/evalstate.h"
+
+class SyntaxTreeModel : public QAbstractItemModel, public ProgramObserver {
+    Q_OBJECT
+
+public:
+    // Follow the edits of the program from now on (it must outlive the model)
+    // The tree stays empty until setRuntimeStats is called
+    explicit SyntaxTreeModel(const Program &program, QObject *parent = nullptr);
+    ~SyntaxTreeModel() override;
+
+    // Show the tree with the counters of a run
+    void setRuntimeStats(const RuntimeStats &stats);
+
+    // Hide the tree again (until the next setRuntimeStats)
+    void clearTree();
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    // ProgramObserver
+    void lineChanged(int lineNumber) override;
+    void programCleared() override;
+
+private:
+    // One line of a rendered statement; the root is the statement itself
+    struct Node {
+        QString text;
+        int line = -1;
+        int row = 0;                    // row under the parent
+        Node *parent = nullptr;         // nullptr: the statement (top level)
+        std::vector<Node*> children;
+    };
+
+    // Rendered statement of one line
+    struct Rendering {
+        std::deque<Node> nodes;         // nodes[0] is the statement
+    };
+
+    const Program &program;
+    LineIndex lines;                    // lines with a statement, in row order
+    RuntimeStats stats;
+    bool shown = false;
+    mutable std::unordered_map<int, std::unique_ptr<Rendering>> rendered;
+
+    Node *statementNode(int lineNumber) const;
+    Node *nodeOf(const QModelIndex &index) const;
+};
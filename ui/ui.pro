@@ -13,9 +13,13 @@ LIBS += \
 
 
 SOURCES += main.cpp \
-           mainwindow.cpp
+           mainwindow.cpp \
+           programlistmodel.cpp \
+           syntaxtreemodel.cpp
 
 HEADERS += mainwindow.h \
+    programlistmodel.h \
+    syntaxtreemodel.h \
     qtextbrowserstream.h
 
 FORMS += mainwindow.ui